@@ -0,0 +1,77 @@
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/flash.h"
+#include "hardware/sync.h"
+#include "cal.h"
+
+// the last flash sector, clear of the program image
+#define CAL_FLASH_OFFSET (PICO_FLASH_SIZE_BYTES - FLASH_SECTOR_SIZE)
+
+/**
+ * Cal record type
+ * 
+ * The check word is the complement of the other two, so an erased
+ * sector (all ones) or a torn write reads as no calibration.
+ * 
+ * @var cal_record_t
+ */
+typedef struct {
+    u_int32_t magic;
+    int32_t ppb;
+    u_int32_t check;
+} cal_record_t;
+
+/**
+ * Cal get check word of a record
+ * 
+ * @param const cal_record_t *record
+ * @return u_int32_t
+ */
+static u_int32_t cal_get_check(const cal_record_t *record)
+{
+    return ~(record->magic ^ (u_int32_t) record->ppb);
+}
+
+/**
+ * Cal load the stored crystal offset
+ * 
+ * @param int32_t *ppb
+ * @return bool
+ */
+bool cal_load(int32_t *ppb)
+{
+    const cal_record_t *record = (const cal_record_t *) (XIP_BASE + CAL_FLASH_OFFSET);
+
+    if (record->magic != CAL_MAGIC || record->check != cal_get_check(record)) {
+        return false;
+    }
+
+    *ppb = record->ppb;
+
+    return true;
+}
+
+/**
+ * Cal store the crystal offset
+ * 
+ * Flash is not readable while it is erased or programmed, so
+ * interrupts are off for the whole write (tens of milliseconds). DMA
+ * engines keep running as they only read RAM.
+ * 
+ * @param int32_t ppb
+ * @return void
+ */
+void cal_save(int32_t ppb)
+{
+    static u_int8_t page[FLASH_PAGE_SIZE];
+    cal_record_t record = { CAL_MAGIC, ppb, 0 };
+    record.check = cal_get_check(&record);
+
+    memset(page, 0xff, sizeof(page));
+    memcpy(page, &record, sizeof(record));
+
+    u_int32_t status = save_and_disable_interrupts();
+    flash_range_erase(CAL_FLASH_OFFSET, FLASH_SECTOR_SIZE);
+    flash_range_program(CAL_FLASH_OFFSET, page, FLASH_PAGE_SIZE);
+    restore_interrupts(status);
+}
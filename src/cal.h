@@ -0,0 +1,25 @@
+#ifndef CAL_H
+#define CAL_H
+
+#include <stdbool.h>
+#include <sys/types.h>
+
+#define CAL_MAGIC 0x4c414331
+
+/**
+ * Cal load the stored crystal offset
+ * 
+ * @param int32_t *ppb
+ * @return bool
+ */
+bool cal_load(int32_t *ppb);
+
+/**
+ * Cal store the crystal offset
+ * 
+ * @param int32_t ppb
+ * @return void
+ */
+void cal_save(int32_t ppb);
+
+#endif
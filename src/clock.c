@@ -1,10 +1,25 @@
 #include <stdio.h>
-#include <math.h>
 #include "pico/stdlib.h"
 #include "pico/time.h"
 #include "hardware/clocks.h"
 #include "hardware/gpio.h"
 #include "hardware/pwm.h"
+#include "hardware/uart.h"
+#include "hardware/vreg.h"
+#include "pwm_model.h"
+#include "jitter.h"
+#include "prof.h"
+#include "plan.h"
+#include "plan_cache.h"
+#include "plan_const.h"
+#include "engine.h"
+#include "sweep.h"
+#include "pattern.h"
+#include "trigger.h"
+#include "spread.h"
+#include "ref.h"
+#include "cal.h"
+#include "vco.h"
 #include "clock.h"
 
 /**
@@ -22,66 +37,179 @@ const int PULSE_PIN = 16;
 const int CLOCK_PIN = 17;
 
 /**
- * Clock started
+ * GPOUT GPIO pin (clk_gpout0, the only GPOUT pin free on the Pico W)
  * 
- * @var bool
+ * @var int
+ */
+const int GPOUT_PIN = 21;
+
+/**
+ * Clock pins that cannot be given to a channel
+ * 
+ * UART0 stdio, the GPOUT pin and the pins wired to the CYW43 on the
+ * Pico W.
+ * 
+ * @var const u_int8_t[]
+ */
+static const u_int8_t clock_reserved_pins[] = { 0, 1, 21, 23, 24, 25, 29 };
+
+/**
+ * Clock sys clock profile type
+ * 
+ * @var clock_profile_t
  */
-bool clock_started = false;
+typedef struct {
+    const char *name;
+    u_int32_t sys_khz;
+    enum vreg_voltage vreg;
+} clock_profile_t;
 
 /**
- * Clock mode
+ * Clock sys clock profiles
+ * 
+ * 250MHz is an exact PLL setting (1500MHz VCO / 6 / 1) and needs a
+ * little more core voltage to be stable.
  * 
- * 0 = astable
- * 1 = monostable
+ * @var clock_profile_t[]
+ */
+const clock_profile_t clock_profiles[CLOCK_PROFILE_COUNT] = {
+    { "standard", 125000, VREG_VOLTAGE_1_10 },
+    { "performance", 250000, VREG_VOLTAGE_1_15 },
+};
+
+/**
+ * Clock sys clock profile
  * 
  * @var u_int8_t
  */
-u_int8_t clock_mode = 0;
+u_int8_t clock_profile = CLOCK_PROFILE_STANDARD;
 
 /**
- * Clock frequency
+ * Clock crystal offset in ppb (positive when the crystal runs fast)
  * 
- * @var u_int32_t
+ * @var int32_t
  */
-u_int32_t clock_freq_hz = CLOCK_DEF_FREQ_HZ;
+int32_t clock_cal_ppb = 0;
 
 /**
- * Clock PWM div
+ * Clock channel type
+ * 
+ * One independent output: its pins, requested frequency and duty,
+ * engine preference and the state of whichever engine is running it.
  * 
- * @var u_int16_t
+ * mode: 0 = astable, 1 = monostable
+ * duty_type: 0 = ratio (duty_ppm), 1 = high time, 2 = low time (duty_ns)
+ * timer_type: 0 = repeating timer, 1 = PWM, 2 = clk_gpout, 3 = DMA sweep,
+ * 4 = PIO pattern, 5 = PIO trigger
+ * pulse_mode: 0 = follow, 1 = inverted, 2 = own duty, 3 = blink, 4 = PHI1
+ * 
+ * @var clock_channel_t
  */
-u_int16_t clock_pwm_div = 0;
+typedef struct {
+    bool used;
+    bool started;
+    u_int8_t pin;
+    u_int8_t pulse_pin;
+    u_int8_t mode;
+    u_int64_t freq_mhz;
+    u_int16_t pwm_div;
+    u_int16_t pwm_wrap;
+    u_int16_t pwm_level;
+    bool pwm_ph_correct;
+    u_int32_t dead_ticks;
+    u_int16_t dead_steps;
+    u_int32_t duty_ppm;
+    u_int8_t duty_type;
+    u_int32_t duty_ns;
+    u_int8_t engine;
+    u_int8_t timer_type;
+    gpout_plan_t gpout_plan;
+    u_int32_t spread_depth_ppm;
+    u_int64_t spread_rate_mhz;
+    u_int8_t spread_profile;
+    u_int32_t track_mul;
+    u_int32_t track_div;
+    bool retune_pending;
+    u_int8_t phase_master;
+    bool phase_ticks;
+    u_int32_t phase_value;
+    u_int16_t vco_div;
+    u_int8_t pulse_mode;
+    u_int32_t pulse_duty_ppm;
+    u_int32_t pulse_prescale;
+    struct repeating_timer pulse_timer;
+    bool pulse_state;
+    struct repeating_timer timer;
+    bool rpt_state;
+} clock_channel_t;
 
 /**
- * Clock PWM wrap
+ * Clock channels
  * 
- * @var u_int16_t
+ * @var clock_channel_t[]
  */
-u_int16_t clock_pwm_wrap = 0;
+clock_channel_t clock_channels[CLOCK_CHANNEL_MAX];
 
 /**
- * Clock duty cycle
+ * Clock channel the console commands act on
  * 
- * @var u_int16_t
+ * @var clock_channel_t *
  */
-u_int16_t clock_duty_cycle = 50;
+clock_channel_t *clock_ch = &clock_channels[0];
 
 /**
- * Clock timer type
+ * Clock PWM slice owners (channel index, CLOCK_SLICE_REF or CLOCK_PIN_NONE)
  * 
- * 0 = repeating timer
- * 1 = pulse width modulation
+ * @var u_int8_t[]
+ */
+u_int8_t clock_slice_owner[CLOCK_SLICE_COUNT];
+
+/**
+ * Clock PWM starts program the slice but leave it stopped and the pins
+ * unclaimed, so a phase group can preload and start them together
  * 
- * @var u_int8_t
+ * @var bool
  */
-u_int8_t clock_timer_type = 0;
+bool clock_pwm_hold = false;
 
 /**
- * Clock repeating timer
+ * Clock channel defaults
  * 
- * @var struct repeating_timer
+ * @param clock_channel_t *ch
+ * @return void
  */
-struct repeating_timer clock_timer;
+static void clock_channel_defaults(clock_channel_t *ch)
+{
+    ch->started = false;
+    ch->mode = CLOCK_ASTABLE;
+    ch->freq_mhz = CLOCK_DEF_FREQ_HZ * 1000ULL;
+    ch->pwm_div = 0;
+    ch->pwm_wrap = 0;
+    ch->pwm_level = 0;
+    ch->pwm_ph_correct = false;
+    ch->dead_ticks = CLOCK_DEF_DEAD_TICKS;
+    ch->dead_steps = 0;
+    ch->duty_ppm = CLOCK_DEF_DUTY_PPM;
+    ch->duty_type = CLOCK_DUTY_RATIO;
+    ch->duty_ns = 0;
+    ch->engine = ENGINE_AUTO;
+    ch->timer_type = CLOCK_TIMER_RPT;
+    ch->spread_depth_ppm = 0;
+    ch->spread_rate_mhz = 0;
+    ch->spread_profile = SPREAD_TRIANGLE;
+    ch->track_mul = 0;
+    ch->track_div = 0;
+    ch->retune_pending = false;
+    ch->phase_master = CLOCK_PHASE_NONE;
+    ch->phase_ticks = false;
+    ch->phase_value = 0;
+    ch->vco_div = 0;
+    ch->pulse_mode = CLOCK_PULSE_FOLLOW;
+    ch->pulse_duty_ppm = CLOCK_DEF_DUTY_PPM;
+    ch->pulse_prescale = 0;
+    ch->pulse_state = false;
+    ch->rpt_state = false;
+}
 
 /**
  * Clock get mode
@@ -90,17 +218,74 @@ struct repeating_timer clock_timer;
  */
 u_int8_t clock_get_mode()
 {
-    return clock_mode;
+    return clock_ch->mode;
+}
+
+/**
+ * Clock apply the crystal calibration to a frequency
+ * 
+ * @param u_int64_t value
+ * @return u_int64_t
+ */
+static u_int64_t clock_apply_cal(u_int64_t value)
+{
+    return value + (int64_t) value * clock_cal_ppb / 1000000000;
 }
 
 /**
  * Clock get system frequency
  * 
+ * The calibrated frequency, so every plan built on it lands on the
+ * true output frequency rather than the crystal's nominal one.
+ * 
  * @return u_int32_t
  */
 u_int32_t clock_get_sys_freq_hz()
 {
-    return clock_get_hz(clk_sys);
+    return clock_apply_cal(clock_get_hz(clk_sys));
+}
+
+/**
+ * Clock get crystal calibration (positive when the crystal runs fast)
+ * 
+ * @return int32_t
+ */
+int32_t clock_get_cal_ppb()
+{
+    return clock_cal_ppb;
+}
+
+/**
+ * Clock get sys clock profile
+ * 
+ * @return u_int8_t
+ */
+u_int8_t clock_get_profile()
+{
+    return clock_profile;
+}
+
+/**
+ * Clock get sys clock profile name
+ * 
+ * @param u_int8_t profile
+ * @return const char *
+ */
+const char *clock_get_profile_name(u_int8_t profile)
+{
+    return profile < CLOCK_PROFILE_COUNT ? clock_profiles[profile].name : "?";
+}
+
+/**
+ * Clock get maximum output frequency in mHz for the live sys clock
+ * 
+ * Half the sys clock, the shortest PWM period that still toggles.
+ * 
+ * @return u_int64_t
+ */
+u_int64_t clock_get_max_freq_mhz()
+{
+    return clock_get_sys_freq_hz() * 1000ULL / PLAN_PERIOD_MIN;
 }
 
 /**
@@ -110,17 +295,27 @@ u_int32_t clock_get_sys_freq_hz()
  */
 u_int32_t clock_get_freq_hz()
 {
-    return clock_freq_hz;
+    return clock_ch->freq_mhz / 1000;
+}
+
+/**
+ * Clock get frequency in mHz
+ * 
+ * @return u_int64_t
+ */
+u_int64_t clock_get_freq_mhz()
+{
+    return clock_ch->freq_mhz;
 }
 
 /**
- * Clock get PWM div
+ * Clock get PWM div (8.4 fixed point)
  * 
  * @return u_int16_t
  */
 u_int16_t clock_get_pwm_div()
 {
-    return clock_pwm_div;
+    return clock_ch->pwm_div;
 }
 
 /**
@@ -130,7 +325,58 @@ u_int16_t clock_get_pwm_div()
  */
 u_int16_t clock_get_pwm_wrap()
 {
-    return clock_pwm_wrap;
+    return clock_ch->pwm_wrap;
+}
+
+/**
+ * Clock channel phase-correct mode (two-phase output is built on the up/down count)
+ * 
+ * @param const clock_channel_t *ch
+ * @return bool
+ */
+static bool clock_channel_ph_correct(const clock_channel_t *ch)
+{
+    return ch->pwm_ph_correct || ch->pulse_mode == CLOCK_PULSE_PHI1;
+}
+
+/**
+ * Clock get PWM phase-correct mode
+ * 
+ * @return bool
+ */
+bool clock_get_phase_correct()
+{
+    return clock_channel_ph_correct(clock_ch);
+}
+
+/**
+ * Clock get pulse pin mode
+ * 
+ * @return u_int8_t
+ */
+u_int8_t clock_get_pulse_mode()
+{
+    return clock_ch->pulse_mode;
+}
+
+/**
+ * Clock get pulse pin duty cycle in ppm
+ * 
+ * @return u_int32_t
+ */
+u_int32_t clock_get_pulse_duty_ppm()
+{
+    return clock_ch->pulse_duty_ppm;
+}
+
+/**
+ * Clock get pulse pin blink prescaler (0 when not blinking)
+ * 
+ * @return u_int32_t
+ */
+u_int32_t clock_get_pulse_prescale()
+{
+    return clock_ch->pulse_prescale;
 }
 
 /**
@@ -140,240 +386,2618 @@ u_int16_t clock_get_pwm_wrap()
  */
 u_int16_t clock_get_duty_cycle()
 {
-    return clock_duty_cycle;
+    return clock_ch->duty_ppm / 10000;
 }
 
 /**
- * Clock get timer type
+ * Clock get duty cycle in ppm
  * 
- * @return u_int8_t
+ * @return u_int32_t
  */
-u_int8_t clock_get_timer_type()
+u_int32_t clock_get_duty_ppm()
 {
-    return clock_timer_type;
+    return clock_ch->duty_ppm;
 }
 
 /**
- * Clock set frequency
+ * Clock get duty type
  * 
- * @param u_int32_t hz
- * @return void
+ * @return u_int8_t
  */
-void clock_set_freq_hz(u_int32_t hz)
+u_int8_t clock_get_duty_type()
 {
-    clock_freq_hz = hz;
+    return clock_ch->duty_type;
+}
 
-    clock_pulse_stop();
-    clock_pulse_start();
+/**
+ * Clock get duty absolute high/low time in ns
+ * 
+ * @return u_int32_t
+ */
+u_int32_t clock_get_duty_ns()
+{
+    return clock_ch->duty_ns;
 }
 
 /**
- * Clock set duty cycle
+ * Clock convert PWM counter steps to ps
  * 
- * @param u_int16_t duty_cycle
- * @return void
+ * One counter step lasts div / 16 sys clock cycles.
+ * 
+ * @param const clock_channel_t *ch
+ * @param u_int32_t steps
+ * @return u_int64_t
  */
-void clock_set_duty_cycle(u_int16_t duty_cycle)
+static u_int64_t clock_pwm_steps_to_ps(const clock_channel_t *ch, u_int32_t steps)
 {
-    clock_duty_cycle = duty_cycle;
+    u_int64_t sys_khz = clock_get_sys_freq_hz() / 1000;
 
-    clock_pulse_stop();
-    clock_pulse_start();
+    return ((u_int64_t) steps * ch->pwm_div * 1000000000 + sys_khz * 8) / (sys_khz * 16);
 }
 
 /**
- * Clock set PWM configuration
+ * Clock convert ns to PWM counter steps (rounded)
  * 
- * @param u_int8_t slice_num
- * @param u_int8_t channel
- * @return void
+ * @param u_int32_t ns
+ * @param u_int16_t div
+ * @return u_int64_t
  */
-void clock_set_pwm(u_int8_t slice_num, u_int8_t channel)
+static u_int64_t clock_pwm_ns_to_steps(u_int32_t ns, u_int16_t div)
 {
-    clock_pwm_div = ceil((float) clock_get_sys_freq_hz() / (4096 * clock_freq_hz) / 16);
-    clock_pwm_wrap = clock_get_sys_freq_hz() / clock_pwm_div / clock_freq_hz;
+    u_int64_t sys_khz = clock_get_sys_freq_hz() / 1000;
 
-    pwm_set_clkdiv(slice_num, clock_pwm_div);
-    pwm_set_wrap(slice_num, clock_pwm_wrap);
-    pwm_set_chan_level(slice_num, channel, clock_pwm_wrap * clock_duty_cycle / 100);
-    pwm_set_enabled(slice_num, true);
+    return ((u_int64_t) ns * sys_khz * 16 + div * 500000ULL) / (div * 1000000ULL);
 }
 
 /**
- * Clock start PWM
+ * Clock get PWM counter steps per level (phase-correct counts each level twice)
  * 
- * @return void
+ * @param const clock_channel_t *ch
+ * @return u_int32_t
  */
-void clock_start_pwm()
+static u_int32_t clock_pwm_level_steps(const clock_channel_t *ch)
 {
-    gpio_set_function(PULSE_PIN, GPIO_FUNC_PWM);
-    gpio_set_function(CLOCK_PIN, GPIO_FUNC_PWM);
-
-    clock_set_pwm(pwm_gpio_to_slice_num(PULSE_PIN), pwm_gpio_to_channel(PULSE_PIN));
-    clock_set_pwm(pwm_gpio_to_slice_num(CLOCK_PIN), pwm_gpio_to_channel(CLOCK_PIN));
+    return clock_channel_ph_correct(ch) ? 2 : 1;
+}
 
-    clock_timer_type = CLOCK_TIMER_PWM;
+/**
+ * Clock get PWM counter step in ps
+ * 
+ * @return u_int64_t
+ */
+u_int64_t clock_get_pwm_step_ps()
+{
+    return clock_pwm_steps_to_ps(clock_ch, clock_pwm_level_steps(clock_ch));
 }
 
 /**
- * Clock stop PWM
+ * Clock get PWM high time in ps
  * 
- * @return void
+ * @return u_int64_t
  */
-void clock_stop_pwm()
+u_int64_t clock_get_pwm_high_ps()
 {
-    pwm_set_enabled(pwm_gpio_to_slice_num(PULSE_PIN), false);
-    pwm_set_enabled(pwm_gpio_to_slice_num(CLOCK_PIN), false);
+    u_int32_t period = (u_int32_t) clock_ch->pwm_wrap + 1;
+    u_int32_t level = clock_ch->pwm_level < period ? clock_ch->pwm_level : period;
+
+    return clock_pwm_steps_to_ps(clock_ch, level * clock_pwm_level_steps(clock_ch));
 }
 
 /**
- * Clock repeating timer callback
+ * Clock get PWM low time in ps
  * 
- * @param struct repeating_timer *t
- * @return bool
+ * @return u_int64_t
  */
-bool clock_rpt_timer_callback(struct repeating_timer *t)
+u_int64_t clock_get_pwm_low_ps()
 {
-    static bool state = false;
-    state = !state;
+    u_int32_t period = (u_int32_t) clock_ch->pwm_wrap + 1;
 
-    if (state) {
-        gpio_put(CLOCK_PIN, 1);
-        gpio_put(PULSE_PIN, 1);
+    return clock_pwm_steps_to_ps(clock_ch, period * clock_pwm_level_steps(clock_ch)) - clock_get_pwm_high_ps();
+}
 
-        if (clock_mode == CLOCK_MONOSTABLE) {
-            return false;
-        }
-    } else {
-        gpio_put(CLOCK_PIN, 0);
-        gpio_put(PULSE_PIN, 0);
+/**
+ * Clock get two-phase dead time in sys clock ticks
+ * 
+ * @return u_int32_t
+ */
+u_int32_t clock_get_dead_ticks()
+{
+    return clock_ch->dead_ticks;
+}
+
+/**
+ * Clock get programmed two-phase dead time in ps
+ * 
+ * Rounded up to whole PWM counter steps in PWM mode.
+ * 
+ * @return u_int64_t
+ */
+u_int64_t clock_get_dead_ps()
+{
+    if (clock_ch->timer_type == CLOCK_TIMER_PWM) {
+        return clock_pwm_steps_to_ps(clock_ch, clock_ch->dead_steps);
     }
 
-    return true;
+    return (u_int64_t) clock_ch->dead_ticks * 1000000000000ULL / clock_get_sys_freq_hz();
 }
 
 /**
- * Clock start repeating timer
+ * Clock get timer type
+ * 
+ * @return u_int8_t
+ */
+u_int8_t clock_get_timer_type()
+{
+    return clock_ch->timer_type;
+}
+
+/**
+ * Clock get GPOUT plan (valid while the GPOUT engine runs)
  * 
+ * @param gpout_plan_t *plan
  * @return void
  */
-void clock_start_rpt()
+void clock_get_gpout_plan(gpout_plan_t *plan)
 {
-    gpio_init(CLOCK_PIN);
-    gpio_set_dir(CLOCK_PIN, GPIO_OUT);
+    *plan = clock_ch->gpout_plan;
+}
 
-    gpio_init(PULSE_PIN);
-    gpio_set_dir(PULSE_PIN, GPIO_OUT);
+/**
+ * Clock get GPOUT pin
+ * 
+ * @return u_int8_t
+ */
+u_int8_t clock_get_gpout_pin()
+{
+    return GPOUT_PIN;
+}
 
-    // duty cycle is not supported in repeating timer
-    clock_duty_cycle = 50;
+/**
+ * Clock get the master of a channel's phase group
+ * 
+ * A master is its own master. CLOCK_PHASE_NONE when not grouped.
+ * 
+ * @param const clock_channel_t *ch
+ * @return u_int8_t
+ */
+static u_int8_t clock_phase_get_master(const clock_channel_t *ch)
+{
+    u_int8_t index = ch - clock_channels;
 
-    u_int16_t ms = 1000 / clock_freq_hz;
-    if (clock_mode == CLOCK_MONOSTABLE) {
-        ms = 50;
+    if (ch->phase_master != CLOCK_PHASE_NONE) {
+        return ch->phase_master;
     }
 
-    add_repeating_timer_ms(ms, clock_rpt_timer_callback, NULL, &clock_timer);
+    for (u_int8_t i = 0; i < CLOCK_CHANNEL_MAX; i++) {
+        if (clock_channels[i].used && clock_channels[i].phase_master == index) {
+            return index;
+        }
+    }
 
-    clock_timer_type = CLOCK_TIMER_RPT;
+    return CLOCK_PHASE_NONE;
 }
 
 /**
- * Clock stop repeating timer
+ * Clock get output periods per spread modulation cycle at a frequency
  * 
- * @return void
+ * @param const clock_channel_t *ch
+ * @param u_int64_t mhz
+ * @return u_int64_t
  */
-void clock_stop_rpt()
+static u_int64_t clock_get_spread_periods(const clock_channel_t *ch, u_int64_t mhz)
 {
-    cancel_repeating_timer(&clock_timer);   
+    return ch->spread_rate_mhz ? (mhz + ch->spread_rate_mhz / 2) / ch->spread_rate_mhz : 0;
 }
 
 /**
- * Clock pulse start
+ * Clock spread modulation cycle fits a frequency
  * 
- * @return void
+ * @param const clock_channel_t *ch
+ * @param u_int64_t mhz
+ * @return bool
  */
-void clock_pulse_start()
+static bool clock_spread_fits(const clock_channel_t *ch, u_int64_t mhz)
 {
-    if (clock_started) {
-        return;
-    }
+    u_int64_t periods = clock_get_spread_periods(ch, mhz);
 
-    if (clock_freq_hz < 10) {
-        clock_start_rpt();
-    } else {
-        clock_start_pwm();
-    }
+    return periods >= SPREAD_TABLE_MIN && periods <= SPREAD_TABLE_MAX;
+}
+
+/**
+ * Clock channel spreads its PWM output
+ * 
+ * Two-phase output needs a fixed period for its dead time, a phase
+ * group needs the same period on every slice and a VCO owns the wrap.
+ * The plan only takes the headroom divider when spread_start() will
+ * accept the table, so a spread that cannot run never skews the plan.
+ * 
+ * @param const clock_channel_t *ch
+ * @return bool
+ */
+static bool clock_channel_spread(const clock_channel_t *ch)
+{
+    int slice = spread_get_slice();
 
-    clock_started = true;
+    return ch->spread_depth_ppm > 0 && ch->pulse_mode != CLOCK_PULSE_PHI1 && clock_phase_get_master(ch) == CLOCK_PHASE_NONE && ch->vco_div == 0 &&
+        clock_spread_fits(ch, ch->freq_mhz) && (slice < 0 || slice == (int) pwm_gpio_to_slice_num(ch->pin));
 }
 
 /**
- * Clock pulse stop
+ * Clock spread spectrum of the selected channel fits a frequency (true when off)
  * 
- * @return void
+ * @param u_int64_t mhz
+ * @return bool
  */
-void clock_pulse_stop()
+bool clock_spread_fits_freq_mhz(u_int64_t mhz)
+{
+    return clock_ch->spread_depth_ppm == 0 || clock_spread_fits(clock_ch, mhz);
+}
+
+/**
+ * Clock get spread spectrum depth in ppm (0 when off)
+ * 
+ * @return u_int32_t
+ */
+u_int32_t clock_get_spread_ppm()
 {
-    clock_stop_pwm();
-    clock_stop_rpt();
+    return clock_ch->spread_depth_ppm;
+}
 
-    clock_started = false;
+/**
+ * Clock get spread spectrum modulation rate in mHz
+ * 
+ * @return u_int64_t
+ */
+u_int64_t clock_get_spread_rate_mhz()
+{
+    return clock_ch->spread_rate_mhz;
 }
 
 /**
- * Clock step mode
+ * Clock get spread spectrum profile
  * 
- * @param bool enable
- * @return void
+ * @return u_int8_t
  */
-void clock_step(bool enable)
+u_int8_t clock_get_spread_profile()
 {
-    if (enable) {
-        clock_mode = CLOCK_MONOSTABLE;
-        clock_pulse_stop();
-    } else {
-        clock_mode = CLOCK_ASTABLE;
-        clock_pulse_start();
+    return clock_ch->spread_profile;
+}
+
+/**
+ * Clock get spread spectrum centre and band in mHz
+ * 
+ * @param u_int64_t *centre_mhz
+ * @param u_int64_t *min_mhz
+ * @param u_int64_t *max_mhz
+ * @return bool
+ */
+bool clock_get_spread_band(u_int64_t *centre_mhz, u_int64_t *min_mhz, u_int64_t *max_mhz)
+{
+    if (clock_ch->timer_type != CLOCK_TIMER_PWM || spread_get_slice() != (int) pwm_gpio_to_slice_num(clock_ch->pin)) {
+        return false;
     }
+
+    u_int32_t min_period, max_period;
+    spread_get_range(&min_period, &max_period);
+
+    // a period of n counter steps lasts n * div / 16 sys clock cycles
+    u_int64_t scale = (u_int64_t) clock_get_sys_freq_hz() * 16 * 1000 / clock_pwm_level_steps(clock_ch);
+
+    *centre_mhz = scale / ((u_int64_t) clock_ch->pwm_div * ((u_int32_t) clock_ch->pwm_wrap + 1));
+    *min_mhz = scale / ((u_int64_t) clock_ch->pwm_div * max_period);
+    *max_mhz = scale / ((u_int64_t) clock_ch->pwm_div * min_period);
+
+    return true;
 }
 
 /**
- * Clock pulse step
+ * Clock get engine preference (ENGINE_AUTO or a forced engine)
  * 
- * @return void
+ * @return u_int8_t
  */
-void clock_step_pulse()
+u_int8_t clock_get_engine()
 {
-    clock_start_rpt();
+    return clock_ch->engine;
 }
 
 /**
- * Clock reset
+ * Clock load PWM model from the live clock slice registers
  * 
+ * @param pwm_model_t *m
  * @return void
  */
-void clock_reset()
+static void clock_load_pwm_model(pwm_model_t *m)
 {
-    clock_started = false;
-    clock_freq_hz = CLOCK_DEF_FREQ_HZ;
-    clock_pwm_div = 0;
-    clock_pwm_wrap = 0;
-    clock_timer_type = CLOCK_ASTABLE;
+    pwm_slice_hw_t *slice = &pwm_hw->slice[pwm_gpio_to_slice_num(clock_ch->pin)];
 
-    clock_stop_pwm();
-    clock_stop_rpt();
+    pwm_model_load(m, slice->csr, slice->div, slice->ctr, slice->cc, slice->top);
+}
 
-    clock_pulse_start();
+/**
+ * Clock get actual PWM frequency in mHz
+ * 
+ * @return u_int64_t
+ */
+u_int64_t clock_get_actual_freq_mhz()
+{
+    pwm_model_t m;
+    clock_load_pwm_model(&m);
+
+    return pwm_model_get_freq_mhz(&m, clock_get_sys_freq_hz());
 }
 
 /**
- * Clock init function
+ * Clock get actual PWM duty cycle in ppm
  * 
- * @return void
+ * @return u_int32_t
  */
-void clock_init()
+u_int32_t clock_get_actual_duty_ppm()
 {
-    // start clock pulse
-    clock_pulse_start();
-}
\ No newline at end of file
+    pwm_model_t m;
+    clock_load_pwm_model(&m);
+
+    return pwm_model_get_duty_ppm(&m, pwm_gpio_to_channel(clock_ch->pin));
+}
+
+/**
+ * Clock get selected channel
+ * 
+ * @return u_int8_t
+ */
+u_int8_t clock_get_channel()
+{
+    return clock_ch - clock_channels;
+}
+
+/**
+ * Clock get channel info
+ * 
+ * @param u_int8_t index
+ * @param clock_channel_info_t *info
+ * @return bool
+ */
+bool clock_get_channel_info(u_int8_t index, clock_channel_info_t *info)
+{
+    if (index >= CLOCK_CHANNEL_MAX || !clock_channels[index].used) {
+        return false;
+    }
+
+    clock_channel_t *ch = &clock_channels[index];
+
+    info->pin = ch->pin;
+    info->pulse_pin = ch->pulse_pin;
+    info->slice = pwm_gpio_to_slice_num(ch->pin);
+    info->started = ch->started;
+    info->timer_type = ch->timer_type;
+    info->freq_mhz = ch->freq_mhz;
+    info->phase_master = ch->phase_master;
+    info->phase_ticks = ch->phase_ticks;
+    info->phase_value = ch->phase_value;
+    info->vco = ch->vco_div != 0;
+
+    return true;
+}
+
+/**
+ * Clock select the channel the console commands act on
+ * 
+ * @param u_int8_t index
+ * @return bool
+ */
+bool clock_select_channel(u_int8_t index)
+{
+    if (index >= CLOCK_CHANNEL_MAX || !clock_channels[index].used) {
+        return false;
+    }
+
+    clock_ch = &clock_channels[index];
+
+    return true;
+}
+
+/**
+ * Clock check a pin exists and is not reserved
+ * 
+ * @param u_int8_t pin
+ * @return u_int8_t
+ */
+static u_int8_t clock_check_pin(u_int8_t pin)
+{
+    if (pin >= NUM_BANK0_GPIOS) {
+        return CLOCK_CHANNEL_ERR_PIN;
+    }
+
+    for (size_t i = 0; i < sizeof(clock_reserved_pins); i++) {
+        if (clock_reserved_pins[i] == pin) {
+            return CLOCK_CHANNEL_ERR_RESERVED;
+        }
+    }
+
+    // the VCO's analog input
+    if (vco_is_active() && pin == VCO_GPIO_BASE + vco_get_input()) {
+        return CLOCK_CHANNEL_ERR_RESERVED;
+    }
+
+    // the trigger's input
+    if (trigger_is_active() && pin == trigger_get_pin()) {
+        return CLOCK_CHANNEL_ERR_RESERVED;
+    }
+
+    return CLOCK_CHANNEL_OK;
+}
+
+/**
+ * Clock add a channel on a pin (with an optional pulse pin on the same slice)
+ * 
+ * @param u_int8_t pin
+ * @param u_int8_t pulse_pin
+ * @param u_int8_t *index
+ * @return u_int8_t
+ */
+u_int8_t clock_add_channel(u_int8_t pin, u_int8_t pulse_pin, u_int8_t *index)
+{
+    u_int8_t err = clock_check_pin(pin);
+    if (err != CLOCK_CHANNEL_OK) {
+        return err;
+    }
+
+    // a PWM slice has one divider and wrap, so it belongs to one channel
+    if (clock_slice_owner[pwm_gpio_to_slice_num(pin)] != CLOCK_PIN_NONE) {
+        return CLOCK_CHANNEL_ERR_SLICE;
+    }
+
+    if (pulse_pin != CLOCK_PIN_NONE) {
+        err = clock_check_pin(pulse_pin);
+        if (err != CLOCK_CHANNEL_OK) {
+            return err;
+        }
+
+        // both pins are the two channels of the one slice
+        if (pulse_pin == pin || pwm_gpio_to_slice_num(pulse_pin) != pwm_gpio_to_slice_num(pin)) {
+            return CLOCK_CHANNEL_ERR_SLICE;
+        }
+    }
+
+    for (u_int8_t i = 0; i < CLOCK_CHANNEL_MAX; i++) {
+        clock_channel_t *ch = &clock_channels[i];
+        if (ch->used) {
+            continue;
+        }
+
+        clock_channel_defaults(ch);
+        ch->used = true;
+        ch->pin = pin;
+        ch->pulse_pin = pulse_pin;
+        clock_slice_owner[pwm_gpio_to_slice_num(pin)] = i;
+
+        *index = i;
+        return CLOCK_CHANNEL_OK;
+    }
+
+    return CLOCK_CHANNEL_ERR_FULL;
+}
+
+/**
+ * Clock channel stop (forward declaration)
+ * 
+ * @param clock_channel_t *ch
+ * @return void
+ */
+static void clock_channel_stop(clock_channel_t *ch);
+
+/**
+ * Clock channel start (forward declaration)
+ * 
+ * @param clock_channel_t *ch
+ * @return void
+ */
+static void clock_channel_start(clock_channel_t *ch);
+
+/**
+ * Clock select engine for a channel's request (forward declaration)
+ * 
+ * @param clock_channel_t *ch
+ * @return u_int8_t
+ */
+static u_int8_t clock_select_engine(clock_channel_t *ch);
+
+/**
+ * Clock align a phase group on its master (forward declaration)
+ * 
+ * @param u_int8_t master
+ * @return bool
+ */
+static bool clock_align_phase(u_int8_t master);
+
+/**
+ * Clock phase group can run aligned at the master's frequency (forward declaration)
+ * 
+ * @param u_int8_t master
+ * @return bool
+ */
+static bool clock_phase_can_align(u_int8_t master);
+
+/**
+ * Clock dissolve a phase group that can no longer be aligned (forward declaration)
+ * 
+ * @param u_int8_t master
+ * @return void
+ */
+static void clock_phase_dissolve(u_int8_t master);
+
+/**
+ * Clock channel driven by the VCO (NULL when idle)
+ * 
+ * @var clock_channel_t *
+ */
+clock_channel_t *clock_vco_ch = NULL;
+
+/**
+ * Clock set the VCO channel's divider for the whole curve
+ * 
+ * The lowest curve frequency needs the largest divider, every higher
+ * one fits under it with a shorter wrap as long as the highest still
+ * leaves PLAN_PERIOD_MIN counter steps, as a sweep requires.
+ * 
+ * @param clock_channel_t *ch
+ * @return bool
+ */
+static bool clock_vco_set_div(clock_channel_t *ch)
+{
+    u_int32_t sys_hz = clock_get_sys_freq_hz();
+    bool ph_correct = clock_channel_ph_correct(ch);
+    u_int64_t min_mhz, max_mhz;
+    plan_t plan, top;
+
+    vco_get_span(&min_mhz, &max_mhz);
+    ch->vco_div = 0;
+
+    if (max_mhz > clock_get_max_freq_mhz() || !plan_cache_solve(sys_hz, min_mhz, ch->duty_ppm, ph_correct, false, &plan)) {
+        return false;
+    }
+
+    // a wide curve can leave the top too few steps on the bottom's divider
+    if (!plan_fit(sys_hz, max_mhz, plan_get_div(&plan), ch->duty_ppm, ph_correct, &top)) {
+        return false;
+    }
+
+    ch->vco_div = plan_get_div(&plan);
+
+    return true;
+}
+
+/**
+ * Clock remove a channel (channel 0 drives the CPU and stays)
+ * 
+ * @param u_int8_t index
+ * @return bool
+ */
+bool clock_remove_channel(u_int8_t index)
+{
+    if (index == 0 || index >= CLOCK_CHANNEL_MAX || !clock_channels[index].used) {
+        return false;
+    }
+
+    clock_channel_t *ch = &clock_channels[index];
+
+    if (clock_vco_ch == ch) {
+        clock_stop_vco();
+    }
+
+    clock_clear_phase(index);
+    clock_channel_stop(ch);
+    gpio_set_function(ch->pin, GPIO_FUNC_NULL);
+    if (ch->pulse_pin != CLOCK_PIN_NONE) {
+        gpio_set_function(ch->pulse_pin, GPIO_FUNC_NULL);
+    }
+
+    clock_slice_owner[pwm_gpio_to_slice_num(ch->pin)] = CLOCK_PIN_NONE;
+    ch->used = false;
+
+    if (clock_ch == ch) {
+        clock_ch = &clock_channels[0];
+    }
+
+    return true;
+}
+
+/**
+ * Clock set sys clock profile
+ * 
+ * The core voltage is raised before and lowered after the PLL change.
+ * clk_peri is moved to the 48MHz USB PLL so the UART baud rate does not
+ * follow clk_sys, and every running channel is replanned for the new
+ * sys clock.
+ * 
+ * @param u_int8_t profile
+ * @return bool
+ */
+bool clock_set_profile(u_int8_t profile)
+{
+    if (profile >= CLOCK_PROFILE_COUNT) {
+        return false;
+    }
+
+    const clock_profile_t *next = &clock_profiles[profile];
+    bool raise = next->sys_khz > clock_get_hz(clk_sys) / 1000;
+    bool started[CLOCK_CHANNEL_MAX];
+
+    for (u_int8_t i = 0; i < CLOCK_CHANNEL_MAX; i++) {
+        started[i] = clock_channels[i].started;
+        clock_channel_stop(&clock_channels[i]);
+    }
+
+    stdio_flush();
+
+    if (raise) {
+        vreg_set_voltage(next->vreg);
+        busy_wait_us(10000);
+    }
+
+    bool ok = set_sys_clock_khz(next->sys_khz, false);
+
+    if (ok) {
+        if (!raise) {
+            vreg_set_voltage(next->vreg);
+        }
+
+        clock_configure(clk_peri, 0, CLOCKS_CLK_PERI_CTRL_AUXSRC_VALUE_CLKSRC_PLL_USB, 48 * MHZ, 48 * MHZ);
+#if LIB_PICO_STDIO_UART
+        uart_set_baudrate(uart_default, PICO_DEFAULT_UART_BAUD_RATE);
+#endif
+
+        clock_profile = profile;
+    }
+
+    // the curve's divider scales with the sys clock, a curve that no
+    // longer fits one divider stops following the input
+    if (clock_vco_ch != NULL && !clock_vco_set_div(clock_vco_ch)) {
+        clock_stop_vco();
+    }
+
+    for (u_int8_t i = 0; i < CLOCK_CHANNEL_MAX; i++) {
+        clock_channel_t *ch = &clock_channels[i];
+
+        // a frequency above the new limit is clamped rather than dropped
+        if (ch->freq_mhz > clock_get_max_freq_mhz()) {
+            ch->freq_mhz = clock_get_max_freq_mhz();
+        }
+
+        if (started[i]) {
+            clock_channel_start(ch);
+        }
+    }
+
+    // the groups were restarted one slice at a time, a group that no
+    // longer fits the new sys clock runs on as separate channels
+    for (u_int8_t i = 0; i < CLOCK_CHANNEL_MAX; i++) {
+        if (started[i] && clock_phase_get_master(&clock_channels[i]) == i && !clock_align_phase(i)) {
+            clock_phase_dissolve(i);
+        }
+    }
+
+    return ok;
+}
+
+/**
+ * Clock set PWM phase-correct mode (a phase group stays trailing-edge)
+ * 
+ * @param bool enable
+ * @return bool
+ */
+bool clock_set_phase_correct(bool enable)
+{
+    if (enable && clock_phase_get_master(clock_ch) != CLOCK_PHASE_NONE) {
+        return false;
+    }
+
+    clock_ch->pwm_ph_correct = enable;
+
+    if (clock_vco_ch == clock_ch && !clock_vco_set_div(clock_ch)) {
+        clock_stop_vco();
+    }
+
+    clock_pulse_stop();
+    clock_pulse_start();
+
+    return true;
+}
+
+/**
+ * Clock set pulse pin mode
+ * 
+ * @param u_int8_t mode
+ * @param u_int32_t duty_ppm
+ * @return bool
+ */
+bool clock_set_pulse_mode(u_int8_t mode, u_int32_t duty_ppm)
+{
+    if (clock_ch->pulse_pin == CLOCK_PIN_NONE) {
+        return false;
+    }
+
+    clock_ch->pulse_mode = mode;
+    clock_ch->pulse_duty_ppm = duty_ppm;
+
+    clock_pulse_stop();
+    clock_pulse_start();
+
+    return true;
+}
+
+/**
+ * Clock set two-phase output (PHI1 on the pulse pin) with dead time
+ * 
+ * @param u_int32_t ticks
+ * @return bool
+ */
+bool clock_set_two_phase(u_int32_t ticks)
+{
+    // two-phase counts up and down, a phase group cannot preload that
+    if (clock_ch->pulse_pin == CLOCK_PIN_NONE || clock_phase_get_master(clock_ch) != CLOCK_PHASE_NONE) {
+        return false;
+    }
+
+    bool running = clock_ch->pulse_mode == CLOCK_PULSE_PHI1;
+
+    clock_ch->pulse_mode = CLOCK_PULSE_PHI1;
+    clock_ch->dead_ticks = ticks;
+
+    // only the dead time changes on a running two-phase output
+    if (running) {
+        clock_retune();
+        return true;
+    }
+
+    clock_pulse_stop();
+    clock_pulse_start();
+
+    return true;
+}
+
+/**
+ * Clock set spread spectrum (depth 0 turns it off)
+ * 
+ * The rate must leave SPREAD_TABLE_MIN to SPREAD_TABLE_MAX output
+ * periods per modulation cycle, and only one channel can spread.
+ * 
+ * @param u_int32_t depth_ppm
+ * @param u_int64_t rate_mhz
+ * @param u_int8_t profile
+ * @return bool
+ */
+bool clock_set_spread(u_int32_t depth_ppm, u_int64_t rate_mhz, u_int8_t profile)
+{
+    int slice = spread_get_slice();
+
+    if (depth_ppm > 0) {
+        u_int64_t periods = rate_mhz ? (clock_ch->freq_mhz + rate_mhz / 2) / rate_mhz : 0;
+
+        if (depth_ppm > SPREAD_DEPTH_MAX_PPM || periods < SPREAD_TABLE_MIN || periods > SPREAD_TABLE_MAX) {
+            return false;
+        }
+
+        if (slice >= 0 && slice != (int) pwm_gpio_to_slice_num(clock_ch->pin)) {
+            return false;
+        }
+    }
+
+    clock_ch->spread_depth_ppm = depth_ppm;
+    clock_ch->spread_rate_mhz = rate_mhz;
+    clock_ch->spread_profile = profile;
+
+    clock_retune();
+
+    return true;
+}
+
+/**
+ * Clock set frequency
+ * 
+ * @param u_int32_t hz
+ * @return bool
+ */
+bool clock_set_freq_hz(u_int32_t hz)
+{
+    return clock_set_freq_mhz(hz * 1000ULL);
+}
+
+/**
+ * Clock set frequency in mHz
+ * 
+ * A frequency no engine can produce (PWM in a phase group), or one that
+ * leaves a spread spectrum outside its periods per modulation cycle, is
+ * refused and the output keeps running at the old one.
+ * 
+ * @param u_int64_t mhz
+ * @return bool
+ */
+bool clock_set_freq_mhz(u_int64_t mhz)
+{
+    u_int64_t old_mhz = clock_ch->freq_mhz;
+    u_int8_t master = clock_phase_get_master(clock_ch);
+
+    if (!clock_spread_fits_freq_mhz(mhz)) {
+        return false;
+    }
+
+    clock_ch->freq_mhz = mhz;
+    bool feasible = master != CLOCK_PHASE_NONE ? clock_phase_can_align(master) : clock_select_engine(clock_ch) != ENGINE_NONE;
+    clock_ch->freq_mhz = old_mhz;
+
+    if (!feasible) {
+        // leave the scores of the running request for the engine command
+        clock_select_engine(clock_ch);
+        return false;
+    }
+
+    // a manual frequency ends reference tracking and the VCO
+    if (clock_vco_ch == clock_ch) {
+        clock_stop_vco();
+    }
+
+    clock_ch->track_mul = 0;
+    clock_ch->track_div = 0;
+    clock_ch->freq_mhz = mhz;
+
+    clock_retune();
+
+    return true;
+}
+
+/**
+ * Clock set duty cycle
+ * 
+ * @param u_int16_t duty_cycle
+ * @return void
+ */
+void clock_set_duty_cycle(u_int16_t duty_cycle)
+{
+    clock_set_duty_ppm(duty_cycle * 10000);
+}
+
+/**
+ * Clock set duty cycle in ppm
+ * 
+ * @param u_int32_t ppm
+ * @return void
+ */
+void clock_set_duty_ppm(u_int32_t ppm)
+{
+    clock_ch->duty_type = CLOCK_DUTY_RATIO;
+    clock_ch->duty_ppm = ppm;
+
+    clock_retune();
+}
+
+/**
+ * Clock set absolute high time (tPWH)
+ * 
+ * @param u_int32_t ns
+ * @return void
+ */
+void clock_set_high_ns(u_int32_t ns)
+{
+    clock_ch->duty_type = CLOCK_DUTY_HIGH_NS;
+    clock_ch->duty_ns = ns;
+
+    clock_retune();
+}
+
+/**
+ * Clock set absolute low time (tPWL)
+ * 
+ * @param u_int32_t ns
+ * @return void
+ */
+void clock_set_low_ns(u_int32_t ns)
+{
+    clock_ch->duty_type = CLOCK_DUTY_LOW_NS;
+    clock_ch->duty_ns = ns;
+
+    clock_retune();
+}
+
+/**
+ * Clock get PWM level for a plan
+ * 
+ * Absolute high/low times are kept across retunes and clamped to the
+ * period of the new plan.
+ * 
+ * @param const clock_channel_t *ch
+ * @param const plan_t *plan
+ * @return u_int16_t
+ */
+static u_int16_t clock_get_plan_level(const clock_channel_t *ch, const plan_t *plan)
+{
+    if (ch->duty_type == CLOCK_DUTY_RATIO) {
+        return plan->level;
+    }
+
+    // a phase-correct level spans two counter steps
+    u_int32_t period = (u_int32_t) plan->top + 1;
+    u_int64_t steps = clock_pwm_ns_to_steps(ch->duty_ns, plan_get_div(plan) * (plan->ph_correct ? 2 : 1));
+
+    if (steps > period) {
+        steps = period;
+    }
+
+    return ch->duty_type == CLOCK_DUTY_HIGH_NS ? steps : period - steps;
+}
+
+/**
+ * Clock get PWM plan for the channel's frequency and duty cycle
+ * 
+ * Only the lookup that programs the slice counts in the plan cache
+ * statistics, engine selection and checks look the same plan up too.
+ * 
+ * @param const clock_channel_t *ch
+ * @param bool count
+ * @param plan_t *plan
+ * @return bool
+ */
+static bool clock_get_plan(const clock_channel_t *ch, bool count, plan_t *plan)
+{
+#if CLOCK_FIXED_FREQ
+    // fixed builds program the compile-time plan with no runtime math
+    if (
+        ch->freq_mhz == CLOCK_DEF_FREQ_HZ * 1000ULL &&
+        ch->duty_type == CLOCK_DUTY_RATIO &&
+        ch->duty_ppm == CLOCK_DEF_DUTY_PPM &&
+        !clock_channel_ph_correct(ch) &&
+        clock_get_sys_freq_hz() == CLOCK_FIXED_SYS_HZ
+    ) {
+        *plan = plan_const_default;
+        return true;
+    }
+#endif
+
+    u_int32_t sys_hz = clock_get_sys_freq_hz();
+    bool ph_correct = clock_channel_ph_correct(ch);
+
+    // a VCO keeps one divider so every retune latches at the wrap
+    if (ch->vco_div != 0 && plan_fit(sys_hz, ch->freq_mhz, ch->vco_div, ch->duty_ppm, ph_correct, plan)) {
+        return true;
+    }
+
+    // a phase group follower counts on its master's divider and wrap
+    u_int8_t master = clock_phase_get_master(ch);
+    if (master != CLOCK_PHASE_NONE && &clock_channels[master] != ch) {
+        if (!clock_get_plan(&clock_channels[master], count, plan)) {
+            return false;
+        }
+
+        plan->level = plan_get_level(plan, ch->duty_ppm);
+        return true;
+    }
+
+    // leave counter room for the longest spread period: take the divider
+    // of the bottom of the band and fit the centre frequency to it
+    if (clock_channel_spread(ch)) {
+        u_int64_t low_mhz = ch->freq_mhz * 1000000 / (1000000 + ch->spread_depth_ppm);
+
+        return low_mhz > 0 &&
+            plan_cache_solve(sys_hz, low_mhz, ch->duty_ppm, ph_correct, count, plan) &&
+            plan_fit(sys_hz, ch->freq_mhz, plan_get_div(plan), ch->duty_ppm, ph_correct, plan);
+    }
+
+    // cached or integer-only solve, no soft-float on the M0+
+    return plan_cache_solve(sys_hz, ch->freq_mhz, ch->duty_ppm, ph_correct, count, plan);
+}
+
+/**
+ * Clock get pulse channel PWM level for a plan
+ * 
+ * @param const clock_channel_t *ch
+ * @param const plan_t *plan
+ * @return u_int16_t
+ */
+static u_int16_t clock_get_pulse_level(const clock_channel_t *ch, const plan_t *plan)
+{
+    switch (ch->pulse_mode) {
+        case CLOCK_PULSE_DUTY:
+            return plan_get_level(plan, ch->pulse_duty_ppm);
+        case CLOCK_PULSE_BLINK:
+            return 0;
+        default:
+            return ch->pwm_level;
+    }
+}
+
+/**
+ * Clock set PWM configuration
+ * 
+ * The clock and pulse pins are the two channels of one slice, so the
+ * shared divider and wrap are written once and each channel gets its
+ * own level and polarity. TOP and CC are double buffered and latch at
+ * the next wrap, but DIV and PH_CORRECT apply on the next counter step,
+ * so a running slice only takes a plan glitch-free when those two are
+ * unchanged (see clock_pwm_latches()).
+ * 
+ * Two-phase output counts up and down: PHI1 is high while the counter
+ * is below its level and the inverted PHI2 while it is at or above
+ * its own, leaving the gap between the two levels as dead time on both
+ * edges.
+ * 
+ * @param clock_channel_t *ch
+ * @return void
+ */
+static void clock_set_pwm(clock_channel_t *ch)
+{
+    PROF_BEGIN(PROF_SITE_SET_PWM);
+
+    plan_t plan;
+    u_int8_t slice_num = pwm_gpio_to_slice_num(ch->pin);
+
+    // a running spread would overwrite the new wrap
+    if (spread_get_slice() == slice_num) {
+        spread_stop();
+    }
+
+    if (clock_get_plan(ch, true, &plan)) {
+        ch->pwm_div = plan_get_div(&plan);
+        ch->pwm_wrap = plan.top;
+        ch->pwm_level = clock_get_plan_level(ch, &plan);
+
+        u_int16_t clock_level = ch->pwm_level;
+        u_int16_t pulse_level = clock_get_pulse_level(ch, &plan);
+        bool clock_inv = false;
+        bool pulse_inv = ch->pulse_mode == CLOCK_PULSE_INVERT;
+
+        if (ch->pulse_mode == CLOCK_PULSE_PHI1) {
+            u_int32_t period = (u_int32_t) plan.top + 1;
+            u_int32_t steps = ((u_int64_t) ch->dead_ticks * 16 + ch->pwm_div - 1) / ch->pwm_div;
+
+            clock_level = period - (ch->pwm_level < period ? ch->pwm_level : period);
+            clock_inv = true;
+            pulse_level = steps < clock_level ? clock_level - steps : 0;
+            ch->dead_steps = clock_level - pulse_level;
+        }
+
+        bool clock_a = pwm_gpio_to_channel(ch->pin) == PWM_CHAN_A;
+
+        pwm_set_phase_correct(slice_num, plan.ph_correct);
+        pwm_set_clkdiv_int_frac(slice_num, plan.div_int, plan.div_frac);
+        pwm_set_wrap(slice_num, plan.top);
+        pwm_set_chan_level(slice_num, pwm_gpio_to_channel(ch->pin), clock_level);
+        if (ch->pulse_pin != CLOCK_PIN_NONE) {
+            pwm_set_chan_level(slice_num, pwm_gpio_to_channel(ch->pulse_pin), pulse_level);
+        }
+        pwm_set_output_polarity(slice_num, clock_a ? clock_inv : pulse_inv, clock_a ? pulse_inv : clock_inv);
+        if (!clock_pwm_hold) {
+            pwm_set_enabled(slice_num, true);
+        }
+
+        // one table entry per output period over a modulation cycle;
+        // clock_channel_spread() already checked everything spread_start()
+        // refuses, so the plan's headroom divider always gets its table
+        if (clock_channel_spread(ch)) {
+            u_int64_t periods = clock_get_spread_periods(ch, ch->freq_mhz);
+            spread_start(slice_num, (u_int32_t) plan.top + 1, periods, ch->spread_depth_ppm, ch->spread_profile);
+        }
+    }
+
+    PROF_END(PROF_SITE_SET_PWM);
+}
+
+/**
+ * Clock running slice can take a plan at its next wrap
+ * 
+ * Only TOP and CC are double buffered, a new divider or phase-correct
+ * mode would stretch or cut the period the counter is in.
+ * 
+ * @param const clock_channel_t *ch
+ * @param const plan_t *plan
+ * @return bool
+ */
+static bool clock_pwm_latches(const clock_channel_t *ch, const plan_t *plan)
+{
+    pwm_slice_hw_t *slice = &pwm_hw->slice[pwm_gpio_to_slice_num(ch->pin)];
+    pwm_model_t m;
+
+    pwm_model_load(&m, slice->csr, slice->div, slice->ctr, slice->cc, slice->top);
+
+    return m.div == plan_get_div(plan) && m.ph_correct == plan->ph_correct;
+}
+
+/**
+ * Clock hand the channel pins to the PWM slice
+ * 
+ * @param const clock_channel_t *ch
+ * @return void
+ */
+static void clock_set_pwm_pins(const clock_channel_t *ch)
+{
+    gpio_set_function(ch->pin, GPIO_FUNC_PWM);
+
+    // a blinking pulse pin is driven from its own timer
+    if (ch->pulse_pin != CLOCK_PIN_NONE && ch->pulse_mode != CLOCK_PULSE_BLINK) {
+        gpio_set_function(ch->pulse_pin, GPIO_FUNC_PWM);
+    }
+}
+
+/**
+ * Clock start PWM
+ * 
+ * @param clock_channel_t *ch
+ * @return void
+ */
+static void clock_start_pwm(clock_channel_t *ch)
+{
+    if (!clock_pwm_hold) {
+        clock_set_pwm_pins(ch);
+    }
+    clock_set_pwm(ch);
+
+    ch->timer_type = CLOCK_TIMER_PWM;
+}
+
+/**
+ * Clock stop PWM
+ * 
+ * @param clock_channel_t *ch
+ * @return void
+ */
+static void clock_stop_pwm(clock_channel_t *ch)
+{
+    u_int8_t slice_num = pwm_gpio_to_slice_num(ch->pin);
+
+    // a restart begins a whole period rather than finish the old one,
+    // a held one gets its counter preloaded instead
+    pwm_set_enabled(slice_num, false);
+    if (!clock_pwm_hold) {
+        pwm_set_counter(slice_num, 0);
+    }
+}
+
+/**
+ * Clock get GPOUT plan for the channel's frequency
+ * 
+ * Tries clk_sys and clk_usb as the divider source and keeps the one
+ * with the smallest frequency error, clk_sys on a tie.
+ * 
+ * @param const clock_channel_t *ch
+ * @param gpout_plan_t *plan
+ * @return bool
+ */
+static bool clock_get_gpout(const clock_channel_t *ch, gpout_plan_t *plan)
+{
+    gpout_plan_t usb;
+
+    bool has_sys = gpout_solve(CLOCKS_CLK_GPOUT0_CTRL_AUXSRC_VALUE_CLK_SYS, clock_get_sys_freq_hz(), ch->freq_mhz, plan);
+    bool has_usb = gpout_solve(CLOCKS_CLK_GPOUT0_CTRL_AUXSRC_VALUE_CLK_USB, clock_apply_cal(clock_get_hz(clk_usb)), ch->freq_mhz, &usb);
+
+    if (has_usb) {
+        u_int32_t sys_error = plan->error_ppb < 0 ? -plan->error_ppb : plan->error_ppb;
+        u_int32_t usb_error = usb.error_ppb < 0 ? -usb.error_ppb : usb.error_ppb;
+
+        if (!has_sys || usb_error < sys_error) {
+            *plan = usb;
+        }
+    }
+
+    return has_sys || has_usb;
+}
+
+/**
+ * Clock GPOUT is free for a channel (one clk_gpout0 shared by all)
+ * 
+ * @param const clock_channel_t *ch
+ * @return bool
+ */
+static bool clock_gpout_free(const clock_channel_t *ch)
+{
+    for (u_int8_t i = 0; i < CLOCK_CHANNEL_MAX; i++) {
+        const clock_channel_t *other = &clock_channels[i];
+
+        if (other != ch && other->used && other->started && other->timer_type == CLOCK_TIMER_GPOUT) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Clock start clk_gpout
+ * 
+ * @param clock_channel_t *ch
+ * @return void
+ */
+static void clock_start_gpout(clock_channel_t *ch)
+{
+    if (!clock_get_gpout(ch, &ch->gpout_plan)) {
+        return;
+    }
+
+    clock_gpio_init_int_frac(GPOUT_PIN, ch->gpout_plan.src, ch->gpout_plan.div_int, ch->gpout_plan.div_frac);
+
+    // odd integer divisors would otherwise skew the duty cycle
+    hw_set_bits(&clocks_hw->clk[clk_gpout0].ctrl, CLOCKS_CLK_GPOUT0_CTRL_DC50_BITS);
+
+    ch->timer_type = CLOCK_TIMER_GPOUT;
+}
+
+/**
+ * Clock stop clk_gpout (only if this channel owns it)
+ * 
+ * @param clock_channel_t *ch
+ * @return void
+ */
+static void clock_stop_gpout(clock_channel_t *ch)
+{
+    if (ch->timer_type != CLOCK_TIMER_GPOUT) {
+        return;
+    }
+
+    clock_stop(clk_gpout0);
+    gpio_set_function(GPOUT_PIN, GPIO_FUNC_NULL);
+}
+
+/**
+ * Clock drive the clock and pulse pins from software
+ * 
+ * A blinking pulse pin is left to its own timer while astable, the
+ * duty mode has no meaning here and follows the clock. Two-phase output
+ * drops the falling phase first and waits out the dead time before the
+ * other phase rises.
+ * 
+ * @param clock_channel_t *ch
+ * @param bool state
+ * @return void
+ */
+static void clock_put_outputs(clock_channel_t *ch, bool state)
+{
+    if (ch->pulse_pin == CLOCK_PIN_NONE) {
+        gpio_put(ch->pin, state);
+        return;
+    }
+
+    if (ch->pulse_mode == CLOCK_PULSE_PHI1) {
+        gpio_put(state ? ch->pulse_pin : ch->pin, false);
+        busy_wait_at_least_cycles(ch->dead_ticks);
+        gpio_put(state ? ch->pin : ch->pulse_pin, true);
+        return;
+    }
+
+    gpio_put(ch->pin, state);
+
+    if (ch->pulse_mode == CLOCK_PULSE_BLINK && ch->mode == CLOCK_ASTABLE) {
+        return;
+    }
+
+    gpio_put(ch->pulse_pin, ch->pulse_mode == CLOCK_PULSE_INVERT ? !state : state);
+}
+
+/**
+ * Clock pulse pin blink timer callback
+ * 
+ * @param struct repeating_timer *t
+ * @return bool
+ */
+bool clock_blink_timer_callback(struct repeating_timer *t)
+{
+    clock_channel_t *ch = t->user_data;
+
+    ch->pulse_state = !ch->pulse_state;
+    gpio_put(ch->pulse_pin, ch->pulse_state);
+
+    return true;
+}
+
+/**
+ * Clock start pulse pin blink
+ * 
+ * Divides the output frequency by the smallest power of two that brings
+ * the blink down to CLOCK_PULSE_BLINK_MAX_MHZ, so the LED shows activity
+ * at any rate without a spare PWM slice.
+ * 
+ * @param clock_channel_t *ch
+ * @return void
+ */
+static void clock_start_blink(clock_channel_t *ch)
+{
+    u_int64_t blink_mhz = ch->freq_mhz;
+
+    ch->pulse_prescale = 1;
+    while (blink_mhz > CLOCK_PULSE_BLINK_MAX_MHZ) {
+        blink_mhz >>= 1;
+        ch->pulse_prescale <<= 1;
+    }
+
+    gpio_init(ch->pulse_pin);
+    gpio_set_dir(ch->pulse_pin, GPIO_OUT);
+
+    ch->pulse_state = false;
+    gpio_put(ch->pulse_pin, ch->pulse_state);
+
+    add_repeating_timer_us(-(int64_t) (500000000ULL / blink_mhz), clock_blink_timer_callback, ch, &ch->pulse_timer);
+}
+
+/**
+ * Clock stop pulse pin blink
+ * 
+ * @param clock_channel_t *ch
+ * @return void
+ */
+static void clock_stop_blink(clock_channel_t *ch)
+{
+    cancel_repeating_timer(&ch->pulse_timer);
+    ch->pulse_prescale = 0;
+}
+
+/**
+ * Clock repeating timer callback
+ * 
+ * Only the channel selected on the console feeds the jitter capture.
+ * 
+ * @param struct repeating_timer *t
+ * @return bool
+ */
+bool clock_rpt_timer_callback(struct repeating_timer *t)
+{
+    PROF_BEGIN(PROF_SITE_RPT_CALLBACK);
+
+    clock_channel_t *ch = t->user_data;
+
+    // a monostable pulse ends on the first callback
+    if (ch->mode == CLOCK_MONOSTABLE) {
+        ch->rpt_state = false;
+    } else {
+        ch->rpt_state = !ch->rpt_state;
+    }
+
+    clock_put_outputs(ch, ch->rpt_state);
+
+    if (ch == clock_ch) {
+        jitter_record();
+    }
+
+    PROF_END(PROF_SITE_RPT_CALLBACK);
+
+    return ch->mode != CLOCK_MONOSTABLE;
+}
+
+/**
+ * Clock start repeating timer
+ * 
+ * @param clock_channel_t *ch
+ * @return void
+ */
+static void clock_start_rpt(clock_channel_t *ch)
+{
+    gpio_init(ch->pin);
+    gpio_set_dir(ch->pin, GPIO_OUT);
+
+    if (ch->pulse_pin != CLOCK_PIN_NONE) {
+        gpio_init(ch->pulse_pin);
+        gpio_set_dir(ch->pulse_pin, GPIO_OUT);
+    }
+
+    // duty cycle is not supported in repeating timer
+    ch->duty_type = CLOCK_DUTY_RATIO;
+    ch->duty_ppm = CLOCK_DEF_DUTY_PPM;
+
+    // toggle every half period, measured between callback starts
+    int64_t us = engine_get_rpt_half_us(ch->freq_mhz, clock_cal_ppb);
+    ch->rpt_state = false;
+
+    // engine selection keeps RPT above this, never arm a busy loop
+    if (us < ENGINE_RPT_MIN_US) {
+        us = ENGINE_RPT_MIN_US;
+    }
+
+    // monostable drives the pulse high now and the callback ends it
+    if (ch->mode == CLOCK_MONOSTABLE) {
+        us = 50000;
+        ch->rpt_state = true;
+    }
+
+    clock_put_outputs(ch, ch->rpt_state);
+
+    // step pulses accumulate into one capture, astable runs start afresh
+    if (ch == clock_ch) {
+        if (ch->mode == CLOCK_MONOSTABLE) {
+            jitter_record();
+        } else {
+            jitter_reset();
+        }
+    }
+
+    add_repeating_timer_us(-us, clock_rpt_timer_callback, ch, &ch->timer);
+
+    ch->timer_type = CLOCK_TIMER_RPT;
+}
+
+/**
+ * Clock stop repeating timer
+ * 
+ * @param clock_channel_t *ch
+ * @return void
+ */
+static void clock_stop_rpt(clock_channel_t *ch)
+{
+    cancel_repeating_timer(&ch->timer);
+}
+
+/**
+ * Clock get requested duty cycle in ppm
+ * 
+ * @param const clock_channel_t *ch
+ * @return u_int32_t
+ */
+static u_int32_t clock_get_requested_duty_ppm(const clock_channel_t *ch)
+{
+    if (ch->duty_type == CLOCK_DUTY_RATIO) {
+        return ch->duty_ppm;
+    }
+
+    // period is 1e12 / mhz ns
+    u_int64_t ppm = (u_int64_t) ch->duty_ns * ch->freq_mhz / 1000000;
+    if (ppm > 1000000) {
+        ppm = 1000000;
+    }
+
+    return ch->duty_type == CLOCK_DUTY_HIGH_NS ? ppm : 1000000 - ppm;
+}
+
+/**
+ * Clock select engine for a channel's request
+ * 
+ * @param clock_channel_t *ch
+ * @return u_int8_t
+ */
+static u_int8_t clock_select_engine(clock_channel_t *ch)
+{
+    plan_t plan;
+    bool has_plan = clock_get_plan(ch, false, &plan);
+
+    if (has_plan) {
+        plan.level = clock_get_plan_level(ch, &plan);
+    }
+
+    gpout_plan_t gpout;
+    bool has_gpout = clock_gpout_free(ch) && clock_get_gpout(ch, &gpout);
+
+    engine_request_t req = {
+        .sys_hz = clock_get_sys_freq_hz(),
+        .mhz = ch->freq_mhz,
+        .duty_ppm = clock_get_requested_duty_ppm(ch),
+        .plan = has_plan ? &plan : NULL,
+        .gpout = has_gpout ? &gpout : NULL,
+        .cal_ppb = clock_cal_ppb,
+        .preference = clock_phase_get_master(ch) != CLOCK_PHASE_NONE || ch->vco_div != 0 ? ENGINE_PWM : ch->engine,
+    };
+
+    return engine_select(&req);
+}
+
+/**
+ * Clock set engine preference (ENGINE_AUTO or a forced engine)
+ * 
+ * @param u_int8_t engine
+ * @return void
+ */
+void clock_set_engine(u_int8_t engine)
+{
+    clock_ch->engine = engine;
+
+    clock_pulse_stop();
+    clock_pulse_start();
+}
+
+/**
+ * Clock channel start
+ * 
+ * @param clock_channel_t *ch
+ * @return void
+ */
+static void clock_channel_start(clock_channel_t *ch)
+{
+    // step mode pulses only come from clock_step_pulse()
+    if (!ch->used || ch->started || ch->mode == CLOCK_MONOSTABLE) {
+        return;
+    }
+
+    switch (clock_select_engine(ch)) {
+        case ENGINE_RPT:
+            clock_start_rpt(ch);
+            break;
+        case ENGINE_PWM:
+            clock_start_pwm(ch);
+            break;
+        case ENGINE_GPOUT:
+            clock_start_gpout(ch);
+            break;
+        default:
+            // nothing can produce the request, the output stays stopped
+            return;
+    }
+
+    if (ch->pulse_pin != CLOCK_PIN_NONE && ch->pulse_mode == CLOCK_PULSE_BLINK && ch->mode == CLOCK_ASTABLE) {
+        clock_start_blink(ch);
+    }
+
+    ch->started = true;
+}
+
+/**
+ * Clock channel stop
+ * 
+ * @param clock_channel_t *ch
+ * @return void
+ */
+static void clock_channel_stop(clock_channel_t *ch)
+{
+    if (!ch->used) {
+        return;
+    }
+
+    // the sweep, PIO engines and clk_gpout are shared, only release them if owned
+    if (ch->started && ch->timer_type == CLOCK_TIMER_SWEEP) {
+        sweep_stop();
+    }
+
+    if (ch->started && ch->timer_type == CLOCK_TIMER_PATTERN) {
+        pattern_stop();
+    }
+
+    if (ch->started && ch->timer_type == CLOCK_TIMER_TRIGGER) {
+        trigger_stop();
+    }
+
+    if (ch->started) {
+        clock_stop_gpout(ch);
+    }
+
+    if (spread_get_slice() == (int) pwm_gpio_to_slice_num(ch->pin)) {
+        spread_stop();
+    }
+
+    clock_stop_pwm(ch);
+    clock_stop_rpt(ch);
+    clock_stop_blink(ch);
+
+    ch->started = false;
+}
+
+/**
+ * Clock phase group member (the master or one of its followers)
+ * 
+ * @param u_int8_t index
+ * @param u_int8_t master
+ * @return bool
+ */
+static bool clock_phase_is_member(u_int8_t index, u_int8_t master)
+{
+    return clock_channels[index].used && (index == master || clock_channels[index].phase_master == master);
+}
+
+/**
+ * Clock get a follower's counter lag in PWM counter steps
+ * 
+ * @param const clock_channel_t *ch
+ * @param u_int32_t period
+ * @return u_int32_t
+ */
+static u_int32_t clock_phase_get_steps(const clock_channel_t *ch, u_int32_t period)
+{
+    u_int64_t steps = ch->phase_ticks ?
+        ((u_int64_t) ch->phase_value * 16 + ch->pwm_div / 2) / ch->pwm_div :
+        ((u_int64_t) period * ch->phase_value + CLOCK_PHASE_MDEG_MAX / 2) / CLOCK_PHASE_MDEG_MAX;
+
+    return steps % period;
+}
+
+/**
+ * Clock phase group can run aligned at the master's frequency
+ * 
+ * Every member needs a PWM plan (the master's) and a counter that only
+ * counts up, since the lag is preloaded into it, and must be free
+ * running rather than stepped or retuned by the VCO.
+ * 
+ * @param u_int8_t master
+ * @return bool
+ */
+static bool clock_phase_can_align(u_int8_t master)
+{
+    plan_t plan;
+
+    if (!clock_get_plan(&clock_channels[master], false, &plan)) {
+        return false;
+    }
+
+    for (u_int8_t i = 0; i < CLOCK_CHANNEL_MAX; i++) {
+        if (!clock_phase_is_member(i, master)) {
+            continue;
+        }
+
+        clock_channel_t *ch = &clock_channels[i];
+        if (clock_channel_ph_correct(ch) || ch->mode != CLOCK_ASTABLE || ch->vco_div != 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Clock phase group dissolved by the last failed alignment
+ * 
+ * @var u_int8_t
+ */
+u_int8_t clock_phase_dissolved = CLOCK_PHASE_NONE;
+
+/**
+ * Clock dissolve a phase group that can no longer be aligned
+ * 
+ * The members are restarted on their own and the master is kept for
+ * clock_take_phase_dissolved() to report.
+ * 
+ * @param u_int8_t master
+ * @return void
+ */
+static void clock_phase_dissolve(u_int8_t master)
+{
+    u_int32_t members = 0;
+
+    for (u_int8_t i = 0; i < CLOCK_CHANNEL_MAX; i++) {
+        if (clock_phase_is_member(i, master)) {
+            members |= 1u << i;
+            clock_channels[i].phase_master = CLOCK_PHASE_NONE;
+        }
+    }
+
+    for (u_int8_t i = 0; i < CLOCK_CHANNEL_MAX; i++) {
+        if (members & (1u << i)) {
+            clock_channel_stop(&clock_channels[i]);
+            clock_channel_start(&clock_channels[i]);
+        }
+    }
+
+    clock_phase_dissolved = master;
+}
+
+/**
+ * Clock take the master of a phase group dissolved since the last call
+ * 
+ * @return u_int8_t
+ */
+u_int8_t clock_take_phase_dissolved()
+{
+    u_int8_t master = clock_phase_dissolved;
+
+    clock_phase_dissolved = CLOCK_PHASE_NONE;
+
+    return master;
+}
+
+/**
+ * Clock align a phase group on its master
+ * 
+ * Every member runs the master's divider and wrap, so once started
+ * together their counters stay a fixed number of steps apart. If the
+ * period is unchanged the levels are just reprogrammed and latch at the
+ * wrap. Otherwise the slices are stopped and restarted held, each
+ * follower's counter is preloaded to lag the master's by its offset
+ * before the pins are handed over, and all start on the same cycle
+ * through one write of the enable mask, so no pin sees a runt pulse. A group that cannot
+ * run aligned is refused before any slice is touched.
+ * 
+ * @param u_int8_t master
+ * @return bool
+ */
+static bool clock_align_phase(u_int8_t master)
+{
+    clock_channel_t *m = &clock_channels[master];
+    u_int16_t div = m->pwm_div;
+    u_int16_t wrap = m->pwm_wrap;
+    bool running = true;
+    plan_t plan;
+
+    if (!clock_phase_can_align(master) || !clock_get_plan(m, false, &plan)) {
+        return false;
+    }
+
+    for (u_int8_t i = 0; i < CLOCK_CHANNEL_MAX; i++) {
+        if (clock_phase_is_member(i, master)) {
+            clock_channel_t *ch = &clock_channels[i];
+            ch->freq_mhz = m->freq_mhz;
+            running = running && ch->started && ch->timer_type == CLOCK_TIMER_PWM;
+        }
+    }
+
+    if (running && plan_get_div(&plan) == div && plan.top == wrap) {
+        for (u_int8_t i = 0; i < CLOCK_CHANNEL_MAX; i++) {
+            if (clock_phase_is_member(i, master)) {
+                clock_set_pwm(&clock_channels[i]);
+            }
+        }
+
+        return true;
+    }
+
+    u_int32_t mask = 0;
+
+    clock_pwm_hold = true;
+
+    for (u_int8_t i = 0; i < CLOCK_CHANNEL_MAX; i++) {
+        if (clock_phase_is_member(i, master)) {
+            clock_channel_t *ch = &clock_channels[i];
+
+            clock_channel_stop(ch);
+            clock_channel_start(ch);
+
+            mask |= 1u << pwm_gpio_to_slice_num(ch->pin);
+        }
+    }
+
+    clock_pwm_hold = false;
+
+    u_int32_t period = (u_int32_t) m->pwm_wrap + 1;
+
+    for (u_int8_t i = 0; i < CLOCK_CHANNEL_MAX; i++) {
+        if (clock_phase_is_member(i, master)) {
+            clock_channel_t *ch = &clock_channels[i];
+            u_int32_t steps = i == master ? 0 : clock_phase_get_steps(ch, period);
+
+            pwm_set_counter(pwm_gpio_to_slice_num(ch->pin), (period - steps) % period);
+            clock_set_pwm_pins(ch);
+        }
+    }
+
+    pwm_set_mask_enabled(pwm_hw->en | mask);
+
+    return true;
+}
+
+/**
+ * Clock pulse start
+ * 
+ * A phase group member restarts its whole group aligned, or dissolves
+ * it when it can no longer be aligned.
+ * 
+ * @return void
+ */
+void clock_pulse_start()
+{
+    u_int8_t master = clock_phase_get_master(clock_ch);
+
+    if (master != CLOCK_PHASE_NONE) {
+        if (!clock_align_phase(master)) {
+            clock_phase_dissolve(master);
+        }
+
+        return;
+    }
+
+    clock_channel_start(clock_ch);
+}
+
+/**
+ * Clock channel retune a running PWM output in place
+ * 
+ * Only when the channel stays on PWM outside a phase group and the new
+ * plan keeps the slice's divider and phase-correct mode, so nothing is
+ * restarted and it is safe from a timer callback.
+ * 
+ * @param clock_channel_t *ch
+ * @return bool
+ */
+static bool clock_channel_retune_in_place(clock_channel_t *ch)
+{
+    plan_t plan;
+
+    if (
+        !ch->started || ch->timer_type != CLOCK_TIMER_PWM || clock_phase_get_master(ch) != CLOCK_PHASE_NONE ||
+        clock_select_engine(ch) != ENGINE_PWM || !clock_get_plan(ch, false, &plan) || !clock_pwm_latches(ch, &plan)
+    ) {
+        return false;
+    }
+
+    clock_set_pwm(ch);
+
+    // the blink prescaler follows the output frequency
+    if (ch->pulse_pin != CLOCK_PIN_NONE && ch->pulse_mode == CLOCK_PULSE_BLINK) {
+        clock_stop_blink(ch);
+        clock_start_blink(ch);
+    }
+
+    return true;
+}
+
+/**
+ * Clock channel retune to its current settings
+ * 
+ * A running PWM output that stays on PWM and keeps its divider and
+ * phase-correct mode is reprogrammed in place and takes the new plan at
+ * its next wrap; anything else is restarted, which cuts the running
+ * period short. A phase group is retuned as a whole, or dissolved when
+ * it can no longer be aligned.
+ * 
+ * @param clock_channel_t *ch
+ * @return void
+ */
+static void clock_channel_retune(clock_channel_t *ch)
+{
+    u_int8_t master = clock_phase_get_master(ch);
+
+    if (master != CLOCK_PHASE_NONE) {
+        if (!clock_align_phase(master)) {
+            clock_phase_dissolve(master);
+        }
+
+        return;
+    }
+
+    if (!clock_channel_retune_in_place(ch)) {
+        clock_channel_stop(ch);
+        clock_channel_start(ch);
+    }
+}
+
+/**
+ * Clock retune the selected channel to the current settings
+ * 
+ * @return void
+ */
+void clock_retune()
+{
+    clock_channel_retune(clock_ch);
+}
+
+/**
+ * Clock start a DMA sweep over the programmed steps
+ * 
+ * The sweep takes over the channel's slice; both slice channels get the
+ * same level, so the pulse pin can only follow or invert the clock.
+ * Any other retune ends the sweep and restores the channel's own
+ * frequency.
+ * 
+ * @param u_int32_t dwell_ms
+ * @param bool loop
+ * @return bool
+ */
+bool clock_start_sweep(u_int32_t dwell_ms, bool loop)
+{
+    clock_channel_t *ch = clock_ch;
+
+    // one sweep at a time, a running one on this channel is replaced
+    if (sweep_is_active() && !(ch->started && ch->timer_type == CLOCK_TIMER_SWEEP)) {
+        return false;
+    }
+
+    if (ch->pulse_mode == CLOCK_PULSE_DUTY || ch->pulse_mode == CLOCK_PULSE_PHI1) {
+        return false;
+    }
+
+    clock_channel_stop(ch);
+
+    u_int8_t slice_num = pwm_gpio_to_slice_num(ch->pin);
+    bool pulse_inv = ch->pulse_mode == CLOCK_PULSE_INVERT;
+    bool clock_a = pwm_gpio_to_channel(ch->pin) == PWM_CHAN_A;
+
+    clock_set_pwm_pins(ch);
+    pwm_set_phase_correct(slice_num, ch->pwm_ph_correct);
+    pwm_set_output_polarity(slice_num, clock_a ? false : pulse_inv, clock_a ? pulse_inv : false);
+
+    u_int32_t duty_ppm = ch->duty_type == CLOCK_DUTY_RATIO ? ch->duty_ppm : CLOCK_DEF_DUTY_PPM;
+
+    if (!sweep_start(slice_num, clock_get_sys_freq_hz(), duty_ppm, ch->pwm_ph_correct, dwell_ms, loop)) {
+        clock_channel_start(ch);
+        return false;
+    }
+
+    ch->timer_type = CLOCK_TIMER_SWEEP;
+    ch->pwm_div = sweep_get_div();
+
+    if (ch->pulse_pin != CLOCK_PIN_NONE && ch->pulse_mode == CLOCK_PULSE_BLINK) {
+        clock_start_blink(ch);
+    }
+
+    ch->started = true;
+
+    return true;
+}
+
+/**
+ * Clock start the PIO pattern engine on the clock pin
+ * 
+ * Plays the published pattern in a loop. The pulse pin is held low as
+ * the state machine only drives the clock pin.
+ * 
+ * @return bool
+ */
+bool clock_start_pattern()
+{
+    clock_channel_t *ch = clock_ch;
+
+    if (pattern_is_active()) {
+        return false;
+    }
+
+    clock_channel_stop(ch);
+
+    if (!pattern_start(ch->pin)) {
+        clock_channel_start(ch);
+        return false;
+    }
+
+    if (ch->pulse_pin != CLOCK_PIN_NONE) {
+        gpio_init(ch->pulse_pin);
+        gpio_set_dir(ch->pulse_pin, GPIO_OUT);
+    }
+
+    ch->timer_type = CLOCK_TIMER_PATTERN;
+    ch->started = true;
+
+    return true;
+}
+
+/**
+ * Clock start the PIO trigger engine on the clock pin
+ * 
+ * The output runs at the channel frequency rounded to whole sys clock
+ * ticks per half period, with a 50% duty cycle. The input may not be a
+ * reserved pin, one of the channels' outputs or the reference input.
+ * 
+ * @param u_int8_t trigger_pin
+ * @param u_int32_t count
+ * @return bool
+ */
+bool clock_start_trigger(u_int8_t trigger_pin, u_int32_t count)
+{
+    clock_channel_t *ch = clock_ch;
+
+    if (trigger_is_active() || clock_check_pin(trigger_pin) != CLOCK_CHANNEL_OK || (ref_is_active() && ref_get_pin() == trigger_pin)) {
+        return false;
+    }
+
+    for (u_int8_t i = 0; i < CLOCK_CHANNEL_MAX; i++) {
+        if (clock_channels[i].used && (clock_channels[i].pin == trigger_pin || clock_channels[i].pulse_pin == trigger_pin)) {
+            return false;
+        }
+    }
+
+    u_int64_t half_ticks = ((u_int64_t) clock_get_sys_freq_hz() * 1000 + ch->freq_mhz) / (ch->freq_mhz * 2);
+
+    clock_channel_stop(ch);
+
+    if (!trigger_start(ch->pin, trigger_pin, half_ticks, count)) {
+        clock_channel_start(ch);
+        return false;
+    }
+
+    if (ch->pulse_pin != CLOCK_PIN_NONE) {
+        gpio_init(ch->pulse_pin);
+        gpio_set_dir(ch->pulse_pin, GPIO_OUT);
+    }
+
+    ch->timer_type = CLOCK_TIMER_TRIGGER;
+    ch->started = true;
+
+    return true;
+}
+
+/**
+ * Clock make a channel follow the selected one at a phase offset
+ * 
+ * The follower takes the selected channel's frequency and PWM plan and
+ * keeps its own duty cycle. Both must be able to run trailing-edge PWM.
+ * 
+ * @param u_int8_t index
+ * @param bool ticks
+ * @param u_int32_t value
+ * @return bool
+ */
+bool clock_set_phase(u_int8_t index, bool ticks, u_int32_t value)
+{
+    u_int8_t master = clock_ch - clock_channels;
+
+    if (
+        index >= CLOCK_CHANNEL_MAX || index == master || !clock_channels[index].used ||
+        clock_ch->phase_master != CLOCK_PHASE_NONE || (!ticks && value >= CLOCK_PHASE_MDEG_MAX)
+    ) {
+        return false;
+    }
+
+    clock_channel_t *ch = &clock_channels[index];
+
+    // a master cannot join another group, the VCO retunes from its alarm
+    if (clock_phase_get_master(ch) == index || clock_vco_ch == ch || clock_vco_ch == clock_ch) {
+        return false;
+    }
+
+    ch->phase_master = master;
+    ch->phase_ticks = ticks;
+    ch->phase_value = value;
+
+    // a refused alignment has not touched either slice
+    if (!clock_align_phase(master)) {
+        ch->phase_master = CLOCK_PHASE_NONE;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Clock take a channel out of its phase group (a master dissolves it)
+ * 
+ * The outputs keep running as they are until their next retune.
+ * 
+ * @param u_int8_t index
+ * @return bool
+ */
+bool clock_clear_phase(u_int8_t index)
+{
+    if (index >= CLOCK_CHANNEL_MAX || !clock_channels[index].used) {
+        return false;
+    }
+
+    clock_channel_t *ch = &clock_channels[index];
+
+    if (ch->phase_master != CLOCK_PHASE_NONE) {
+        ch->phase_master = CLOCK_PHASE_NONE;
+        return true;
+    }
+
+    if (clock_phase_get_master(ch) != index) {
+        return false;
+    }
+
+    for (u_int8_t i = 0; i < CLOCK_CHANNEL_MAX; i++) {
+        if (clock_channels[i].phase_master == index) {
+            clock_channels[i].phase_master = CLOCK_PHASE_NONE;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Clock reference tracking timer
+ * 
+ * @var repeating_timer
+ */
+struct repeating_timer clock_track_timer;
+
+/**
+ * Clock reference tracking timer is running
+ * 
+ * @var bool
+ */
+bool clock_track_running = false;
+
+/**
+ * Clock reference edges at the last tracking update
+ * 
+ * @var u_int64_t
+ */
+u_int64_t clock_track_edges = 0;
+
+/**
+ * Clock reference timestamp at the last tracking update
+ * 
+ * @var u_int64_t
+ */
+u_int64_t clock_track_us = 0;
+
+/**
+ * Clock reference tracking timer callback
+ * 
+ * A frequency-locked loop: each update measures the reference over the
+ * last interval against the board's timebase and moves every tracking
+ * channel 1/CLOCK_TRACK_GAIN of the way to its ratio of it, which
+ * averages out the timestamp jitter. The output and the measurement
+ * share the crystal, so its drift cancels and the ratio holds.
+ * 
+ * Runs in the alarm IRQ, so only a PWM output that takes the change at
+ * its wrap is retuned here; any other engine would be restarted and is
+ * left to clock_poll().
+ * 
+ * @param struct repeating_timer *t
+ * @return bool
+ */
+bool clock_track_timer_callback(struct repeating_timer *t)
+{
+    u_int64_t edges, us;
+
+    // hold the last frequency while the reference is missing
+    if (!ref_has_signal() || !ref_get_snapshot(&edges, &us)) {
+        return true;
+    }
+
+    // measured against the crystal, so correct it like the sys clock
+    bool primed = clock_track_us != 0 && us > clock_track_us;
+    u_int64_t ref_mhz = primed ? clock_apply_cal((edges - clock_track_edges) * 1000000000ULL / (us - clock_track_us)) : 0;
+
+    clock_track_edges = edges;
+    clock_track_us = us;
+
+    if (ref_mhz == 0) {
+        return true;
+    }
+
+    for (u_int8_t i = 0; i < CLOCK_CHANNEL_MAX; i++) {
+        clock_channel_t *ch = &clock_channels[i];
+        if (!ch->used || ch->track_div == 0) {
+            continue;
+        }
+
+        u_int64_t target = ref_mhz * ch->track_mul / ch->track_div;
+        u_int64_t max_mhz = clock_get_max_freq_mhz();
+        target = target > max_mhz ? max_mhz : target;
+        target = target < 1 ? 1 : target;
+
+        int64_t step = ((int64_t) target - (int64_t) ch->freq_mhz) / CLOCK_TRACK_GAIN;
+        u_int64_t mhz = step == 0 ? target : ch->freq_mhz + step;
+
+        if (mhz != ch->freq_mhz) {
+            ch->freq_mhz = mhz;
+            // a stopped channel picks the frequency up when it restarts
+            ch->retune_pending = ch->started && !clock_channel_retune_in_place(ch);
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Clock apply tracked and VCO frequencies the alarm IRQ could not (main loop)
+ * 
+ * Console commands also run from the alarm IRQ, so the restart is kept
+ * from interleaving with them.
+ * 
+ * @return void
+ */
+void clock_poll()
+{
+    for (u_int8_t i = 0; i < CLOCK_CHANNEL_MAX; i++) {
+        clock_channel_t *ch = &clock_channels[i];
+        if (!ch->retune_pending) {
+            continue;
+        }
+
+        u_int32_t status = save_and_disable_interrupts();
+
+        ch->retune_pending = false;
+        if (ch->used && ch->started) {
+            clock_channel_retune(ch);
+        }
+
+        restore_interrupts(status);
+    }
+}
+
+/**
+ * Clock set the reference input (a PWM B pin on a free slice)
+ * 
+ * The slice counts the reference edges, so it is taken from the
+ * channels until the reference is cleared.
+ * 
+ * @param u_int8_t pin
+ * @param u_int32_t nominal_hz
+ * @return u_int8_t
+ */
+u_int8_t clock_set_reference(u_int8_t pin, u_int32_t nominal_hz)
+{
+    u_int8_t err = clock_check_pin(pin);
+    if (err != CLOCK_CHANNEL_OK) {
+        return err;
+    }
+
+    if (pwm_gpio_to_channel(pin) != PWM_CHAN_B) {
+        return CLOCK_CHANNEL_ERR_PIN;
+    }
+
+    clock_clear_reference();
+
+    u_int8_t slice_num = pwm_gpio_to_slice_num(pin);
+    if (clock_slice_owner[slice_num] != CLOCK_PIN_NONE) {
+        return CLOCK_CHANNEL_ERR_SLICE;
+    }
+
+    if (!ref_start(pin, nominal_hz)) {
+        return CLOCK_CHANNEL_ERR_PIN;
+    }
+
+    clock_slice_owner[slice_num] = CLOCK_SLICE_REF;
+
+    return CLOCK_CHANNEL_OK;
+}
+
+/**
+ * Clock clear the reference input and stop all tracking
+ * 
+ * Tracking channels keep their last frequency.
+ * 
+ * @return void
+ */
+void clock_clear_reference()
+{
+    if (!ref_is_active()) {
+        return;
+    }
+
+    if (clock_track_running) {
+        cancel_repeating_timer(&clock_track_timer);
+        clock_track_running = false;
+    }
+
+    for (u_int8_t i = 0; i < CLOCK_CHANNEL_MAX; i++) {
+        clock_channels[i].track_mul = 0;
+        clock_channels[i].track_div = 0;
+    }
+
+    clock_slice_owner[pwm_gpio_to_slice_num(ref_get_pin())] = CLOCK_PIN_NONE;
+    ref_stop();
+}
+
+/**
+ * Clock set and store the crystal calibration
+ * 
+ * Every running channel is replanned on the corrected sys clock. The
+ * flash write stalls interrupts, so the reference window restarts.
+ * 
+ * @param int32_t ppb
+ * @return bool
+ */
+bool clock_set_cal_ppb(int32_t ppb)
+{
+    if (ppb > CLOCK_CAL_MAX_PPB || ppb < -CLOCK_CAL_MAX_PPB) {
+        return false;
+    }
+
+    clock_cal_ppb = ppb;
+    cal_save(ppb);
+
+    ref_reset();
+    clock_track_us = 0;
+
+    for (u_int8_t i = 0; i < CLOCK_CHANNEL_MAX; i++) {
+        if (clock_channels[i].used && clock_channels[i].started) {
+            clock_channel_retune(&clock_channels[i]);
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Clock calibrate the crystal against the reference input
+ * 
+ * The reference is taken as exact: counting it fast by e means the
+ * crystal runs slow by e / (1 + e). Needs CLOCK_CAL_MIN_US of
+ * measurement, longer windows average out more timestamp jitter.
+ * 
+ * @return bool
+ */
+bool clock_calibrate()
+{
+    int64_t error_ppb;
+
+    if (!ref_has_signal() || ref_get_window_us() < CLOCK_CAL_MIN_US || !ref_get_error_ppb(&error_ppb)) {
+        return false;
+    }
+
+    return clock_set_cal_ppb(-error_ppb * 1000000000 / (1000000000 + error_ppb));
+}
+
+/**
+ * Clock track the reference with the selected channel (0 / 0 is off)
+ * 
+ * The channel runs at mul / div times the measured reference and
+ * follows it from then on, one timer serving every tracking channel.
+ * 
+ * @param u_int32_t mul
+ * @param u_int32_t div
+ * @return bool
+ */
+bool clock_set_track(u_int32_t mul, u_int32_t div)
+{
+    if (mul == 0 && div == 0) {
+        clock_ch->track_mul = 0;
+        clock_ch->track_div = 0;
+        return true;
+    }
+
+    if (!ref_is_active() || clock_vco_ch == clock_ch || mul == 0 || div == 0 || mul > CLOCK_TRACK_RATIO_MAX || div > CLOCK_TRACK_RATIO_MAX) {
+        return false;
+    }
+
+    // start from the nominal ratio, the loop then pulls it onto the reference
+    u_int64_t mhz = (u_int64_t) ref_get_nominal_hz() * 1000 * mul / div;
+    if (mhz == 0 || mhz > clock_get_max_freq_mhz()) {
+        return false;
+    }
+
+    clock_ch->track_mul = mul;
+    clock_ch->track_div = div;
+    clock_ch->freq_mhz = mhz;
+    clock_channel_retune(clock_ch);
+
+    if (!clock_track_running) {
+        clock_track_edges = 0;
+        clock_track_us = 0;
+        clock_track_running = add_repeating_timer_ms(CLOCK_TRACK_MS, clock_track_timer_callback, NULL, &clock_track_timer);
+    }
+
+    return true;
+}
+
+/**
+ * Clock get tracking ratio of the selected channel
+ * 
+ * @param u_int32_t *mul
+ * @param u_int32_t *div
+ * @return bool
+ */
+bool clock_get_track(u_int32_t *mul, u_int32_t *div)
+{
+    *mul = clock_ch->track_mul;
+    *div = clock_ch->track_div;
+
+    return clock_ch->track_div != 0;
+}
+
+/**
+ * Clock VCO timer
+ * 
+ * @var repeating_timer
+ */
+struct repeating_timer clock_vco_timer;
+
+/**
+ * Clock ADC level at the last VCO retune
+ * 
+ * @var int32_t
+ */
+int32_t clock_vco_level = -1;
+
+/**
+ * Clock VCO timer callback
+ * 
+ * The DMA ring already holds the latest samples, so a retune costs one
+ * average and one plan_fit. TOP and CC latch at the next wrap on the
+ * fixed divider, which bounds the latency to CLOCK_VCO_MS, the ring's
+ * averaging window and one output period. A retune that would restart
+ * the engine is left to clock_poll().
+ * 
+ * @param struct repeating_timer *t
+ * @return bool
+ */
+bool clock_vco_timer_callback(struct repeating_timer *t)
+{
+    clock_channel_t *ch = clock_vco_ch;
+    int32_t level = vco_get_level();
+    int32_t delta = level > clock_vco_level ? level - clock_vco_level : clock_vco_level - level;
+
+    // the deadband keeps ADC noise from retuning a still input
+    if (clock_vco_level >= 0 && delta <= CLOCK_VCO_DEADBAND) {
+        return true;
+    }
+
+    clock_vco_level = level;
+
+    u_int64_t mhz = vco_get_freq_mhz(level);
+    if (mhz == ch->freq_mhz) {
+        return true;
+    }
+
+    ch->freq_mhz = mhz;
+
+    // like tracking, only an in-place PWM retune runs in the alarm IRQ,
+    // and a stopped channel picks the frequency up when it restarts
+    ch->retune_pending = ch->started && !clock_channel_retune_in_place(ch);
+
+    return true;
+}
+
+/**
+ * Clock drive the selected channel's frequency from an ADC input
+ * 
+ * Uses the curve set with vco_set_curve or vco_set_range. Phase groups
+ * retune by restarting, so their channels are refused, as is an input
+ * whose pin is a channel or the reference.
+ * 
+ * @param u_int8_t input
+ * @return bool
+ */
+bool clock_start_vco(u_int8_t input)
+{
+    u_int8_t pin = VCO_GPIO_BASE + input;
+
+    if (clock_vco_ch != NULL || clock_phase_get_master(clock_ch) != CLOCK_PHASE_NONE) {
+        return false;
+    }
+
+    if ((ref_is_active() && ref_get_pin() == pin) || (trigger_is_active() && trigger_get_pin() == pin)) {
+        return false;
+    }
+
+    for (u_int8_t i = 0; i < CLOCK_CHANNEL_MAX; i++) {
+        if (clock_channels[i].used && (clock_channels[i].pin == pin || clock_channels[i].pulse_pin == pin)) {
+            return false;
+        }
+    }
+
+    if (!clock_vco_set_div(clock_ch)) {
+        return false;
+    }
+
+    if (!vco_start(input)) {
+        clock_ch->vco_div = 0;
+        return false;
+    }
+
+    // the callback reads the channel, so it is set before the timer runs
+    clock_vco_ch = clock_ch;
+    clock_vco_level = -1;
+
+    if (!add_repeating_timer_ms(CLOCK_VCO_MS, clock_vco_timer_callback, NULL, &clock_vco_timer)) {
+        vco_stop();
+        clock_vco_ch = NULL;
+        clock_ch->vco_div = 0;
+        return false;
+    }
+
+    clock_ch->track_mul = 0;
+    clock_ch->track_div = 0;
+
+    // move onto the fixed divider before the first sample lands
+    u_int64_t max_mhz;
+    vco_get_span(&clock_ch->freq_mhz, &max_mhz);
+    if (clock_ch->started) {
+        clock_channel_retune(clock_ch);
+    }
+
+    return true;
+}
+
+/**
+ * Clock stop the VCO, the channel keeps its last frequency
+ * 
+ * @return void
+ */
+void clock_stop_vco()
+{
+    clock_channel_t *ch = clock_vco_ch;
+
+    if (ch == NULL) {
+        return;
+    }
+
+    cancel_repeating_timer(&clock_vco_timer);
+    vco_stop();
+
+    clock_vco_ch = NULL;
+    ch->vco_div = 0;
+
+    if (ch->started) {
+        clock_channel_retune(ch);
+    }
+}
+
+/**
+ * Clock selected channel is driven by the VCO
+ * 
+ * @return bool
+ */
+bool clock_get_vco()
+{
+    return clock_vco_ch == clock_ch;
+}
+
+/**
+ * Clock selected channel is in a phase group (master or follower)
+ * 
+ * @return bool
+ */
+bool clock_get_phase_group()
+{
+    return clock_phase_get_master(clock_ch) != CLOCK_PHASE_NONE;
+}
+
+/**
+ * Clock pulse stop
+ * 
+ * @return void
+ */
+void clock_pulse_stop()
+{
+    clock_channel_stop(clock_ch);
+}
+
+/**
+ * Clock step mode (a phase group member cannot step)
+ * 
+ * @param bool enable
+ * @return bool
+ */
+bool clock_step(bool enable)
+{
+    if (enable && clock_phase_get_master(clock_ch) != CLOCK_PHASE_NONE) {
+        return false;
+    }
+
+    if (enable) {
+        clock_ch->mode = CLOCK_MONOSTABLE;
+        clock_pulse_stop();
+        jitter_reset();
+    } else {
+        // a step pulse still in flight would share the timer
+        clock_stop_rpt(clock_ch);
+        clock_ch->mode = CLOCK_ASTABLE;
+        clock_pulse_start();
+    }
+
+    return true;
+}
+
+/**
+ * Clock pulse step
+ * 
+ * @return void
+ */
+void clock_step_pulse()
+{
+    // cancel a pulse still in flight before the timer is re-armed
+    clock_stop_rpt(clock_ch);
+    clock_start_rpt(clock_ch);
+}
+
+/**
+ * Clock reset the selected channel
+ * 
+ * @return void
+ */
+void clock_reset()
+{
+    if (clock_vco_ch == clock_ch) {
+        clock_stop_vco();
+    }
+
+    clock_channel_stop(clock_ch);
+
+    clock_ch->mode = CLOCK_ASTABLE;
+    clock_ch->freq_mhz = CLOCK_DEF_FREQ_HZ * 1000ULL;
+    clock_ch->pwm_div = 0;
+    clock_ch->pwm_wrap = 0;
+    clock_ch->timer_type = CLOCK_TIMER_RPT;
+    clock_ch->track_mul = 0;
+    clock_ch->track_div = 0;
+
+    clock_pulse_start();
+}
+
+/**
+ * Clock init function
+ * 
+ * @return void
+ */
+void clock_init()
+{
+    for (u_int8_t i = 0; i < CLOCK_SLICE_COUNT; i++) {
+        clock_slice_owner[i] = CLOCK_PIN_NONE;
+    }
+
+    // plan on the stored crystal calibration from the start
+    int32_t cal_ppb;
+    if (cal_load(&cal_ppb) && cal_ppb <= CLOCK_CAL_MAX_PPB && cal_ppb >= -CLOCK_CAL_MAX_PPB) {
+        clock_cal_ppb = cal_ppb;
+    }
+
+    // channel 0 is the CPU clock with the LED pulse pin
+    u_int8_t index;
+    clock_add_channel(CLOCK_PIN, PULSE_PIN, &index);
+    clock_ch = &clock_channels[index];
+
+    // start clock pulse
+    clock_pulse_start();
+
+    // apply the boot profile, this restarts the clock pulse
+    if (CLOCK_DEF_PROFILE != CLOCK_PROFILE_STANDARD) {
+        clock_set_profile(CLOCK_DEF_PROFILE);
+    }
+}
@@ -1,15 +1,97 @@
 #ifndef CLOCK_H
 #define CLOCK_H
 
+#include "gpout.h"
+
 #ifndef CLOCK_DEF_FREQ_HZ
 #define CLOCK_DEF_FREQ_HZ 1
 #endif
 
+#ifndef CLOCK_DEF_DUTY_PPM
+#define CLOCK_DEF_DUTY_PPM 500000
+#endif
+
+#ifndef CLOCK_DEF_PROFILE
+#define CLOCK_DEF_PROFILE 0
+#endif
+
+#define CLOCK_PROFILE_STANDARD 0
+#define CLOCK_PROFILE_PERFORMANCE 1
+#define CLOCK_PROFILE_COUNT 2
+
 #define CLOCK_ASTABLE 0
 #define CLOCK_MONOSTABLE 1
 
 #define CLOCK_TIMER_RPT 0
 #define CLOCK_TIMER_PWM 1
+#define CLOCK_TIMER_GPOUT 2
+#define CLOCK_TIMER_SWEEP 3
+#define CLOCK_TIMER_PATTERN 4
+#define CLOCK_TIMER_TRIGGER 5
+
+#define CLOCK_PULSE_FOLLOW 0
+#define CLOCK_PULSE_INVERT 1
+#define CLOCK_PULSE_DUTY 2
+#define CLOCK_PULSE_BLINK 3
+#define CLOCK_PULSE_PHI1 4
+
+#ifndef CLOCK_DEF_DEAD_TICKS
+#define CLOCK_DEF_DEAD_TICKS 13
+#endif
+
+#define CLOCK_DEAD_TICKS_MAX 1000
+
+#ifndef CLOCK_PULSE_BLINK_MAX_MHZ
+#define CLOCK_PULSE_BLINK_MAX_MHZ 4000
+#endif
+
+#define CLOCK_DUTY_RATIO 0
+#define CLOCK_DUTY_HIGH_NS 1
+#define CLOCK_DUTY_LOW_NS 2
+
+#ifndef CLOCK_CHANNEL_MAX
+#define CLOCK_CHANNEL_MAX 8
+#endif
+
+#define CLOCK_SLICE_COUNT 8
+#define CLOCK_PIN_NONE 0xff
+#define CLOCK_SLICE_REF 0xfe
+#define CLOCK_PHASE_NONE 0xff
+#define CLOCK_PHASE_MDEG_MAX 360000
+
+#define CLOCK_TRACK_MS 1000
+#define CLOCK_TRACK_GAIN 4
+#define CLOCK_TRACK_RATIO_MAX 65535
+
+#define CLOCK_VCO_MS 20
+#define CLOCK_VCO_DEADBAND 4
+
+#define CLOCK_CAL_MAX_PPB 200000
+#define CLOCK_CAL_MIN_US 10000000
+
+#define CLOCK_CHANNEL_OK 0
+#define CLOCK_CHANNEL_ERR_PIN 1
+#define CLOCK_CHANNEL_ERR_RESERVED 2
+#define CLOCK_CHANNEL_ERR_SLICE 3
+#define CLOCK_CHANNEL_ERR_FULL 4
+
+/**
+ * Clock channel info type
+ * 
+ * @var clock_channel_info_t
+ */
+typedef struct {
+    u_int8_t pin;
+    u_int8_t pulse_pin;
+    u_int8_t slice;
+    bool started;
+    u_int8_t timer_type;
+    u_int64_t freq_mhz;
+    u_int8_t phase_master;
+    bool phase_ticks;
+    u_int32_t phase_value;
+    bool vco;
+} clock_channel_info_t;
 
 uint8_t clock_get_mode();
 
@@ -20,6 +102,50 @@ uint8_t clock_get_mode();
  */
 u_int32_t clock_get_sys_freq_hz();
 
+/**
+ * Clock get crystal calibration (positive when the crystal runs fast)
+ * 
+ * @return int32_t
+ */
+int32_t clock_get_cal_ppb();
+
+/**
+ * Clock set and store the crystal calibration
+ * 
+ * @param int32_t ppb
+ * @return bool
+ */
+bool clock_set_cal_ppb(int32_t ppb);
+
+/**
+ * Clock calibrate the crystal against the reference input
+ * 
+ * @return bool
+ */
+bool clock_calibrate();
+
+/**
+ * Clock get sys clock profile
+ * 
+ * @return u_int8_t
+ */
+u_int8_t clock_get_profile();
+
+/**
+ * Clock get sys clock profile name
+ * 
+ * @param u_int8_t profile
+ * @return const char *
+ */
+const char *clock_get_profile_name(u_int8_t profile);
+
+/**
+ * Clock get maximum output frequency in mHz for the live sys clock
+ * 
+ * @return u_int64_t
+ */
+u_int64_t clock_get_max_freq_mhz();
+
 /**
  * Clock get frequency
  * 
@@ -28,7 +154,14 @@ u_int32_t clock_get_sys_freq_hz();
 u_int32_t clock_get_freq_hz();
 
 /**
- * Clock get PWM div
+ * Clock get frequency in mHz
+ * 
+ * @return u_int64_t
+ */
+u_int64_t clock_get_freq_mhz();
+
+/**
+ * Clock get PWM div (8.4 fixed point)
  * 
  * @return u_int16_t
  */
@@ -41,6 +174,48 @@ u_int16_t clock_get_pwm_div();
  */
 u_int16_t clock_get_pwm_wrap();
 
+/**
+ * Clock get PWM phase-correct mode
+ * 
+ * @return bool
+ */
+bool clock_get_phase_correct();
+
+/**
+ * Clock get pulse pin mode
+ * 
+ * @return u_int8_t
+ */
+u_int8_t clock_get_pulse_mode();
+
+/**
+ * Clock get pulse pin duty cycle in ppm
+ * 
+ * @return u_int32_t
+ */
+u_int32_t clock_get_pulse_duty_ppm();
+
+/**
+ * Clock get pulse pin blink prescaler (0 when not blinking)
+ * 
+ * @return u_int32_t
+ */
+u_int32_t clock_get_pulse_prescale();
+
+/**
+ * Clock get two-phase dead time in sys clock ticks
+ * 
+ * @return u_int32_t
+ */
+u_int32_t clock_get_dead_ticks();
+
+/**
+ * Clock get programmed two-phase dead time in ps
+ * 
+ * @return u_int64_t
+ */
+u_int64_t clock_get_dead_ps();
+
 /**
  * Clock get duty cycle
  * 
@@ -48,6 +223,48 @@ u_int16_t clock_get_pwm_wrap();
  */
 u_int16_t clock_get_duty_cycle();
 
+/**
+ * Clock get duty cycle in ppm
+ * 
+ * @return u_int32_t
+ */
+u_int32_t clock_get_duty_ppm();
+
+/**
+ * Clock get duty type
+ * 
+ * @return u_int8_t
+ */
+u_int8_t clock_get_duty_type();
+
+/**
+ * Clock get duty absolute high/low time in ns
+ * 
+ * @return u_int32_t
+ */
+u_int32_t clock_get_duty_ns();
+
+/**
+ * Clock get PWM counter step in ps
+ * 
+ * @return u_int64_t
+ */
+u_int64_t clock_get_pwm_step_ps();
+
+/**
+ * Clock get PWM high time in ps
+ * 
+ * @return u_int64_t
+ */
+u_int64_t clock_get_pwm_high_ps();
+
+/**
+ * Clock get PWM low time in ps
+ * 
+ * @return u_int64_t
+ */
+u_int64_t clock_get_pwm_low_ps();
+
 /**
  * Clock get timer type
  * 
@@ -55,13 +272,186 @@ u_int16_t clock_get_duty_cycle();
  */
 u_int8_t clock_get_timer_type();
 
+/**
+ * Clock get GPOUT plan (valid while the GPOUT engine runs)
+ * 
+ * @param gpout_plan_t *plan
+ * @return void
+ */
+void clock_get_gpout_plan(gpout_plan_t *plan);
+
+/**
+ * Clock get GPOUT pin
+ * 
+ * @return u_int8_t
+ */
+u_int8_t clock_get_gpout_pin();
+
+/**
+ * Clock get actual PWM frequency in mHz
+ * 
+ * @return u_int64_t
+ */
+u_int64_t clock_get_actual_freq_mhz();
+
+/**
+ * Clock get actual PWM duty cycle in ppm
+ * 
+ * @return u_int32_t
+ */
+u_int32_t clock_get_actual_duty_ppm();
+
+/**
+ * Clock get spread spectrum depth in ppm (0 when off)
+ * 
+ * @return u_int32_t
+ */
+u_int32_t clock_get_spread_ppm();
+
+/**
+ * Clock get spread spectrum modulation rate in mHz
+ * 
+ * @return u_int64_t
+ */
+u_int64_t clock_get_spread_rate_mhz();
+
+/**
+ * Clock get spread spectrum profile
+ * 
+ * @return u_int8_t
+ */
+u_int8_t clock_get_spread_profile();
+
+/**
+ * Clock spread spectrum of the selected channel fits a frequency (true when off)
+ * 
+ * @param u_int64_t mhz
+ * @return bool
+ */
+bool clock_spread_fits_freq_mhz(u_int64_t mhz);
+
+/**
+ * Clock get spread spectrum centre and band in mHz (false when not spreading)
+ * 
+ * @param u_int64_t *centre_mhz
+ * @param u_int64_t *min_mhz
+ * @param u_int64_t *max_mhz
+ * @return bool
+ */
+bool clock_get_spread_band(u_int64_t *centre_mhz, u_int64_t *min_mhz, u_int64_t *max_mhz);
+
+/**
+ * Clock get engine preference (ENGINE_AUTO or a forced engine)
+ * 
+ * @return u_int8_t
+ */
+u_int8_t clock_get_engine();
+
+/**
+ * Clock get selected channel
+ * 
+ * @return u_int8_t
+ */
+u_int8_t clock_get_channel();
+
+/**
+ * Clock get channel info
+ * 
+ * @param u_int8_t index
+ * @param clock_channel_info_t *info
+ * @return bool
+ */
+bool clock_get_channel_info(u_int8_t index, clock_channel_info_t *info);
+
+/**
+ * Clock select the channel the console commands act on
+ * 
+ * @param u_int8_t index
+ * @return bool
+ */
+bool clock_select_channel(u_int8_t index);
+
+/**
+ * Clock add a channel on a pin (with an optional pulse pin on the same slice)
+ * 
+ * Returns CLOCK_CHANNEL_OK or the CLOCK_CHANNEL_ERR_* conflict.
+ * 
+ * @param u_int8_t pin
+ * @param u_int8_t pulse_pin
+ * @param u_int8_t *index
+ * @return u_int8_t
+ */
+u_int8_t clock_add_channel(u_int8_t pin, u_int8_t pulse_pin, u_int8_t *index);
+
+/**
+ * Clock remove a channel (channel 0 drives the CPU and stays)
+ * 
+ * @param u_int8_t index
+ * @return bool
+ */
+bool clock_remove_channel(u_int8_t index);
+
+/**
+ * Clock set sys clock profile
+ * 
+ * @param u_int8_t profile
+ * @return bool
+ */
+bool clock_set_profile(u_int8_t profile);
+
+/**
+ * Clock set PWM phase-correct mode (a phase group stays trailing-edge)
+ * 
+ * @param bool enable
+ * @return bool
+ */
+bool clock_set_phase_correct(bool enable);
+
+/**
+ * Clock set pulse pin mode (duty_ppm is used by CLOCK_PULSE_DUTY)
+ * 
+ * @param u_int8_t mode
+ * @param u_int32_t duty_ppm
+ * @return bool
+ */
+bool clock_set_pulse_mode(u_int8_t mode, u_int32_t duty_ppm);
+
+/**
+ * Clock set two-phase output (PHI1 on the pulse pin) with dead time
+ * 
+ * @param u_int32_t ticks
+ * @return bool
+ */
+bool clock_set_two_phase(u_int32_t ticks);
+
+/**
+ * Clock set spread spectrum (depth 0 turns it off)
+ * 
+ * @param u_int32_t depth_ppm
+ * @param u_int64_t rate_mhz
+ * @param u_int8_t profile
+ * @return bool
+ */
+bool clock_set_spread(u_int32_t depth_ppm, u_int64_t rate_mhz, u_int8_t profile);
+
 /**
  * Clock set frequency
  * 
  * @param u_int32_t hz
- * @return void
+ * @return bool
  */
-void clock_set_freq_hz(u_int32_t hz);
+bool clock_set_freq_hz(u_int32_t hz);
+
+/**
+ * Clock set frequency in mHz
+ * 
+ * A frequency no engine can produce is refused and the output keeps
+ * running at the old one.
+ * 
+ * @param u_int64_t mhz
+ * @return bool
+ */
+bool clock_set_freq_mhz(u_int64_t mhz);
 
 /**
  * Clock set duty cycle
@@ -72,33 +462,36 @@ void clock_set_freq_hz(u_int32_t hz);
 void clock_set_duty_cycle(u_int16_t duty_cycle);
 
 /**
- * Clock set PWM div
+ * Clock set duty cycle in ppm
  * 
- * @param u_int16_t div
+ * @param u_int32_t ppm
  * @return void
  */
-void clock_start_pwm();
+void clock_set_duty_ppm(u_int32_t ppm);
 
 /**
- * Clock stop PWM
+ * Clock set absolute high time (tPWH)
  * 
+ * @param u_int32_t ns
  * @return void
  */
-void clock_stop_pwm();
+void clock_set_high_ns(u_int32_t ns);
 
 /**
- * Clock start repeating timer
+ * Clock set absolute low time (tPWL)
  * 
+ * @param u_int32_t ns
  * @return void
  */
-void clock_start_rpt();
+void clock_set_low_ns(u_int32_t ns);
 
 /**
- * Clock stop repeating timer
+ * Clock set engine preference (ENGINE_AUTO or a forced engine)
  * 
+ * @param u_int8_t engine
  * @return void
  */
-void clock_stop_rpt();
+void clock_set_engine(u_int8_t engine);
 
 /**
  * Clock pulse start
@@ -107,6 +500,140 @@ void clock_stop_rpt();
  */
 void clock_pulse_start();
 
+/**
+ * Clock retune to the current settings
+ * 
+ * @return void
+ */
+void clock_retune();
+
+/**
+ * Clock start a DMA sweep over the programmed steps
+ * 
+ * @param u_int32_t dwell_ms
+ * @param bool loop
+ * @return bool
+ */
+bool clock_start_sweep(u_int32_t dwell_ms, bool loop);
+
+/**
+ * Clock start the PIO pattern engine on the clock pin
+ * 
+ * @return bool
+ */
+bool clock_start_pattern();
+
+/**
+ * Clock start the PIO trigger engine on the clock pin
+ * 
+ * @param u_int8_t trigger_pin
+ * @param u_int32_t count
+ * @return bool
+ */
+bool clock_start_trigger(u_int8_t trigger_pin, u_int32_t count);
+
+/**
+ * Clock make a channel follow the selected one at a phase offset
+ * 
+ * The offset is in sys clock ticks, or in millidegrees of the period.
+ * 
+ * @param u_int8_t index
+ * @param bool ticks
+ * @param u_int32_t value
+ * @return bool
+ */
+bool clock_set_phase(u_int8_t index, bool ticks, u_int32_t value);
+
+/**
+ * Clock take a channel out of its phase group (a master dissolves it)
+ * 
+ * @param u_int8_t index
+ * @return bool
+ */
+bool clock_clear_phase(u_int8_t index);
+
+/**
+ * Clock take the master of a phase group dissolved since the last call
+ * 
+ * A group is dissolved when a sys clock change, a tracked frequency or
+ * a stepped member leaves it unable to run aligned.
+ * 
+ * @return u_int8_t
+ */
+u_int8_t clock_take_phase_dissolved();
+
+/**
+ * Clock drive the selected channel's frequency from an ADC input
+ * 
+ * @param u_int8_t input
+ * @return bool
+ */
+bool clock_start_vco(u_int8_t input);
+
+/**
+ * Clock stop the VCO, the channel keeps its last frequency
+ * 
+ * @return void
+ */
+void clock_stop_vco();
+
+/**
+ * Clock selected channel is driven by the VCO
+ * 
+ * @return bool
+ */
+bool clock_get_vco();
+
+/**
+ * Clock selected channel is in a phase group (master or follower)
+ * 
+ * @return bool
+ */
+bool clock_get_phase_group();
+
+/**
+ * Clock set the reference input (a PWM B pin on a free slice)
+ * 
+ * Returns CLOCK_CHANNEL_OK or the CLOCK_CHANNEL_ERR_* conflict.
+ * 
+ * @param u_int8_t pin
+ * @param u_int32_t nominal_hz
+ * @return u_int8_t
+ */
+u_int8_t clock_set_reference(u_int8_t pin, u_int32_t nominal_hz);
+
+/**
+ * Clock clear the reference input and stop all tracking
+ * 
+ * @return void
+ */
+void clock_clear_reference();
+
+/**
+ * Clock track the reference with the selected channel (0 / 0 is off)
+ * 
+ * @param u_int32_t mul
+ * @param u_int32_t div
+ * @return bool
+ */
+bool clock_set_track(u_int32_t mul, u_int32_t div);
+
+/**
+ * Clock get tracking ratio of the selected channel
+ * 
+ * @param u_int32_t *mul
+ * @param u_int32_t *div
+ * @return bool
+ */
+bool clock_get_track(u_int32_t *mul, u_int32_t *div);
+
+/**
+ * Clock apply tracked and VCO frequencies the alarm IRQ could not (main loop)
+ * 
+ * @return void
+ */
+void clock_poll();
+
 /**
  * Clock pulse stop
  * 
@@ -115,12 +642,12 @@ void clock_pulse_start();
 void clock_pulse_stop();
 
 /**
- * Clock step mode
+ * Clock step mode (a phase group member cannot step)
  * 
  * @param bool enable
- * @return void
+ * @return bool
  */
-void clock_step(bool enable);
+bool clock_step(bool enable);
 
 /**
  * Clock step pulse
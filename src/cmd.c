@@ -3,8 +3,19 @@
 #include <stdlib.h>
 #include "pico/bootrom.h"
 #include "pico/stdlib.h"
+#include "hardware/clocks.h"
 #include "cmd.h"
 #include "clock.h"
+#include "jitter.h"
+#include "prof.h"
+#include "plan_cache.h"
+#include "engine.h"
+#include "sweep.h"
+#include "pattern.h"
+#include "trigger.h"
+#include "ref.h"
+#include "spread.h"
+#include "vco.h"
 
 /**
  * Command repeating timer
@@ -44,92 +55,1459 @@ void cmd_boot_message()
     printf("Type '?' for help\n\n");
 }
 
+/**
+ * Command format fixed point value as decimal (trailing zeros dropped)
+ * 
+ * @param char *buffer
+ * @param size_t size
+ * @param u_int64_t value
+ * @param u_int8_t decimals
+ * @return char *
+ */
+char *cmd_format_fixed(char *buffer, size_t size, u_int64_t value, u_int8_t decimals)
+{
+    u_int64_t scale = 1;
+    for (u_int8_t i = 0; i < decimals; i++) {
+        scale *= 10;
+    }
+
+    u_int64_t frac = value % scale;
+    int len = snprintf(buffer, size, "%llu", value / scale);
+
+    if (frac == 0 || len < 0 || (size_t) len >= size) {
+        return buffer;
+    }
+
+    // drop trailing zeros of the fractional part
+    while (frac % 10 == 0) {
+        frac /= 10;
+        decimals--;
+    }
+
+    snprintf(buffer + len, size - len, ".%0*llu", decimals, frac);
+
+    return buffer;
+}
+
+/**
+ * Command format signed fixed point value with an explicit sign
+ * 
+ * @param char *buffer
+ * @param size_t size
+ * @param int64_t value
+ * @param u_int8_t decimals
+ * @return char *
+ */
+char *cmd_format_signed(char *buffer, size_t size, int64_t value, u_int8_t decimals)
+{
+    if (size < 2) {
+        return buffer;
+    }
+
+    buffer[0] = value < 0 ? '-' : '+';
+    cmd_format_fixed(buffer + 1, size - 1, value < 0 ? -value : value, decimals);
+
+    return buffer;
+}
+
+/**
+ * Command get timer type name
+ * 
+ * @param u_int8_t timer_type
+ * @return const char *
+ */
+const char *cmd_get_timer_name(u_int8_t timer_type)
+{
+    switch (timer_type) {
+        case CLOCK_TIMER_PWM:
+            return "PWM";
+        case CLOCK_TIMER_GPOUT:
+            return "GPOUT";
+        case CLOCK_TIMER_SWEEP:
+            return "SWEEP";
+        case CLOCK_TIMER_PATTERN:
+            return "PATTERN";
+        case CLOCK_TIMER_TRIGGER:
+            return "TRIGGER";
+        default:
+            return "RPT";
+    }
+}
+
 /**
  * Command info
  * 
  * @return void
  */
-void cmd_info()
+void cmd_info()
+{
+    u_int32_t sys_clk = clock_get_sys_freq_hz();
+    u_int64_t out_clk = clock_get_freq_mhz();
+    u_int16_t pwm_div = clock_get_pwm_div();
+    u_int16_t pwm_wrap = clock_get_pwm_wrap();
+    u_int32_t duty_ppm = clock_get_duty_ppm();
+    u_int8_t duty_type = clock_get_duty_type();
+    u_int8_t timer_type = clock_get_timer_type();
+    u_int8_t mode = clock_get_mode();
+
+    // format output frequency
+    char out_clk_str[32];
+    cmd_format_fixed(out_clk_str, sizeof(out_clk_str), out_clk, 3);
+
+    // determine timer type
+    char timer_type_str[32];
+    strcpy(timer_type_str, cmd_get_timer_name(timer_type));
+
+    if (clock_get_engine() != ENGINE_AUTO) {
+        strcat(timer_type_str, " (forced)");
+    }
+
+    // determine mode
+    char mode_str[16];
+    if (mode == CLOCK_MONOSTABLE) {
+        strcpy(mode_str, "Monostable");
+    } else {
+        strcpy(mode_str, "Astable");
+    }
+
+    clock_channel_info_t channel;
+    clock_get_channel_info(clock_get_channel(), &channel);
+
+    printf(
+        "\n"
+        "Sys Clock:\t\t%luHz (%s)\n"
+        "Channel:\t\t%u (GPIO %u)\n"
+        "Out Clock:\t\t%sHz\n"
+        "Mode:\t\t\t%s\n"
+        "Timer:\t\t\t%s\n",
+        sys_clk,
+        clock_get_profile_name(clock_get_profile()),
+        clock_get_channel(),
+        channel.pin,
+        out_clk_str,
+        mode_str,
+        timer_type_str
+    );
+
+    // sys clock above is already corrected by it
+    if (clock_get_cal_ppb() != 0) {
+        char cal_str[24];
+        cmd_format_signed(cal_str, sizeof(cal_str), clock_get_cal_ppb(), 3);
+        printf("Calibration:\t\t%sppm crystal offset\n", cal_str);
+    }
+
+    if (timer_type == CLOCK_TIMER_GPOUT) {
+        gpout_plan_t gpout;
+        clock_get_gpout_plan(&gpout);
+
+        engine_score_t gpout_score;
+        engine_score_t pwm_score;
+        engine_get_score(ENGINE_GPOUT, &gpout_score);
+        engine_get_score(ENGINE_PWM, &pwm_score);
+
+        char actual_str[32];
+        char jitter_str[24];
+        cmd_format_fixed(actual_str, sizeof(actual_str), gpout_get_freq_mhz(&gpout), 3);
+        cmd_format_fixed(jitter_str, sizeof(jitter_str), gpout_get_jitter_ps(&gpout), 3);
+
+        printf(
+            "Pin:\t\t\tGPIO%d\n"
+            "Source:\t\t\t%s (%luHz)\n"
+            "Divider:\t\t%lu + %d/256\n"
+            "Actual:\t\t\t%sHz @ 50%%\n"
+            "Jitter:\t\t\t%sns (%luppm, PWM %luppm)\n",
+            clock_get_gpout_pin(),
+            gpout.src == CLOCKS_CLK_GPOUT0_CTRL_AUXSRC_VALUE_CLK_USB ? "clk_usb" : "clk_sys",
+            gpout.src_hz,
+            gpout.div_int,
+            gpout.div_frac,
+            actual_str,
+            jitter_str,
+            gpout_score.jitter_ppm,
+            pwm_score.jitter_ppm
+        );
+    } else if (timer_type == CLOCK_TIMER_PWM) {
+        char actual_str[32];
+        char actual_duty_str[16];
+        char high_str[24];
+        char low_str[24];
+        char step_str[24];
+        cmd_format_fixed(actual_str, sizeof(actual_str), clock_get_actual_freq_mhz(), 3);
+        cmd_format_fixed(actual_duty_str, sizeof(actual_duty_str), clock_get_actual_duty_ppm(), 4);
+        cmd_format_fixed(high_str, sizeof(high_str), clock_get_pwm_high_ps(), 3);
+        cmd_format_fixed(low_str, sizeof(low_str), clock_get_pwm_low_ps(), 3);
+        cmd_format_fixed(step_str, sizeof(step_str), clock_get_pwm_step_ps(), 3);
+
+        plan_cache_stats_t cache;
+        plan_cache_get_stats(&cache);
+
+        printf(
+            "Divider:\t\t%d.%04d\n"
+            "Wrap:\t\t\t%d (%s)\n"
+            "Actual:\t\t\t%sHz @ %s%%\n"
+            "High/Low:\t\t%sns / %sns (step %sns)\n"
+            "Plan Cache:\t\t%lu hits (%lu flash) / %lu misses\n",
+            pwm_div >> 4,
+            (pwm_div & 0xf) * 625,
+            pwm_wrap,
+            clock_get_phase_correct() ? "center" : "trailing",
+            actual_str,
+            actual_duty_str,
+            high_str,
+            low_str,
+            step_str,
+            cache.rom_hits + cache.ram_hits,
+            cache.rom_hits,
+            cache.misses
+        );
+    } else if (timer_type == CLOCK_TIMER_SWEEP) {
+        char actual_str[32];
+        char first_str[32];
+        char last_str[32];
+        u_int16_t count = sweep_get_count();
+        cmd_format_fixed(actual_str, sizeof(actual_str), clock_get_actual_freq_mhz(), 3);
+        cmd_format_fixed(first_str, sizeof(first_str), sweep_get_freq_mhz(0), 3);
+        cmd_format_fixed(last_str, sizeof(last_str), sweep_get_freq_mhz(count - 1), 3);
+
+        const char *type_str = "list";
+        if (sweep_get_type() == SWEEP_LINEAR) {
+            type_str = "linear";
+        } else if (sweep_get_type() == SWEEP_LOG) {
+            type_str = "log";
+        }
+
+        printf(
+            "Sweep:\t\t\t%s %sHz .. %sHz, %lums/step%s\n"
+            "Step:\t\t\t%u / %u%s\n"
+            "Divider:\t\t%d.%04d\n"
+            "Actual:\t\t\t%sHz\n",
+            type_str,
+            first_str,
+            last_str,
+            sweep_get_dwell_ms(),
+            sweep_get_loop() ? ", loop" : "",
+            sweep_get_step() + 1,
+            count,
+            sweep_is_running() ? "" : " (done)",
+            pwm_div >> 4,
+            (pwm_div & 0xf) * 625,
+            actual_str
+        );
+    } else if (timer_type == CLOCK_TIMER_PATTERN) {
+        u_int64_t ticks = pattern_get_ticks();
+        char average_str[32];
+        char length_str[32];
+        cmd_format_fixed(average_str, sizeof(average_str), (u_int64_t) sys_clk * 1000 * pattern_get_count() / ticks, 3);
+        cmd_format_fixed(length_str, sizeof(length_str), ticks * 1000000000ULL / sys_clk, 3);
+
+        printf(
+            "Pattern:\t\t%u cycles, %llu ticks (%sus)%s\n"
+            "Average:\t\t%sHz\n",
+            pattern_get_count(),
+            ticks,
+            length_str,
+            pattern_is_pending() ? ", update pending" : "",
+            average_str
+        );
+    } else if (timer_type == CLOCK_TIMER_TRIGGER) {
+        u_int64_t half_ticks = trigger_get_half_ticks();
+        char actual_str[32];
+        char latency_str[24];
+        cmd_format_fixed(actual_str, sizeof(actual_str), (u_int64_t) sys_clk * 1000 / (half_ticks * 2), 3);
+        cmd_format_fixed(latency_str, sizeof(latency_str), 3000000000000ULL / sys_clk, 3);
+
+        if (trigger_get_count() == TRIGGER_GATE) {
+            printf("Trigger:\t\tgated while GPIO%u is high\n", trigger_get_pin());
+        } else {
+            printf("Trigger:\t\t%lu cycles on each rising edge of GPIO%u\n", trigger_get_count(), trigger_get_pin());
+        }
+
+        printf(
+            "Actual:\t\t\t%sHz @ 50%% (%llu ticks per half)\n"
+            "Latency:\t\t%sns (3 ticks, +/-1 tick sampling)\n",
+            actual_str,
+            half_ticks,
+            latency_str
+        );
+    }
+
+    // spread spectrum centre and band
+    if (clock_get_spread_ppm() > 0) {
+        u_int64_t centre_mhz, min_mhz, max_mhz;
+        bool active = clock_get_spread_band(&centre_mhz, &min_mhz, &max_mhz);
+        const char *inactive = " (inactive)";
+        char depth_str[16];
+        char rate_str[32];
+        cmd_format_fixed(depth_str, sizeof(depth_str), clock_get_spread_ppm(), 4);
+        cmd_format_fixed(rate_str, sizeof(rate_str), clock_get_spread_rate_mhz(), 3);
+
+        if (active) {
+            inactive = "";
+        } else if (clock_get_timer_type() != CLOCK_TIMER_PWM) {
+            inactive = " (inactive, PWM only)";
+        } else if (!clock_spread_fits_freq_mhz(clock_get_freq_mhz())) {
+            inactive = " (inactive, periods per cycle out of range)";
+        }
+
+        printf(
+            "Spread:\t\t\t+/-%s%% %s @ %sHz%s\n",
+            depth_str,
+            spread_get_profile_name(clock_get_spread_profile()),
+            rate_str,
+            inactive
+        );
+
+        if (active) {
+            char centre_str[32];
+            char min_str[32];
+            char max_str[32];
+            cmd_format_fixed(centre_str, sizeof(centre_str), centre_mhz, 3);
+            cmd_format_fixed(min_str, sizeof(min_str), min_mhz, 3);
+            cmd_format_fixed(max_str, sizeof(max_str), max_mhz, 3);
+
+            printf("Centre:\t\t\t%sHz (%sHz .. %sHz)\n", centre_str, min_str, max_str);
+        }
+    }
+
+    // reference input and tracking ratio
+    if (ref_is_active()) {
+        u_int64_t ref_mhz;
+        int64_t error_ppb;
+        char nominal_str[32];
+        cmd_format_fixed(nominal_str, sizeof(nominal_str), ref_get_nominal_hz(), 0);
+
+        if (!ref_has_signal() || !ref_get_freq_mhz(&ref_mhz) || !ref_get_error_ppb(&error_ppb)) {
+            printf("Reference:\t\tGPIO%u, %sHz nominal, no signal\n", ref_get_pin(), nominal_str);
+        } else {
+            char ref_str[32];
+            char error_str[24];
+            cmd_format_fixed(ref_str, sizeof(ref_str), ref_mhz, 3);
+            cmd_format_signed(error_str, sizeof(error_str), error_ppb, 3);
+
+            printf(
+                "Reference:\t\tGPIO%u, %sHz nominal, %sHz measured (%sppm over %llus)\n",
+                ref_get_pin(),
+                nominal_str,
+                ref_str,
+                error_str,
+                ref_get_window_us() / 1000000
+            );
+        }
+
+        u_int32_t track_mul, track_div;
+        if (clock_get_track(&track_mul, &track_div)) {
+            printf("Track:\t\t\t%lu/%lu of the reference\n", track_mul, track_div);
+        }
+    }
+
+    // ADC input driving the frequency
+    if (clock_get_vco()) {
+        u_int64_t min_mhz, max_mhz;
+        char min_str[32];
+        char max_str[32];
+        char latency_str[32];
+        vco_get_span(&min_mhz, &max_mhz);
+        cmd_format_fixed(min_str, sizeof(min_str), min_mhz, 3);
+        cmd_format_fixed(max_str, sizeof(max_str), max_mhz, 3);
+
+        // timer period, ring average and the wrap the new TOP waits for
+        u_int64_t latency_us = CLOCK_VCO_MS * 1000ULL + VCO_SAMPLES * 1000000ULL / VCO_SAMPLE_HZ;
+        cmd_format_fixed(latency_str, sizeof(latency_str), latency_us, 3);
+
+        const char *type_str = "list";
+        if (vco_get_type() == SWEEP_LINEAR) {
+            type_str = "linear";
+        } else if (vco_get_type() == SWEEP_LOG) {
+            type_str = "log";
+        }
+
+        printf(
+            "VCO:\t\t\tADC%u (GPIO%u) %s %sHz .. %sHz\n"
+            "Level:\t\t\t%u / %u\n"
+            "Latency:\t\t< %sms + 1 period\n",
+            vco_get_input(),
+            VCO_GPIO_BASE + vco_get_input(),
+            type_str,
+            min_str,
+            max_str,
+            vco_get_level(),
+            VCO_LEVEL_MAX,
+            latency_str
+        );
+    }
+
+    // pulse pin behaviour
+    u_int8_t pulse_mode = clock_get_pulse_mode();
+    if (pulse_mode == CLOCK_PULSE_INVERT) {
+        printf("Pulse:\t\t\tInverted\n");
+    } else if (pulse_mode == CLOCK_PULSE_DUTY) {
+        char pulse_str[16];
+        cmd_format_fixed(pulse_str, sizeof(pulse_str), clock_get_pulse_duty_ppm(), 4);
+        printf("Pulse:\t\t\t%s%%%s\n", pulse_str, timer_type == CLOCK_TIMER_PWM ? "" : " (PWM only)");
+    } else if (pulse_mode == CLOCK_PULSE_PHI1) {
+        char dead_str[24];
+        cmd_format_fixed(dead_str, sizeof(dead_str), clock_get_dead_ps(), 3);
+        printf("Pulse:\t\t\tPHI1 (dead time %lu ticks, %sns)\n", clock_get_dead_ticks(), dead_str);
+    } else if (pulse_mode == CLOCK_PULSE_BLINK) {
+        printf("Pulse:\t\t\tBlink (clock / %lu)\n", clock_get_pulse_prescale());
+    } else {
+        printf("Pulse:\t\t\tFollow\n");
+    }
+
+    // requested duty, ratio or absolute time
+    if (duty_type == CLOCK_DUTY_HIGH_NS) {
+        printf("Duty Cycle:\t\ttPWH %luns\n", clock_get_duty_ns());
+    } else if (duty_type == CLOCK_DUTY_LOW_NS) {
+        printf("Duty Cycle:\t\ttPWL %luns\n", clock_get_duty_ns());
+    } else {
+        char duty_str[16];
+        cmd_format_fixed(duty_str, sizeof(duty_str), duty_ppm, 4);
+        printf("Duty Cycle:\t\t%s%%\n", duty_str);
+    }
+
+    printf("\n");
+}
+
+/**
+ * Command jitter
+ * 
+ * @return void
+ */
+void cmd_jitter()
+{
+    jitter_stats_t stats;
+
+    if (!jitter_get_stats(&stats)) {
+        printf("No edges captured, jitter is only measured for RPT and step pulses\n");
+        return;
+    }
+
+    printf(
+        "\n"
+        "Periods:\t\t%lu\n"
+        "Mean:\t\t\t%luus\n"
+        "Std Dev:\t\t%luus\n"
+        "Min:\t\t\t%luus\n"
+        "Max:\t\t\t%luus\n"
+        "Worst:\t\t\t%luus\n"
+        "\n",
+        stats.count,
+        stats.mean_us,
+        stats.stddev_us,
+        stats.min_us,
+        stats.max_us,
+        stats.worst_us
+    );
+
+    for (int i = 0; i < JITTER_HIST_BINS; i++) {
+        if (stats.bins[i] == 0) {
+            continue;
+        }
+
+        printf("%10luus\t%u\n", stats.min_us + i * stats.bin_us, stats.bins[i]);
+    }
+
+    printf("\n");
+}
+
+/**
+ * Command engine
+ * 
+ * @return void
+ */
+void cmd_engine()
+{
+    printf(
+        "\nPreference:\t\t%s\nSelected:\t\t%s\n\n",
+        engine_get_name(clock_get_engine()),
+        engine_get_name(engine_get_selected())
+    );
+
+    printf("%-8s%12s%12s%12s%12s%12s\n", "Engine", "Freq ppm", "Jitter ppm", "Duty ppm", "CPU ppm", "Cost");
+
+    for (u_int8_t engine = 0; engine < ENGINE_COUNT; engine++) {
+        engine_score_t score;
+        engine_get_score(engine, &score);
+
+        if (!score.feasible) {
+            printf("%-8s%12s\n", engine_get_name(engine), "infeasible");
+            continue;
+        }
+
+        printf(
+            "%-8s%12lu%12lu%12lu%12lu%12lu\n",
+            engine_get_name(engine),
+            score.freq_error_ppm,
+            score.jitter_ppm,
+            score.duty_error_ppm,
+            score.cpu_ppm,
+            score.cost
+        );
+    }
+
+    printf("\n");
+}
+
+/**
+ * Command channel list
+ * 
+ * @return void
+ */
+void cmd_channel()
+{
+    printf("\n%-4s%-8s%-8s%-8s%-8s%s\n", "Ch", "Pin", "Pulse", "Slice", "Timer", "Out Clock");
+
+    for (u_int8_t i = 0; i < CLOCK_CHANNEL_MAX; i++) {
+        clock_channel_info_t info;
+        if (!clock_get_channel_info(i, &info)) {
+            continue;
+        }
+
+        char pulse_str[8] = "-";
+        if (info.pulse_pin != CLOCK_PIN_NONE) {
+            snprintf(pulse_str, sizeof(pulse_str), "%u", info.pulse_pin);
+        }
+
+        char out_clk_str[32];
+        cmd_format_fixed(out_clk_str, sizeof(out_clk_str), info.freq_mhz, 3);
+
+        // followers lag their master by a fixed offset
+        char phase_str[40] = "";
+        if (info.phase_master != CLOCK_PHASE_NONE) {
+            char value_str[24];
+            cmd_format_fixed(value_str, sizeof(value_str), info.phase_value, info.phase_ticks ? 0 : 3);
+            snprintf(phase_str, sizeof(phase_str), " (%s%s behind %u)", value_str, info.phase_ticks ? " ticks" : "deg", info.phase_master);
+        }
+
+        printf(
+            "%c%-3u%-8u%-8s%-8u%-8s%sHz%s\n",
+            i == clock_get_channel() ? '*' : ' ',
+            i,
+            info.pin,
+            pulse_str,
+            info.slice,
+            !info.started ? "stopped" : cmd_get_timer_name(info.timer_type),
+            out_clk_str,
+            phase_str
+        );
+    }
+
+    printf("\n");
+}
+
+/**
+ * Command prof
+ * 
+ * @return void
+ */
+void cmd_prof()
+{
+    if (!PROF_ENABLED) {
+        printf("Profiler disabled, build with PROF_ENABLED=1\n");
+        return;
+    }
+
+    printf("\n%-26s%10s%10s%10s%10s\n", "Site", "Count", "Min", "Avg", "Max");
+
+    for (u_int8_t site = 0; site < PROF_SITE_COUNT; site++) {
+        prof_site_t stats;
+        prof_get_site(site, &stats);
+
+        printf(
+            "%-26s%10lu%10lu%10lu%10lu\n",
+            prof_get_site_name(site),
+            stats.count,
+            stats.min,
+            stats.count ? (u_int32_t) (stats.total / stats.count) : 0,
+            stats.max
+        );
+    }
+
+    printf("\n(cycles @ %luHz)\n\n", clock_get_sys_freq_hz());
+}
+
+/**
+ * Command help
+ * 
+ * @return void
+ */
+void cmd_help()
+{
+    printf(
+        "\n"
+        "?\t\tshows this help\n"
+        "start\t\tstarts the clock timer\n"
+        "stop\t\tstops the clock timer\n"
+        "step\t\tsteps the clock timer\n"
+        "freq <hz>[k|M]\tsets the clock frequency (e.g. 0.25, 1843.2, 1.8432M)\n"
+        "duty <percent>\tsets the clock duty cycle (e.g. 33.3333)\n"
+        "high <ns>\tsets the clock high time (tPWH)\n"
+        "low <ns>\tsets the clock low time (tPWL)\n"
+        "pulse <mode>\tsets the pulse pin to follow, invert, blink, phi1 [ticks] or a duty cycle\n"
+        "align <mode>\tsets trailing-edge or center-aligned (phase-correct) PWM\n"
+        "engine [name]\tshows engine scores or selects auto, rpt, pwm or gpout\n"
+        "channel [n]\tlists the clock channels or selects channel n\n"
+        "channel add <pin> [pulse]\n\t\tadds a clock channel (pulse pin on the same PWM slice)\n"
+        "channel remove <n>\n\t\tremoves a clock channel\n"
+        "phase <n> <deg>|<ticks>t\n\t\truns channel n at the selected channel's frequency, lagging it\n"
+        "phase <n> off\ttakes channel n out of its phase group\n"
+        "sweep lin|log <start> <stop> <steps> <ms> [loop]\n\t\tsweeps the clock frequency by DMA, <ms> per step\n"
+        "sweep list <ms> <hz> <hz> ... [loop]\n\t\tsteps the clock through a frequency list\n"
+        "sweep stop\tends the sweep and restores the clock frequency\n"
+        "pattern <high>:<low>[*n] ...\n\t\tloops cycles given in sys clock ticks (e.g. 8:8*100 40:8)\n"
+        "pattern stop\tends the pattern and restores the clock frequency\n"
+        "trigger gate <pin>\n\t\truns the clock while the input pin is high\n"
+        "trigger burst <pin> <n>\n\t\tfires n clock cycles on each rising edge of the input pin\n"
+        "trigger stop\tends triggering and restores the free-running clock\n"
+        "spread <percent> <rate>[k] [triangle|kiss]\n\t\tspreads the PWM clock by +/-percent (up to 2) at the modulation rate\n"
+        "spread off\tturns spread spectrum off\n"
+        "ref <pin> <hz>[k|M]\n\t\tmeasures a reference clock on an odd GPIO (e.g. ref 9 10M)\n"
+        "ref off\t\tstops measuring the reference\n"
+        "track <mul>[/<div>]\n\t\tlocks the clock to mul/div times the reference\n"
+        "track off\tkeeps the current frequency and stops tracking\n"
+        "calibrate [ppm]\tstores the crystal offset measured on the reference, or a given one\n"
+        "calibrate clear\tforgets the crystal offset\n"
+        "vco lin|log <input> <min> <max>\n\t\tsets the clock frequency from ADC input 0-2 (GPIO26-28)\n"
+        "vco list <input> <hz> <hz> ...\n\t\tmaps the ADC range through evenly spaced frequencies\n"
+        "vco stop\tkeeps the current frequency and stops following the ADC\n"
+        "jitter\t\tshows the edge period histogram\n"
+        "prof [reset]\tshows or resets the cycle profiler\n"
+        "profile [name]\tshows or selects the standard or performance sys clock\n"
+        "reset\t\tresets the clock timer\n"
+        "reboot\t\treboots the pico to BOOTSEL mode\n"
+        "clear\t\tclears the screen\n"
+        "\n"
+    );
+}
+
+/**
+ * Command flush
+ * 
+ * @return void
+ */
+void cmd_flush() {
+    int ch;
+    while ((ch = getchar_timeout_us(0)) != PICO_ERROR_TIMEOUT && ch != '\n' && ch != EOF) {}
+}
+
+/**
+ * Command match name (exact or followed by arguments)
+ * 
+ * @param char *cmd
+ * @param const char *name
+ * @return bool
+ */
+bool cmd_match(char *cmd, const char *name)
+{
+    size_t len = strlen(name);
+
+    return strncmp(cmd, name, len) == 0 && (cmd[len] == ' ' || cmd[len] == '\0');
+}
+
+/**
+ * Command get argument
+ * 
+ * @param char *cmd
+ * @return char *
+ */
+char *cmd_get_arg(char *cmd)
+{
+    char *arg = strchr(cmd, ' ');
+
+    // no argument, point at the terminator
+    if (arg == NULL) {
+        return cmd + strlen(cmd);
+    }
+
+    while (*arg == ' ') {
+        arg++;
+    }
+
+    return arg;
+}
+
+/**
+ * Command parse decimal number
+ * 
+ * @param const char *arg
+ * @param u_int64_t *whole
+ * @param u_int64_t *frac
+ * @param u_int64_t *frac_scale
+ * @return const char * end of the number or NULL
+ */
+const char *cmd_parse_number(const char *arg, u_int64_t *whole, u_int64_t *frac, u_int64_t *frac_scale)
+{
+    bool digits = false;
+
+    *whole = 0;
+    *frac = 0;
+    *frac_scale = 1;
+
+    while (*arg >= '0' && *arg <= '9') {
+        // anything this large is out of range anyway
+        if (*whole > 1000000000000ULL) {
+            return NULL;
+        }
+
+        *whole = *whole * 10 + (*arg++ - '0');
+        digits = true;
+    }
+
+    if (*arg == '.') {
+        arg++;
+
+        while (*arg >= '0' && *arg <= '9') {
+            // digits beyond 1e-12 cannot affect any unit we scale to
+            if (*frac_scale < 1000000000000ULL) {
+                *frac = *frac * 10 + (*arg - '0');
+                *frac_scale *= 10;
+            }
+
+            arg++;
+            digits = true;
+        }
+    }
+
+    return digits ? arg : NULL;
+}
+
+/**
+ * Command scale decimal number to fixed point (rounded)
+ * 
+ * The unit and frac_scale are powers of ten, so the fraction is scaled
+ * by their ratio rather than multiplied out. A result that does not fit
+ * saturates at UINT64_MAX, which every caller's range check rejects.
+ * 
+ * @param u_int64_t whole
+ * @param u_int64_t frac
+ * @param u_int64_t frac_scale
+ * @param u_int64_t unit
+ * @return u_int64_t
+ */
+u_int64_t cmd_scale_number(u_int64_t whole, u_int64_t frac, u_int64_t frac_scale, u_int64_t unit)
+{
+    u_int64_t frac_part;
+
+    if (frac_scale >= unit) {
+        u_int64_t step = frac_scale / unit;
+        frac_part = (frac + step / 2) / step;
+    } else {
+        frac_part = frac * (unit / frac_scale);
+    }
+
+    if (whole > (UINT64_MAX - frac_part) / unit) {
+        return UINT64_MAX;
+    }
+
+    return whole * unit + frac_part;
+}
+
+/**
+ * Command check argument end (optional suffix then terminator)
+ * 
+ * @param const char *arg
+ * @param const char *suffix
+ * @return bool
+ */
+bool cmd_parse_end(const char *arg, const char *suffix)
+{
+    size_t len = strlen(suffix);
+
+    if (strncmp(arg, suffix, len) == 0) {
+        arg += len;
+    }
+
+    while (*arg == ' ') {
+        arg++;
+    }
+
+    return *arg == '\0';
+}
+
+/**
+ * Command parse frequency argument into mHz
+ * 
+ * Accepts decimals and an optional k/M unit suffix followed by an
+ * optional "Hz", e.g. "0.25", "1843.2", "3579545.45Hz", "1.8432M".
+ * Digits below 1mHz are rounded.
+ * 
+ * @param const char *arg
+ * @param u_int64_t *mhz
+ * @return bool
+ */
+bool cmd_parse_freq(const char *arg, u_int64_t *mhz)
+{
+    u_int64_t whole, frac, frac_scale;
+    u_int64_t unit = 1000;
+
+    arg = cmd_parse_number(arg, &whole, &frac, &frac_scale);
+    if (arg == NULL) {
+        return false;
+    }
+
+    if (*arg == 'k') {
+        unit = 1000000;
+        arg++;
+    } else if (*arg == 'M') {
+        unit = 1000000000;
+        arg++;
+    }
+
+    if (!cmd_parse_end(arg, "Hz")) {
+        return false;
+    }
+
+    *mhz = cmd_scale_number(whole, frac, frac_scale, unit);
+    return true;
+}
+
+/**
+ * Command parse percent argument into ppm
+ * 
+ * @param const char *arg
+ * @param u_int32_t *ppm
+ * @return bool
+ */
+bool cmd_parse_percent(const char *arg, u_int32_t *ppm)
+{
+    u_int64_t whole, frac, frac_scale;
+
+    arg = cmd_parse_number(arg, &whole, &frac, &frac_scale);
+    if (arg == NULL || !cmd_parse_end(arg, "%") || whole > 100) {
+        return false;
+    }
+
+    *ppm = cmd_scale_number(whole, frac, frac_scale, 10000);
+    return true;
+}
+
+/**
+ * Command parse phase argument (degrees, or sys clock ticks with a t)
+ * 
+ * @param const char *arg
+ * @param bool *ticks
+ * @param u_int32_t *value
+ * @return bool
+ */
+bool cmd_parse_phase(const char *arg, bool *ticks, u_int32_t *value)
+{
+    u_int64_t whole, frac, frac_scale;
+
+    arg = cmd_parse_number(arg, &whole, &frac, &frac_scale);
+    if (arg == NULL) {
+        return false;
+    }
+
+    *ticks = *arg == 't';
+    if (*ticks) {
+        *value = whole;
+        return frac_scale == 1 && cmd_parse_end(arg + 1, "") && whole <= UINT32_MAX;
+    }
+
+    *value = cmd_scale_number(whole, frac, frac_scale, 1000);
+    return cmd_parse_end(arg, "deg") && whole < 360;
+}
+
+/**
+ * Command parse signed ppm argument into ppb
+ * 
+ * @param const char *arg
+ * @param int32_t *ppb
+ * @return bool
+ */
+bool cmd_parse_ppm(const char *arg, int32_t *ppb)
+{
+    u_int64_t whole, frac, frac_scale;
+    bool negative = *arg == '-';
+
+    if (*arg == '-' || *arg == '+') {
+        arg++;
+    }
+
+    arg = cmd_parse_number(arg, &whole, &frac, &frac_scale);
+    if (arg == NULL || !cmd_parse_end(arg, "ppm") || whole > 1000) {
+        return false;
+    }
+
+    *ppb = cmd_scale_number(whole, frac, frac_scale, 1000);
+    *ppb = negative ? -*ppb : *ppb;
+    return true;
+}
+
+/**
+ * Command parse time argument into ns
+ * 
+ * @param const char *arg
+ * @param u_int32_t *ns
+ * @return bool
+ */
+bool cmd_parse_ns(const char *arg, u_int32_t *ns)
+{
+    u_int64_t whole, frac, frac_scale;
+
+    arg = cmd_parse_number(arg, &whole, &frac, &frac_scale);
+    if (arg == NULL || !cmd_parse_end(arg, "ns")) {
+        return false;
+    }
+
+    u_int64_t value = cmd_scale_number(whole, frac, frac_scale, 1);
+    if (value > UINT32_MAX) {
+        return false;
+    }
+
+    *ns = value;
+    return true;
+}
+
+/**
+ * Command parse whole sys clock tick count
+ * 
+ * @param const char *arg
+ * @param u_int32_t *ticks
+ * @return bool
+ */
+bool cmd_parse_ticks(const char *arg, u_int32_t *ticks)
+{
+    u_int64_t whole, frac, frac_scale;
+
+    arg = cmd_parse_number(arg, &whole, &frac, &frac_scale);
+    if (arg == NULL || frac_scale != 1 || !cmd_parse_end(arg, "") || whole > UINT32_MAX) {
+        return false;
+    }
+
+    *ticks = whole;
+    return true;
+}
+
+/**
+ * Command parse small whole number followed by a space or the end
+ * 
+ * @param const char *arg
+ * @param u_int8_t *value
+ * @param const char **next
+ * @return bool
+ */
+bool cmd_parse_index(const char *arg, u_int8_t *value, const char **next)
+{
+    u_int64_t whole, frac, frac_scale;
+
+    arg = cmd_parse_number(arg, &whole, &frac, &frac_scale);
+    if (arg == NULL || frac_scale != 1 || (*arg != ' ' && *arg != '\0') || whole > UINT8_MAX) {
+        return false;
+    }
+
+    while (*arg == ' ') {
+        arg++;
+    }
+
+    *value = whole;
+    *next = arg;
+    return true;
+}
+
+/**
+ * Command split arguments in place on spaces
+ * 
+ * @param char *arg
+ * @param char **argv
+ * @param u_int8_t max
+ * @return u_int8_t
+ */
+u_int8_t cmd_split(char *arg, char **argv, u_int8_t max)
+{
+    u_int8_t argc = 0;
+
+    while (*arg != '\0' && argc < max) {
+        argv[argc++] = arg;
+
+        while (*arg != ' ' && *arg != '\0') {
+            arg++;
+        }
+
+        while (*arg == ' ') {
+            *arg++ = '\0';
+        }
+    }
+
+    return argc;
+}
+
+/**
+ * Command sweep
+ * 
+ * @param char *arg
+ * @return void
+ */
+void cmd_sweep(char *arg)
+{
+    char *argv[CMD_ARGS_MAX];
+    u_int8_t argc = cmd_split(arg, argv, CMD_ARGS_MAX);
+    u_int64_t mhz[CMD_ARGS_MAX];
+    u_int32_t dwell_ms;
+    u_int32_t steps;
+
+    if (argc == 1 && strcmp(argv[0], "stop") == 0) {
+        if (clock_get_timer_type() != CLOCK_TIMER_SWEEP) {
+            printf("No sweep on this channel\n");
+            return;
+        }
+
+        clock_retune();
+        printf("* Sweep stopped\n");
+        cmd_info();
+        return;
+    }
+
+    bool loop = argc > 0 && strcmp(argv[argc - 1], "loop") == 0;
+    if (loop) {
+        argc--;
+    }
+
+    bool range = argc == 5 && (strcmp(argv[0], "lin") == 0 || strcmp(argv[0], "log") == 0);
+    bool list = argc >= 3 && strcmp(argv[0], "list") == 0;
+
+    if (range && (
+        !cmd_parse_freq(argv[1], &mhz[0]) ||
+        !cmd_parse_freq(argv[2], &mhz[1]) ||
+        !cmd_parse_ticks(argv[3], &steps) ||
+        !cmd_parse_ticks(argv[4], &dwell_ms)
+    )) {
+        range = false;
+    }
+
+    if (list && cmd_parse_ticks(argv[1], &dwell_ms)) {
+        for (u_int8_t i = 2; i < argc; i++) {
+            list = list && cmd_parse_freq(argv[i], &mhz[i - 2]);
+        }
+    } else {
+        list = false;
+    }
+
+    if (!range && !list) {
+        printf("Usage: sweep lin|log <start> <stop> <steps> <ms> [loop] | list <ms> <hz> ... [loop] | stop\n");
+        return;
+    }
+
+    // release this channel's sweep before its steps are rewritten
+    if (clock_get_timer_type() == CLOCK_TIMER_SWEEP) {
+        clock_retune();
+    }
+
+    u_int64_t max_mhz = clock_get_max_freq_mhz();
+    u_int8_t count = range ? 2 : argc - 2;
+    bool ok = true;
+
+    for (u_int8_t i = 0; i < count; i++) {
+        ok = ok && mhz[i] <= max_mhz;
+    }
+
+    if (ok && range) {
+        ok = steps <= SWEEP_STEPS_MAX && sweep_set_range(strcmp(argv[0], "log") == 0 ? SWEEP_LOG : SWEEP_LINEAR, mhz[0], mhz[1], steps);
+    } else if (ok) {
+        ok = sweep_set_list(mhz, count);
+    }
+
+    if (!ok) {
+        printf("Sweep needs up to %d steps between 0.001Hz and %lluHz, one channel at a time\n", SWEEP_STEPS_MAX, max_mhz / 1000);
+    } else if (dwell_ms == 0 || !clock_start_sweep(dwell_ms, loop)) {
+        printf("Sweep cannot run: the range must fit one PWM divider and the pulse pin must follow or invert\n");
+    } else {
+        cmd_info();
+    }
+}
+
+/**
+ * Command pattern
+ * 
+ * Cycles are written to the back buffer; a running pattern picks them
+ * up at the end of its current loop.
+ * 
+ * @param char *arg
+ * @return void
+ */
+void cmd_pattern(char *arg)
 {
-    u_int32_t sys_clk = clock_get_sys_freq_hz();
-    u_int32_t out_clk = clock_get_freq_hz();
-    u_int16_t pwm_div = clock_get_pwm_div();
-    u_int16_t pwm_wrap = clock_get_pwm_wrap();
-    u_int16_t duty_cycle = clock_get_duty_cycle();
-    u_int8_t timer_type = clock_get_timer_type();
-    u_int8_t mode = clock_get_mode();
+    char *argv[CMD_ARGS_MAX];
+    u_int8_t argc = cmd_split(arg, argv, CMD_ARGS_MAX);
 
-    // determine timer type
-    char timer_type_str[4];
-    if (timer_type == CLOCK_TIMER_PWM) {
-        strcpy(timer_type_str, "PWM");
+    if (argc == 1 && strcmp(argv[0], "stop") == 0) {
+        if (clock_get_timer_type() != CLOCK_TIMER_PATTERN) {
+            printf("No pattern on this channel\n");
+            return;
+        }
+
+        clock_retune();
+        printf("* Pattern stopped\n");
+        cmd_info();
+        return;
+    }
+
+    if (argc == 0) {
+        printf("Usage: pattern <high>:<low>[*n] ... | stop\n");
+        return;
+    }
+
+    if (pattern_is_active() && clock_get_timer_type() != CLOCK_TIMER_PATTERN) {
+        printf("Pattern engine is in use by another channel\n");
+        return;
+    }
+
+    if (!pattern_clear()) {
+        printf("Previous pattern update is still pending\n");
+        return;
+    }
+
+    for (u_int8_t i = 0; i < argc; i++) {
+        char *low = strchr(argv[i], ':');
+        char *repeat = strchr(argv[i], '*');
+        u_int32_t high_ticks, low_ticks, count = 1;
+
+        if (low != NULL) {
+            *low++ = '\0';
+        }
+
+        if (repeat != NULL) {
+            *repeat++ = '\0';
+        }
+
+        if (
+            low == NULL ||
+            !cmd_parse_ticks(argv[i], &high_ticks) ||
+            !cmd_parse_ticks(low, &low_ticks) ||
+            (repeat != NULL && !cmd_parse_ticks(repeat, &count)) ||
+            !pattern_add(high_ticks, low_ticks, count)
+        ) {
+            printf(
+                "Cycle %u: high/low must be %d to %d ticks, up to %d cycles in total\n",
+                i + 1,
+                PATTERN_TICKS_MIN,
+                PATTERN_TICKS_MAX,
+                PATTERN_LEN_MAX
+            );
+            return;
+        }
+    }
+
+    pattern_commit();
+
+    if (clock_get_timer_type() != CLOCK_TIMER_PATTERN && !clock_start_pattern()) {
+        printf("Pattern engine cannot start, no free PIO state machine or program space\n");
+        return;
+    }
+
+    cmd_info();
+}
+
+/**
+ * Command trigger
+ * 
+ * @param char *arg
+ * @return void
+ */
+void cmd_trigger(char *arg)
+{
+    char *argv[3];
+    u_int8_t argc = cmd_split(arg, argv, 3);
+    u_int32_t pin, count = TRIGGER_GATE;
+
+    if (argc == 1 && strcmp(argv[0], "stop") == 0) {
+        if (clock_get_timer_type() != CLOCK_TIMER_TRIGGER) {
+            printf("No trigger on this channel\n");
+            return;
+        }
+
+        clock_retune();
+        printf("* Trigger stopped\n");
+        cmd_info();
+        return;
+    }
+
+    if (
+        !(argc == 2 && strcmp(argv[0], "gate") == 0) &&
+        !(argc == 3 && strcmp(argv[0], "burst") == 0 && cmd_parse_ticks(argv[2], &count) && count > 0)
+    ) {
+        printf("Usage: trigger gate <pin> | burst <pin> <n> | stop\n");
+        return;
+    }
+
+    if (!cmd_parse_ticks(argv[1], &pin) || pin > UINT8_MAX) {
+        printf("Usage: trigger gate <pin> | burst <pin> <n> | stop\n");
+        return;
+    }
+
+    if (clock_get_freq_mhz() * 2 * TRIGGER_HALF_TICKS_MIN > (u_int64_t) clock_get_sys_freq_hz() * 1000) {
+        printf("Trigger output is limited to %luHz\n", clock_get_sys_freq_hz() / (2 * TRIGGER_HALF_TICKS_MIN));
+        return;
+    }
+
+    if (!clock_start_trigger(pin, count)) {
+        printf("Trigger needs a free, unreserved input pin and a free PIO state machine, one channel at a time\n");
+        return;
+    }
+
+    cmd_info();
+}
+
+/**
+ * Command phase
+ * 
+ * @param char *arg
+ * @return void
+ */
+void cmd_phase(char *arg)
+{
+    char *argv[2];
+    u_int8_t argc = cmd_split(arg, argv, 2);
+    const char *next;
+    u_int8_t index;
+    bool ticks;
+    u_int32_t value;
+    clock_channel_info_t info;
+
+    if (argc != 2 || !cmd_parse_index(argv[0], &index, &next) || *next != '\0') {
+        printf("Usage: phase <n> <deg>|<ticks>t | off\n");
+    } else if (strcmp(argv[1], "off") == 0) {
+        if (!clock_clear_phase(index)) {
+            printf("Channel %u is not in a phase group\n", index);
+        } else {
+            cmd_channel();
+        }
+    } else if (!cmd_parse_phase(argv[1], &ticks, &value)) {
+        printf("Usage: phase <n> <deg>|<ticks>t | off (0 to 359.999 degrees)\n");
+    } else if (clock_get_vco() || (clock_get_channel_info(index, &info) && info.vco)) {
+        printf("Phase is not available on the VCO channel\n");
+    } else if (!clock_set_phase(index, ticks, value)) {
+        printf("Phase needs another channel, a selected channel that is not a follower and trailing-edge PWM on both\n");
     } else {
-        strcpy(timer_type_str, "RPT");
-    }   
+        cmd_channel();
+    }
+}
 
-    // determine mode
-    char mode_str[16];
-    if (mode == CLOCK_MONOSTABLE) {
-        strcpy(mode_str, "Monostable");
+/**
+ * Command ref
+ * 
+ * @param char *arg
+ * @return void
+ */
+void cmd_ref(char *arg)
+{
+    char *argv[2];
+    u_int8_t argc = cmd_split(arg, argv, 2);
+    u_int32_t pin;
+    u_int64_t mhz;
+
+    if (argc == 1 && strcmp(argv[0], "off") == 0) {
+        clock_clear_reference();
+        printf("* Reference off\n");
+        return;
+    }
+
+    if (argc == 0) {
+        cmd_info();
+        return;
+    }
+
+    if (
+        argc != 2 || !cmd_parse_ticks(argv[0], &pin) || pin > UINT8_MAX ||
+        !cmd_parse_freq(argv[1], &mhz) || mhz % 1000 != 0 || mhz == 0
+    ) {
+        printf("Usage: ref <pin> <hz>[k|M] | off\n");
+        return;
+    }
+
+    if (mhz > REF_HZ_MAX * 1000ULL) {
+        printf("Reference is limited to %dHz\n", REF_HZ_MAX);
+        return;
+    }
+
+    switch (clock_set_reference(pin, mhz / 1000)) {
+        case CLOCK_CHANNEL_OK:
+            printf("* Reference on GPIO%lu\n", pin);
+            break;
+        case CLOCK_CHANNEL_ERR_RESERVED:
+            printf("GPIO%lu is reserved\n", pin);
+            break;
+        case CLOCK_CHANNEL_ERR_SLICE:
+            printf("The PWM slice of GPIO%lu is used by a channel\n", pin);
+            break;
+        default:
+            printf("Reference needs the B pin (odd GPIO) of a PWM slice\n");
+            break;
+    }
+}
+
+/**
+ * Command track
+ * 
+ * @param char *arg
+ * @return void
+ */
+void cmd_track(char *arg)
+{
+    u_int32_t mul, div = 1;
+    char *slash = strchr(arg, '/');
+
+    if (strcmp(arg, "off") == 0) {
+        clock_set_track(0, 0);
+        cmd_info();
+        return;
+    }
+
+    if (slash != NULL) {
+        *slash++ = '\0';
+    }
+
+    if (!cmd_parse_ticks(arg, &mul) || (slash != NULL && !cmd_parse_ticks(slash, &div))) {
+        printf("Usage: track <mul>[/<div>] | off\n");
+    } else if (!ref_is_active()) {
+        printf("No reference, set one with `ref <pin> <hz>` first\n");
+    } else if (!clock_set_track(mul, div)) {
+        printf("Track needs a ratio of 1 to %d over 1 to %d within the clock range\n", CLOCK_TRACK_RATIO_MAX, CLOCK_TRACK_RATIO_MAX);
     } else {
-        strcpy(mode_str, "Astable");
+        cmd_info();
     }
+}
 
-    printf(
-        "\n"
-        "Sys Clock:\t\t%luHz\n"
-        "Out Clock:\t\t%luHz\n"
-        "Mode:\t\t\t%s\n"
-        "Timer:\t\t\t%s\n",
-        sys_clk,
-        out_clk,
-        mode_str,
-        timer_type_str
-    );
+/**
+ * Command calibrate
+ * 
+ * @param char *arg
+ * @return void
+ */
+void cmd_calibrate(char *arg)
+{
+    int32_t ppb;
 
-    if (timer_type) {
+    if (strcmp(arg, "clear") == 0) {
+        clock_set_cal_ppb(0);
+    } else if (*arg != '\0') {
+        if (!cmd_parse_ppm(arg, &ppb) || !clock_set_cal_ppb(ppb)) {
+            printf("Usage: calibrate [ppm] | clear (up to +/-%dppm)\n", CLOCK_CAL_MAX_PPB / 1000);
+            return;
+        }
+    } else if (!clock_calibrate()) {
         printf(
-            "Divider:\t\t%d\n"
-            "Wrap:\t\t\t%d\n",
-            pwm_div,
-            pwm_wrap
+            "Calibrate needs %us of a reference signal, set one with `ref <pin> <hz>` and wait\n",
+            CLOCK_CAL_MIN_US / 1000000
         );
+        return;
     }
 
-    printf("Duty Cycle:\t\t%d%%\n", duty_cycle);
-    printf("\n");
+    cmd_info();
 }
 
 /**
- * Command help
+ * Command vco
+ * 
+ * The curve is shared, so it is only rewritten on the channel that
+ * already runs the VCO or when it is idle.
  * 
+ * @param char *arg
  * @return void
  */
-void cmd_help()
+void cmd_vco(char *arg)
 {
-    printf(
-        "\n"
-        "?\t\tshows this help\n"
-        "start\t\tstarts the clock timer\n"
-        "stop\t\tstops the clock timer\n"
-        "step\t\tsteps the clock timer\n"
-        "freq <hz>\tsets the clock frequency\n"
-        "duty <percent>\tsets the clock duty cycle\n"
-        "reset\t\tresets the clock timer\n"
-        "reboot\t\treboots the pico to BOOTSEL mode\n"
-        "clear\t\tclears the screen\n"
-        "\n"
-    );
+    char *argv[CMD_ARGS_MAX];
+    u_int8_t argc = cmd_split(arg, argv, CMD_ARGS_MAX);
+    u_int64_t mhz[CMD_ARGS_MAX];
+    u_int32_t input;
+
+    if (argc == 1 && strcmp(argv[0], "stop") == 0) {
+        if (!clock_get_vco()) {
+            printf("No VCO on this channel\n");
+            return;
+        }
+
+        clock_stop_vco();
+        printf("* VCO stopped\n");
+        cmd_info();
+        return;
+    }
+
+    bool range = argc == 4 && (strcmp(argv[0], "lin") == 0 || strcmp(argv[0], "log") == 0);
+    bool list = argc >= 2 + VCO_POINTS_MIN && argc <= 2 + VCO_POINTS_MAX && strcmp(argv[0], "list") == 0;
+    bool ok = (range || list) && cmd_parse_ticks(argv[1], &input) && input <= VCO_INPUT_MAX;
+
+    for (u_int8_t i = 2; ok && i < argc; i++) {
+        ok = cmd_parse_freq(argv[i], &mhz[i - 2]) && mhz[i - 2] > 0;
+    }
+
+    if (!ok) {
+        printf("Usage: vco lin|log <input> <min> <max> | list <input> <hz> ... (up to %d) | stop\n", VCO_POINTS_MAX);
+        return;
+    }
+
+    if (vco_is_active() && !clock_get_vco()) {
+        printf("The VCO runs on another channel, stop it there first\n");
+        return;
+    }
+
+    // a group retunes by restarting every member together
+    if (clock_get_phase_group()) {
+        printf("VCO is not available in a phase group\n");
+        return;
+    }
+
+    clock_stop_vco();
+
+    if (range) {
+        ok = vco_set_range(strcmp(argv[0], "log") == 0 ? SWEEP_LOG : SWEEP_LINEAR, mhz[0], mhz[1]);
+    } else {
+        ok = vco_set_curve(mhz, argc - 2);
+    }
+
+    if (!ok || !clock_start_vco(input)) {
+        printf(
+            "VCO needs frequencies up to %lluHz that one PWM divider can span and an input pin nothing else uses\n",
+            clock_get_max_freq_mhz() / 1000
+        );
+    } else {
+        cmd_info();
+    }
 }
 
 /**
- * Command flush
+ * Command spread
  * 
+ * @param char *arg
  * @return void
  */
-void cmd_flush() {
-    int ch;
-    while ((ch = getchar_timeout_us(0)) != PICO_ERROR_TIMEOUT && ch != '\n' && ch != EOF) {}
+void cmd_spread(char *arg)
+{
+    char *argv[3];
+    u_int8_t argc = cmd_split(arg, argv, 3);
+    u_int32_t depth_ppm;
+    u_int64_t rate_mhz;
+    u_int8_t profile = SPREAD_TRIANGLE;
+
+    if (argc == 1 && strcmp(argv[0], "off") == 0) {
+        clock_set_spread(0, 0, SPREAD_TRIANGLE);
+        cmd_info();
+        return;
+    }
+
+    if (argc == 3 && strcmp(argv[2], "kiss") == 0) {
+        profile = SPREAD_KISS;
+    } else if (argc == 3 && strcmp(argv[2], "triangle") != 0) {
+        argc = 0;
+    }
+
+    if (argc < 2 || !cmd_parse_percent(argv[0], &depth_ppm) || depth_ppm == 0 || !cmd_parse_freq(argv[1], &rate_mhz)) {
+        printf("Usage: spread <percent> <rate>[k] [triangle|kiss] | off\n");
+
+    // the table is replayed by PWM wraps
+    } else if (clock_get_timer_type() != CLOCK_TIMER_PWM) {
+        printf("Spread spectrum can only be set in PWM mode\n");
+    } else if (!clock_set_spread(depth_ppm, rate_mhz, profile)) {
+        printf(
+            "Spread needs up to %d%% and %d to %d clock periods per modulation cycle, on one channel at a time\n",
+            SPREAD_DEPTH_MAX_PPM / 10000,
+            SPREAD_TABLE_MIN,
+            SPREAD_TABLE_MAX
+        );
+    } else {
+        cmd_info();
+    }
 }
 
 /**
@@ -140,6 +1518,8 @@ void cmd_flush() {
  */
 void cmd_execute(char *cmd)
 {
+    PROF_BEGIN(PROF_SITE_CMD_EXECUTE);
+
     // stop command timer
     cmd_stop();
 
@@ -151,8 +1531,13 @@ void cmd_execute(char *cmd)
 
     // start command
     } else if (strcmp(cmd, "start") == 0) {
-        printf("* Clock started\n");
-        clock_pulse_start();
+        // step mode pulses only come from enter
+        if (clock_get_mode() == CLOCK_MONOSTABLE) {
+            printf("Start is not available in step mode, type `exit` first\n");
+        } else {
+            printf("* Clock started\n");
+            clock_pulse_start();
+        }
 
     // stop command
     } else if (strcmp(cmd, "stop") == 0) {
@@ -161,40 +1546,288 @@ void cmd_execute(char *cmd)
 
     // step command
     } else if (strcmp(cmd, "step") == 0) {
-        clock_step(true);
-        printf(step_message);
-        cmd_info();
+        if (!clock_step(true)) {
+            printf("Step mode is not available in a phase group\n");
+        } else {
+            printf(step_message);
+            cmd_info();
+        }
 
     // freq command
-    } else if (strncmp(cmd, "freq", 4) == 0) {
-        char *freq = cmd + 5;
-        u_int32_t hz = atoi(freq);
+    } else if (cmd_match(cmd, "freq")) {
+        char *freq = cmd_get_arg(cmd);
+        u_int64_t mhz;
+
+        // frequency must be positive, down to 1mHz
+        if (!cmd_parse_freq(freq, &mhz) || mhz == 0) {
+            printf("Usage: freq <hz>[k|M]\n");
 
-        // limit frequency to 125MHz
-        if (hz > 125000000) {
-            printf("Frequency cannot be greater than 125000000\n");
+        // limit frequency to the live sys clock
+        } else if (mhz > clock_get_max_freq_mhz()) {
+            printf("Frequency cannot be greater than %llu\n", clock_get_max_freq_mhz() / 1000);
+        // spread spectrum replays one table entry per output period
+        } else if (!clock_spread_fits_freq_mhz(mhz)) {
+            printf("Spread needs %d to %d clock periods per modulation cycle, change its rate or turn it off first\n", SPREAD_TABLE_MIN, SPREAD_TABLE_MAX);
+        } else if (!clock_set_freq_mhz(mhz)) {
+            printf("Frequency cannot be produced by any engine, or by PWM in a phase group\n");
         } else {
-            clock_set_freq_hz(hz);
             cmd_info();
         }
 
     // duty command
-    } else if (strncmp(cmd, "duty", 4) == 0) {
-        char *duty = cmd + 5;
-        u_int16_t duty_cycle = atoi(duty);
-        
+    } else if (cmd_match(cmd, "duty")) {
+        char *duty = cmd_get_arg(cmd);
+        u_int32_t duty_ppm;
+
+        // duty cycle must be a decimal percent
+        if (!cmd_parse_percent(duty, &duty_ppm)) {
+            printf("Usage: duty <percent>\n");
+
         // duty cycle can only be set in PWM mode
-        if (clock_get_timer_type() == CLOCK_TIMER_RPT) {
+        } else if (clock_get_timer_type() != CLOCK_TIMER_PWM) {
             printf("Duty cycle can only be set in PWM mode\n");
 
         // duty cycle cannot be greater than 100
-        } else if (duty_cycle > 100) {
+        } else if (duty_ppm > 1000000) {
             printf("Duty cycle cannot be greater than 100\n");
         } else {
-            clock_set_duty_cycle(duty_cycle);
+            clock_set_duty_ppm(duty_ppm);
+            cmd_info();
+        }
+
+    // high/low time command
+    } else if (cmd_match(cmd, "high") || cmd_match(cmd, "low")) {
+        bool high = cmd[0] == 'h';
+        char *time = cmd_get_arg(cmd);
+        u_int32_t ns;
+
+        u_int64_t step_ps = clock_get_pwm_step_ps();
+        u_int64_t period_ps = clock_get_pwm_high_ps() + clock_get_pwm_low_ps();
+
+        // time must be a positive ns value
+        if (!cmd_parse_ns(time, &ns) || ns == 0) {
+            printf("Usage: %s <ns>\n", high ? "high" : "low");
+
+        // high/low time can only be set in PWM mode
+        } else if (clock_get_timer_type() != CLOCK_TIMER_PWM) {
+            printf("High/low time can only be set in PWM mode\n");
+
+        // must leave room for the opposite phase
+        } else if (ns * 1000ULL >= period_ps) {
+            printf("Time must be shorter than the %lluns period\n", period_ps / 1000);
+
+        // must be at least one counter step
+        } else if (ns * 1000ULL < step_ps / 2) {
+            printf("Time is below the %llups counter step\n", step_ps);
+        } else {
+            if (high) {
+                clock_set_high_ns(ns);
+            } else {
+                clock_set_low_ns(ns);
+            }
+
+            cmd_info();
+        }
+
+    // pulse command
+    } else if (cmd_match(cmd, "pulse")) {
+        char *pulse = cmd_get_arg(cmd);
+        u_int32_t duty_ppm;
+        clock_channel_info_t channel;
+
+        clock_get_channel_info(clock_get_channel(), &channel);
+
+        // the pulse settings need the second pin of the slice
+        if (channel.pulse_pin == CLOCK_PIN_NONE) {
+            printf("Channel %u has no pulse pin\n", clock_get_channel());
+        } else if (strcmp(pulse, "follow") == 0) {
+            clock_set_pulse_mode(CLOCK_PULSE_FOLLOW, CLOCK_DEF_DUTY_PPM);
+            cmd_info();
+        } else if (strcmp(pulse, "invert") == 0) {
+            clock_set_pulse_mode(CLOCK_PULSE_INVERT, CLOCK_DEF_DUTY_PPM);
+            cmd_info();
+        } else if (strcmp(pulse, "blink") == 0) {
+            clock_set_pulse_mode(CLOCK_PULSE_BLINK, CLOCK_DEF_DUTY_PPM);
+            cmd_info();
+
+        // two-phase, dead time in sys clock ticks
+        } else if (cmd_match(pulse, "phi1")) {
+            char *dead = cmd_get_arg(pulse);
+            u_int32_t ticks = clock_get_dead_ticks();
+
+            if (*dead != '\0' && (!cmd_parse_ticks(dead, &ticks) || ticks > CLOCK_DEAD_TICKS_MAX)) {
+                printf("Dead time must be 0 to %d sys clock ticks\n", CLOCK_DEAD_TICKS_MAX);
+            } else if (!clock_set_two_phase(ticks)) {
+                printf("Two-phase output is not available in a phase group\n");
+            } else {
+                cmd_info();
+            }
+        } else if (cmd_parse_percent(pulse, &duty_ppm) && duty_ppm <= 1000000) {
+            clock_set_pulse_mode(CLOCK_PULSE_DUTY, duty_ppm);
+            cmd_info();
+        } else {
+            printf("Usage: pulse <follow|invert|blink|phi1 [ticks]|percent>\n");
+        }
+
+    // align command
+    } else if (cmd_match(cmd, "align")) {
+        char *align = cmd_get_arg(cmd);
+
+        if (strcmp(align, "center") == 0) {
+            if (!clock_set_phase_correct(true)) {
+                printf("Center alignment is not available in a phase group\n");
+            } else {
+                cmd_info();
+            }
+        } else if (strcmp(align, "trailing") == 0) {
+            clock_set_phase_correct(false);
+            cmd_info();
+        } else {
+            printf("Usage: align <trailing|center>\n");
+        }
+
+    // engine command
+    } else if (cmd_match(cmd, "engine")) {
+        char *name = cmd_get_arg(cmd);
+
+        if (*name == '\0') {
+            cmd_engine();
+        } else if (strcmp(name, "auto") == 0) {
+            clock_set_engine(ENGINE_AUTO);
+            cmd_engine();
+        } else if (strcmp(name, "rpt") == 0) {
+            clock_set_engine(ENGINE_RPT);
+            cmd_engine();
+        } else if (strcmp(name, "pwm") == 0) {
+            clock_set_engine(ENGINE_PWM);
+            cmd_engine();
+        } else if (strcmp(name, "gpout") == 0) {
+            clock_set_engine(ENGINE_GPOUT);
+            cmd_engine();
+        } else {
+            printf("Usage: engine [auto|rpt|pwm|gpout]\n");
+        }
+
+    // channel command
+    } else if (cmd_match(cmd, "channel")) {
+        char *arg = cmd_get_arg(cmd);
+        const char *next;
+        u_int8_t index, pin, pulse_pin = CLOCK_PIN_NONE;
+
+        if (*arg == '\0') {
+            cmd_channel();
+        } else if (cmd_match(arg, "add")) {
+            const char *pins = cmd_get_arg(arg);
+
+            if (!cmd_parse_index(pins, &pin, &next) || (*next != '\0' && (!cmd_parse_index(next, &pulse_pin, &next) || *next != '\0'))) {
+                printf("Usage: channel add <pin> [pulse]\n");
+            } else {
+                switch (clock_add_channel(pin, pulse_pin, &index)) {
+                    case CLOCK_CHANNEL_OK:
+                        clock_select_channel(index);
+                        printf("* Channel %u added\n", index);
+                        cmd_info();
+                        break;
+                    case CLOCK_CHANNEL_ERR_RESERVED:
+                        printf("GPIO is reserved\n");
+                        break;
+                    case CLOCK_CHANNEL_ERR_SLICE:
+                        printf("PWM slice is in use or the pulse pin is on another slice\n");
+                        break;
+                    case CLOCK_CHANNEL_ERR_FULL:
+                        printf("All %d channels are in use\n", CLOCK_CHANNEL_MAX);
+                        break;
+                    default:
+                        printf("Invalid GPIO\n");
+                        break;
+                }
+            }
+        } else if (cmd_match(arg, "remove")) {
+            if (!cmd_parse_index(cmd_get_arg(arg), &index, &next) || *next != '\0') {
+                printf("Usage: channel remove <n>\n");
+            } else if (!clock_remove_channel(index)) {
+                printf("Channel %u cannot be removed\n", index);
+            } else {
+                printf("* Channel %u removed\n", index);
+            }
+        } else if (!cmd_parse_index(arg, &index, &next) || *next != '\0') {
+            printf("Usage: channel [n|add <pin> [pulse]|remove <n>]\n");
+        } else if (!clock_select_channel(index)) {
+            printf("Channel %u does not exist\n", index);
+        } else {
+            cmd_info();
+        }
+
+    // sweep command
+    } else if (cmd_match(cmd, "sweep")) {
+        cmd_sweep(cmd_get_arg(cmd));
+
+    // pattern command
+    } else if (cmd_match(cmd, "pattern")) {
+        cmd_pattern(cmd_get_arg(cmd));
+
+    // trigger command
+    } else if (cmd_match(cmd, "trigger")) {
+        cmd_trigger(cmd_get_arg(cmd));
+
+    // spread command
+    } else if (cmd_match(cmd, "spread")) {
+        cmd_spread(cmd_get_arg(cmd));
+
+    // phase command
+    } else if (cmd_match(cmd, "phase")) {
+        cmd_phase(cmd_get_arg(cmd));
+
+    // ref command
+    } else if (cmd_match(cmd, "ref")) {
+        cmd_ref(cmd_get_arg(cmd));
+
+    // track command
+    } else if (cmd_match(cmd, "track")) {
+        cmd_track(cmd_get_arg(cmd));
+
+    // calibrate command
+    } else if (cmd_match(cmd, "calibrate")) {
+        cmd_calibrate(cmd_get_arg(cmd));
+
+    // vco command
+    } else if (cmd_match(cmd, "vco")) {
+        cmd_vco(cmd_get_arg(cmd));
+
+    // jitter command
+    } else if (strcmp(cmd, "jitter") == 0) {
+        cmd_jitter();
+
+    // profile command
+    } else if (cmd_match(cmd, "profile")) {
+        char *name = cmd_get_arg(cmd);
+        u_int8_t profile = CLOCK_PROFILE_COUNT;
+
+        for (u_int8_t i = 0; i < CLOCK_PROFILE_COUNT; i++) {
+            if (strcmp(name, clock_get_profile_name(i)) == 0) {
+                profile = i;
+            }
+        }
+
+        if (*name == '\0') {
+            printf("Profile:\t\t%s\n", clock_get_profile_name(clock_get_profile()));
+        } else if (profile == CLOCK_PROFILE_COUNT) {
+            printf("Usage: profile [standard|performance]\n");
+        } else if (!clock_set_profile(profile)) {
+            printf("Sys clock profile %s is not available\n", name);
+        } else {
             cmd_info();
         }
 
+    // prof command
+    } else if (cmd_match(cmd, "prof")) {
+        if (strcmp(cmd_get_arg(cmd), "reset") == 0) {
+            prof_reset();
+            printf("* Profiler reset\n");
+        } else {
+            cmd_prof();
+        }
+
     // reset command
     } else if (strcmp(cmd, "reset") == 0) {
         clock_reset();
@@ -222,18 +1855,26 @@ void cmd_execute(char *cmd)
             printf("Unknown command\n");
         }
     }
+
+    // a group this command, or tracking since the last one, broke up
+    u_int8_t dissolved = clock_take_phase_dissolved();
+    if (dissolved != CLOCK_PHASE_NONE) {
+        printf("* Phase group of channel %u dissolved, it can no longer run aligned\n", dissolved);
+    }
     
     // run command timer
     cmd_run();
+
+    PROF_END(PROF_SITE_CMD_EXECUTE);
 }
 
 /**
- * Command timer callback
+ * Command timer poll
  * 
  * @param repeating_timer_t *t
  * @return bool
  */
-bool cmd_timer_callback(repeating_timer_t *t)
+bool cmd_timer_poll(repeating_timer_t *t)
 {
     // get cmd data
     cmd_data_t *cmd_data = (cmd_data_t *) t->user_data;
@@ -280,6 +1921,23 @@ bool cmd_timer_callback(repeating_timer_t *t)
     return true;
 }
 
+/**
+ * Command timer callback
+ * 
+ * @param repeating_timer_t *t
+ * @return bool
+ */
+bool cmd_timer_callback(repeating_timer_t *t)
+{
+    PROF_BEGIN(PROF_SITE_CMD_CALLBACK);
+
+    bool result = cmd_timer_poll(t);
+
+    PROF_END(PROF_SITE_CMD_CALLBACK);
+
+    return result;
+}
+
 /**
  * Command stop timer
  * 
@@ -1,6 +1,8 @@
 #ifndef CMD_H
 #define CMD_H
 
+#define CMD_ARGS_MAX 64
+
 /**
  * Cmd info function
  * 
@@ -9,6 +11,27 @@
 void cmd_info();
 
 
+/**
+ * Cmd jitter function
+ * 
+ * @return void
+ */
+void cmd_jitter();
+
+/**
+ * Cmd engine function
+ * 
+ * @return void
+ */
+void cmd_engine();
+
+/**
+ * Cmd prof function
+ * 
+ * @return void
+ */
+void cmd_prof();
+
 /**
  * Cmd help function
  * 
@@ -16,6 +39,14 @@ void cmd_info();
  */
 void cmd_help();
 
+/**
+ * Cmd execute a console line
+ * 
+ * @param char *cmd
+ * @return void
+ */
+void cmd_execute(char *cmd);
+
 /**
  * Cmd start timer 
  * 
@@ -0,0 +1,277 @@
+#include <string.h>
+#include "engine.h"
+#include "prof.h"
+
+/**
+ * Engine RPT interrupt latency (timer IRQ shared with USB stdio)
+ * 
+ * @var u_int32_t
+ */
+#define ENGINE_RPT_JITTER_NS 10000
+
+/**
+ * Engine RPT cycles per callback when the profiler has no samples
+ * 
+ * @var u_int32_t
+ */
+#define ENGINE_RPT_IRQ_CYCLES 2000
+
+/**
+ * Engine largest CPU share an engine may take
+ * 
+ * @var u_int32_t
+ */
+#define ENGINE_CPU_MAX_PPM 500000
+
+/**
+ * Engine names
+ * 
+ * @var const char *[]
+ */
+static const char *engine_names[ENGINE_COUNT] = {
+    "RPT",
+    "PWM",
+    "GPOUT",
+};
+
+/**
+ * Engine scores from the last selection
+ * 
+ * @var engine_score_t[]
+ */
+static engine_score_t engine_scores[ENGINE_COUNT];
+
+/**
+ * Engine picked by the last selection
+ * 
+ * @var u_int8_t
+ */
+static u_int8_t engine_selected = ENGINE_NONE;
+
+/**
+ * Engine absolute difference
+ * 
+ * @param u_int64_t a
+ * @param u_int64_t b
+ * @return u_int64_t
+ */
+static u_int64_t engine_abs_diff(u_int64_t a, u_int64_t b)
+{
+    return a > b ? a - b : b - a;
+}
+
+/**
+ * Engine clamp to u_int32_t
+ * 
+ * @param u_int64_t value
+ * @return u_int32_t
+ */
+static u_int32_t engine_clamp(u_int64_t value)
+{
+    return value > UINT32_MAX ? UINT32_MAX : value;
+}
+
+/**
+ * Engine jitter in ppm of the output period
+ * 
+ * @param u_int64_t jitter_ps
+ * @param u_int64_t mhz
+ * @return u_int32_t
+ */
+static u_int32_t engine_jitter_ppm(u_int64_t jitter_ps, u_int64_t mhz)
+{
+    return engine_clamp(jitter_ps * mhz / 1000000000);
+}
+
+/**
+ * Engine get repeating timer half period in crystal microseconds
+ * 
+ * The timer ticks are derived from the crystal, so a fast crystal needs
+ * proportionally more of them for the same true half period.
+ * 
+ * @param u_int64_t mhz
+ * @param int32_t cal_ppb
+ * @return u_int64_t
+ */
+u_int64_t engine_get_rpt_half_us(u_int64_t mhz, int32_t cal_ppb)
+{
+    u_int64_t half_ns = 500000000000ULL / mhz;
+    int64_t ticks_ns = half_ns + (int64_t) half_ns * cal_ppb / 1000000000;
+
+    return ((u_int64_t) ticks_ns + 500) / 1000;
+}
+
+/**
+ * Engine score repeating timer
+ * 
+ * Toggles every half period in whole microseconds from a timer IRQ, so
+ * it is exact at low rates but pays interrupt latency and CPU per edge.
+ * 
+ * @param const engine_request_t *req
+ * @param engine_score_t *score
+ * @return void
+ */
+static void engine_score_rpt(const engine_request_t *req, engine_score_t *score)
+{
+    u_int64_t half_us = engine_get_rpt_half_us(req->mhz, req->cal_ppb);
+    if (half_us < ENGINE_RPT_MIN_US) {
+        return;
+    }
+
+    u_int32_t cycles = ENGINE_RPT_IRQ_CYCLES;
+
+#if PROF_ENABLED
+    // prefer the measured callback cost
+    prof_site_t prof;
+    prof_get_site(PROF_SITE_RPT_CALLBACK, &prof);
+    if (prof.count > 0) {
+        cycles = prof.total / prof.count;
+    }
+#endif
+
+    // a crystal microsecond lasts 1e9 / (1e9 + cal_ppb) true ones
+    u_int64_t actual_mhz = 500000000ULL * (1000000000 + req->cal_ppb) / 1000000000 / half_us;
+
+    score->freq_error_ppm = engine_clamp(engine_abs_diff(actual_mhz, req->mhz) * 1000000 / req->mhz);
+    score->jitter_ppm = engine_jitter_ppm(ENGINE_RPT_JITTER_NS * 1000ULL, req->mhz);
+    score->duty_error_ppm = engine_abs_diff(req->duty_ppm, 500000);
+    score->cpu_ppm = engine_clamp(2 * req->mhz * cycles * 1000 / req->sys_hz);
+    score->feasible = score->cpu_ppm <= ENGINE_CPU_MAX_PPM;
+}
+
+/**
+ * Engine score PWM
+ * 
+ * Hardware generated, no CPU per edge. The fractional divider adds one
+ * sys clock cycle of jitter when its fraction is non-zero.
+ * 
+ * @param const engine_request_t *req
+ * @param engine_score_t *score
+ * @return void
+ */
+static void engine_score_pwm(const engine_request_t *req, engine_score_t *score)
+{
+    const plan_t *plan = req->plan;
+    if (plan == NULL) {
+        return;
+    }
+
+    u_int64_t period = (u_int64_t) plan->top + 1;
+    u_int64_t level = plan->level < period ? plan->level : period;
+    u_int64_t jitter_ps = plan->div_frac ? (1000000000000ULL + req->sys_hz / 2) / req->sys_hz : 0;
+
+    score->freq_error_ppm = (plan->error_ppb < 0 ? -(int64_t) plan->error_ppb : plan->error_ppb) / 1000;
+    score->jitter_ppm = engine_jitter_ppm(jitter_ps, req->mhz);
+    score->duty_error_ppm = engine_abs_diff(level * 1000000 / period, req->duty_ppm);
+    score->cpu_ppm = 0;
+    score->feasible = true;
+}
+
+/**
+ * Engine score clk_gpout
+ * 
+ * Hardware generated on the GPOUT pin at a fixed 50% duty. The 24.8
+ * fractional divider alternates between two periods, one source cycle
+ * apart, when its fraction is non-zero.
+ * 
+ * @param const engine_request_t *req
+ * @param engine_score_t *score
+ * @return void
+ */
+static void engine_score_gpout(const engine_request_t *req, engine_score_t *score)
+{
+    const gpout_plan_t *plan = req->gpout;
+    if (plan == NULL) {
+        return;
+    }
+
+    score->freq_error_ppm = (plan->error_ppb < 0 ? -(int64_t) plan->error_ppb : plan->error_ppb) / 1000;
+    score->jitter_ppm = engine_jitter_ppm(gpout_get_jitter_ps(plan), req->mhz);
+    score->duty_error_ppm = engine_abs_diff(req->duty_ppm, 500000);
+    score->cpu_ppm = 0;
+    score->feasible = true;
+}
+
+/**
+ * Engine select the lowest cost feasible engine (honours a forced preference)
+ * 
+ * ENGINE_NONE when no engine can produce the request.
+ * 
+ * @param const engine_request_t *req
+ * @return u_int8_t
+ */
+u_int8_t engine_select(const engine_request_t *req)
+{
+    memset(engine_scores, 0, sizeof(engine_scores));
+
+    engine_score_rpt(req, &engine_scores[ENGINE_RPT]);
+    engine_score_pwm(req, &engine_scores[ENGINE_PWM]);
+    engine_score_gpout(req, &engine_scores[ENGINE_GPOUT]);
+
+    u_int64_t best_cost = UINT64_MAX;
+    engine_selected = ENGINE_NONE;
+
+    for (u_int8_t engine = 0; engine < ENGINE_COUNT; engine++) {
+        engine_score_t *score = &engine_scores[engine];
+        if (!score->feasible) {
+            continue;
+        }
+
+        u_int64_t cost = (u_int64_t) score->freq_error_ppm + score->jitter_ppm + score->duty_error_ppm + score->cpu_ppm;
+        score->cost = engine_clamp(cost);
+
+        // GPOUT moves the output pin, so it is only used when forced
+        if (engine == ENGINE_GPOUT) {
+            continue;
+        }
+
+        if (cost < best_cost) {
+            best_cost = cost;
+            engine_selected = engine;
+        }
+    }
+
+    // a forced engine wins whenever it can produce the request at all
+    if (req->preference < ENGINE_COUNT && engine_scores[req->preference].feasible) {
+        engine_selected = req->preference;
+    }
+
+    return engine_selected;
+}
+
+/**
+ * Engine get score from the last selection
+ * 
+ * @param u_int8_t engine
+ * @param engine_score_t *score
+ * @return void
+ */
+void engine_get_score(u_int8_t engine, engine_score_t *score)
+{
+    *score = engine_scores[engine];
+}
+
+/**
+ * Engine get engine picked by the last selection
+ * 
+ * @return u_int8_t
+ */
+u_int8_t engine_get_selected()
+{
+    return engine_selected;
+}
+
+/**
+ * Engine get name
+ * 
+ * @param u_int8_t engine
+ * @return const char *
+ */
+const char *engine_get_name(u_int8_t engine)
+{
+    if (engine == ENGINE_NONE) {
+        return "none";
+    }
+
+    return engine < ENGINE_COUNT ? engine_names[engine] : "AUTO";
+}
\ No newline at end of file
@@ -0,0 +1,100 @@
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include <stdbool.h>
+#include <sys/types.h>
+#include "plan.h"
+#include "gpout.h"
+
+#define ENGINE_RPT 0
+#define ENGINE_PWM 1
+#define ENGINE_GPOUT 2
+#define ENGINE_COUNT 3
+#define ENGINE_NONE 0xfe
+#define ENGINE_AUTO 0xff
+
+// shortest repeating timer half period in us
+#define ENGINE_RPT_MIN_US 20
+
+/**
+ * Engine request type
+ * 
+ * The PWM and GPOUT plans are solved by the caller (NULL when
+ * infeasible), the PWM level already set for the requested duty. The
+ * crystal offset corrects the repeating timer, which counts crystal
+ * microseconds. The preference is ENGINE_AUTO or the engine forced for
+ * this output.
+ * 
+ * @var engine_request_t
+ */
+typedef struct {
+    u_int32_t sys_hz;
+    u_int64_t mhz;
+    u_int32_t duty_ppm;
+    const plan_t *plan;
+    const gpout_plan_t *gpout;
+    int32_t cal_ppb;
+    u_int8_t preference;
+} engine_request_t;
+
+/**
+ * Engine score type
+ * 
+ * All terms are in ppm of the output period (or of CPU time for the
+ * load term) so they can be summed into a single cost.
+ * 
+ * @var engine_score_t
+ */
+typedef struct {
+    bool feasible;
+    u_int32_t freq_error_ppm;
+    u_int32_t jitter_ppm;
+    u_int32_t duty_error_ppm;
+    u_int32_t cpu_ppm;
+    u_int32_t cost;
+} engine_score_t;
+
+/**
+ * Engine select the lowest cost feasible engine (honours a forced preference)
+ * 
+ * ENGINE_NONE when no engine can produce the request.
+ * 
+ * @param const engine_request_t *req
+ * @return u_int8_t
+ */
+u_int8_t engine_select(const engine_request_t *req);
+
+/**
+ * Engine get repeating timer half period in crystal microseconds
+ * 
+ * @param u_int64_t mhz
+ * @param int32_t cal_ppb
+ * @return u_int64_t
+ */
+u_int64_t engine_get_rpt_half_us(u_int64_t mhz, int32_t cal_ppb);
+
+/**
+ * Engine get score from the last selection
+ * 
+ * @param u_int8_t engine
+ * @param engine_score_t *score
+ * @return void
+ */
+void engine_get_score(u_int8_t engine, engine_score_t *score);
+
+/**
+ * Engine get engine picked by the last selection
+ * 
+ * @return u_int8_t
+ */
+u_int8_t engine_get_selected();
+
+/**
+ * Engine get name
+ * 
+ * @param u_int8_t engine
+ * @return const char *
+ */
+const char *engine_get_name(u_int8_t engine);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,63 @@
+#include "gpout.h"
+
+/**
+ * GPOUT solve the 24.8 divider for a target in mHz
+ * 
+ * @param u_int32_t src
+ * @param u_int32_t src_hz
+ * @param u_int64_t mhz
+ * @param gpout_plan_t *plan
+ * @return bool
+ */
+bool gpout_solve(u_int32_t src, u_int32_t src_hz, u_int64_t mhz, gpout_plan_t *plan)
+{
+    if (mhz == 0 || mhz > GPOUT_MAX_HZ * 1000ULL) {
+        return false;
+    }
+
+    u_int64_t target = (u_int64_t) src_hz * 256 * 1000;
+    u_int64_t div = (target + mhz / 2) / mhz;
+
+    if (div < GPOUT_DIV_MIN || div > 0xffffffffULL) {
+        return false;
+    }
+
+    u_int64_t actual = div * mhz;
+    int64_t diff = (int64_t) target - (int64_t) actual;
+
+    plan->src = src;
+    plan->src_hz = src_hz;
+    plan->div_int = div >> 8;
+    plan->div_frac = div & 0xff;
+    plan->error_ppb = diff * 1000000 / (int64_t) (actual / 1000);
+
+    return true;
+}
+
+/**
+ * GPOUT get actual frequency in mHz
+ * 
+ * @param const gpout_plan_t *plan
+ * @return u_int64_t
+ */
+u_int64_t gpout_get_freq_mhz(const gpout_plan_t *plan)
+{
+    u_int64_t div = ((u_int64_t) plan->div_int << 8) | plan->div_frac;
+
+    return ((u_int64_t) plan->src_hz * 256 * 1000 + div / 2) / div;
+}
+
+/**
+ * GPOUT get jitter in ps (one source cycle when the divider is fractional)
+ * 
+ * @param const gpout_plan_t *plan
+ * @return u_int32_t
+ */
+u_int32_t gpout_get_jitter_ps(const gpout_plan_t *plan)
+{
+    if (plan->div_frac == 0) {
+        return 0;
+    }
+
+    return (1000000000000ULL + plan->src_hz / 2) / plan->src_hz;
+}
\ No newline at end of file
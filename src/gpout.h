@@ -0,0 +1,52 @@
+#ifndef GPOUT_H
+#define GPOUT_H
+
+#include <stdbool.h>
+#include <sys/types.h>
+
+#define GPOUT_DIV_MIN 256
+#define GPOUT_MAX_HZ 50000000
+
+/**
+ * GPOUT plan type
+ * 
+ * clk_gpoutN divides its source by div_int + div_frac / 256.
+ * 
+ * @var gpout_plan_t
+ */
+typedef struct {
+    u_int32_t src;
+    u_int32_t src_hz;
+    u_int32_t div_int;
+    u_int8_t div_frac;
+    int32_t error_ppb;
+} gpout_plan_t;
+
+/**
+ * GPOUT solve the 24.8 divider for a target in mHz
+ * 
+ * @param u_int32_t src
+ * @param u_int32_t src_hz
+ * @param u_int64_t mhz
+ * @param gpout_plan_t *plan
+ * @return bool
+ */
+bool gpout_solve(u_int32_t src, u_int32_t src_hz, u_int64_t mhz, gpout_plan_t *plan);
+
+/**
+ * GPOUT get actual frequency in mHz
+ * 
+ * @param const gpout_plan_t *plan
+ * @return u_int64_t
+ */
+u_int64_t gpout_get_freq_mhz(const gpout_plan_t *plan);
+
+/**
+ * GPOUT get jitter in ps (one source cycle when the divider is fractional)
+ * 
+ * @param const gpout_plan_t *plan
+ * @return u_int32_t
+ */
+u_int32_t gpout_get_jitter_ps(const gpout_plan_t *plan);
+
+#endif
\ No newline at end of file
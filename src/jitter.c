@@ -0,0 +1,142 @@
+#include <string.h>
+#include "pico/stdlib.h"
+#include "jitter.h"
+
+/**
+ * Jitter edge timestamp ring
+ * 
+ * @var u_int32_t[]
+ */
+static u_int32_t jitter_ring[JITTER_RING_SIZE];
+
+/**
+ * Jitter ring write count (only the producer advances it)
+ * 
+ * @var volatile u_int32_t
+ */
+static volatile u_int32_t jitter_head = 0;
+
+/**
+ * Jitter record edge timestamp (interrupt safe)
+ * 
+ * @return void
+ */
+void jitter_record()
+{
+    u_int32_t head = jitter_head;
+
+    jitter_ring[head & (JITTER_RING_SIZE - 1)] = time_us_32();
+
+    // publish the slot before the new head
+    __compiler_memory_barrier();
+    jitter_head = head + 1;
+}
+
+/**
+ * Jitter reset capture
+ * 
+ * @return void
+ */
+void jitter_reset()
+{
+    jitter_head = 0;
+}
+
+/**
+ * Jitter integer square root
+ * 
+ * @param u_int64_t value
+ * @return u_int32_t
+ */
+static u_int32_t jitter_isqrt(u_int64_t value)
+{
+    u_int64_t root = 0;
+    u_int64_t bit = 1ULL << 62;
+
+    while (bit > value) {
+        bit >>= 2;
+    }
+
+    while (bit) {
+        if (value >= root + bit) {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+
+        bit >>= 2;
+    }
+
+    return root;
+}
+
+/**
+ * Jitter get statistics
+ * 
+ * @param jitter_stats_t *stats
+ * @return bool
+ */
+bool jitter_get_stats(jitter_stats_t *stats)
+{
+    static u_int32_t edges[JITTER_RING_SIZE];
+
+    memset(stats, 0, sizeof(jitter_stats_t));
+
+    u_int32_t head = jitter_head;
+    u_int32_t count = head < JITTER_RING_SIZE ? head : JITTER_RING_SIZE;
+
+    for (u_int32_t i = 0; i < count; i++) {
+        edges[i] = jitter_ring[(head - count + i) & (JITTER_RING_SIZE - 1)];
+    }
+
+    // drop the oldest slots the producer may have overwritten during the copy
+    __compiler_memory_barrier();
+    u_int32_t overwritten = jitter_head - head;
+    u_int32_t first = overwritten < count ? overwritten : count;
+
+    if (count - first < 3) {
+        return false;
+    }
+
+    // every second edge spans a full period
+    u_int64_t sum = 0;
+    stats->min_us = UINT32_MAX;
+
+    for (u_int32_t i = first + 2; i < count; i++) {
+        u_int32_t period = edges[i] - edges[i - 2];
+
+        sum += period;
+        stats->count++;
+
+        if (period < stats->min_us) {
+            stats->min_us = period;
+        }
+
+        if (period > stats->max_us) {
+            stats->max_us = period;
+        }
+    }
+
+    stats->mean_us = sum / stats->count;
+    stats->worst_us = stats->max_us - stats->mean_us;
+    if (stats->mean_us - stats->min_us > stats->worst_us) {
+        stats->worst_us = stats->mean_us - stats->min_us;
+    }
+
+    stats->bin_us = (stats->max_us - stats->min_us) / JITTER_HIST_BINS + 1;
+
+    u_int64_t squares = 0;
+
+    for (u_int32_t i = first + 2; i < count; i++) {
+        u_int32_t period = edges[i] - edges[i - 2];
+        int64_t deviation = (int64_t) period - stats->mean_us;
+
+        squares += deviation * deviation;
+        stats->bins[(period - stats->min_us) / stats->bin_us]++;
+    }
+
+    stats->stddev_us = jitter_isqrt(squares / stats->count);
+
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,50 @@
+#ifndef JITTER_H
+#define JITTER_H
+
+#include <stdbool.h>
+#include <sys/types.h>
+
+#define JITTER_RING_SIZE 256
+#define JITTER_HIST_BINS 16
+
+/**
+ * Jitter statistics type
+ * 
+ * Periods are measured in microseconds between every second edge.
+ * 
+ * @var jitter_stats_t
+ */
+typedef struct {
+    u_int32_t count;
+    u_int32_t mean_us;
+    u_int32_t stddev_us;
+    u_int32_t min_us;
+    u_int32_t max_us;
+    u_int32_t worst_us;
+    u_int32_t bin_us;
+    u_int16_t bins[JITTER_HIST_BINS];
+} jitter_stats_t;
+
+/**
+ * Jitter record edge timestamp (interrupt safe)
+ * 
+ * @return void
+ */
+void jitter_record();
+
+/**
+ * Jitter reset capture
+ * 
+ * @return void
+ */
+void jitter_reset();
+
+/**
+ * Jitter get statistics
+ * 
+ * @param jitter_stats_t *stats
+ * @return bool
+ */
+bool jitter_get_stats(jitter_stats_t *stats);
+
+#endif
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include "pico/cyw43_arch.h"
 #include "clock.h"
 #include "cmd.h"
+#include "prof.h"
 
 int main() 
 {
@@ -18,12 +19,16 @@ int main()
     sleep_ms(1000);
     cyw43_arch_gpio_put(CYW43_WL_GPIO_LED_PIN, 1);
 
+    // initialize profiler
+    prof_init();
     // initialize clock
     clock_init();
     // initialize cmd
     cmd_init();
 
     while(true) {
+        // tracking and VCO restarts that do not belong in the alarm IRQ
+        clock_poll();
         tight_loop_contents();
     }
 }
\ No newline at end of file
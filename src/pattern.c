@@ -0,0 +1,348 @@
+#include "pico/stdlib.h"
+#include "hardware/dma.h"
+#include "hardware/pio.h"
+#include "pattern.pio.h"
+#include "pattern.h"
+
+/**
+ * Pattern DMA control block type
+ * 
+ * Written by the control channel over the data channel's first register
+ * alias (READ_ADDR, WRITE_ADDR, TRANS_COUNT, CTRL_TRIG).
+ * 
+ * @var pattern_block_t
+ */
+typedef struct {
+    const volatile void *read_addr;
+    volatile void *write_addr;
+    u_int32_t transfer_count;
+    u_int32_t ctrl;
+} pattern_block_t;
+
+// the pattern state machine lives on the first PIO block
+#define PATTERN_PIO pio0
+
+/**
+ * Pattern cycle buffers (front is played, back is filled)
+ * 
+ * @var u_int32_t[][]
+ */
+static u_int32_t pattern_buffers[2][PATTERN_LEN_MAX];
+
+/**
+ * Pattern cycle counts per buffer
+ * 
+ * @var u_int16_t[]
+ */
+static u_int16_t pattern_counts[2];
+
+/**
+ * Pattern lengths per buffer in ticks
+ * 
+ * @var u_int64_t[]
+ */
+static u_int64_t pattern_ticks[2];
+
+/**
+ * Pattern published buffer
+ * 
+ * @var u_int8_t
+ */
+static u_int8_t pattern_front = 0;
+
+/**
+ * Pattern control block lists, one per buffer: stream it, then reload
+ * 
+ * @var pattern_block_t[][]
+ */
+static pattern_block_t pattern_lists[2][2];
+
+/**
+ * Pattern list the reload block restarts the control channel on
+ * 
+ * @var const pattern_block_t *volatile
+ */
+static const pattern_block_t *volatile pattern_next_list = pattern_lists[0];
+
+/**
+ * Pattern state machine (-1 when idle)
+ * 
+ * @var int
+ */
+static int pattern_sm = -1;
+
+/**
+ * Pattern program offset
+ * 
+ * @var u_int32_t
+ */
+static u_int32_t pattern_offset = 0;
+
+/**
+ * Pattern DMA control channel
+ * 
+ * @var int
+ */
+static int pattern_ctrl_chan = -1;
+
+/**
+ * Pattern DMA data channel
+ * 
+ * @var int
+ */
+static int pattern_data_chan = -1;
+
+/**
+ * Pattern get the buffer the DMA is playing
+ * 
+ * The control channel's read address points past the block it last
+ * loaded, so it is above the start of list 1 only once list 1 runs
+ * (the end of list 0 is the start of list 1).
+ * 
+ * @return u_int8_t
+ */
+static u_int8_t pattern_get_playing()
+{
+    uintptr_t addr = dma_hw->ch[pattern_ctrl_chan].read_addr;
+
+    return addr > (uintptr_t) pattern_lists[1] ? 1 : 0;
+}
+
+/**
+ * Pattern update still waiting for the end of the running loop
+ * 
+ * @return bool
+ */
+bool pattern_is_pending()
+{
+    return pattern_is_active() && pattern_get_playing() != pattern_front;
+}
+
+/**
+ * Pattern clear the back buffer for a new pattern
+ * 
+ * @return bool
+ */
+bool pattern_clear()
+{
+    if (pattern_is_pending()) {
+        return false;
+    }
+
+    pattern_counts[!pattern_front] = 0;
+    pattern_ticks[!pattern_front] = 0;
+
+    return true;
+}
+
+/**
+ * Pattern append cycles to the back buffer
+ * 
+ * @param u_int32_t high_ticks
+ * @param u_int32_t low_ticks
+ * @param u_int32_t repeat
+ * @return bool
+ */
+bool pattern_add(u_int32_t high_ticks, u_int32_t low_ticks, u_int32_t repeat)
+{
+    u_int8_t back = !pattern_front;
+
+    if (
+        high_ticks < PATTERN_TICKS_MIN || high_ticks > PATTERN_TICKS_MAX ||
+        low_ticks < PATTERN_TICKS_MIN || low_ticks > PATTERN_TICKS_MAX ||
+        repeat > (u_int32_t) PATTERN_LEN_MAX - pattern_counts[back]
+    ) {
+        return false;
+    }
+
+    u_int32_t word = ((low_ticks - PATTERN_TICKS_MIN) << 16) | (high_ticks - PATTERN_TICKS_MIN);
+
+    for (u_int32_t i = 0; i < repeat; i++) {
+        pattern_buffers[back][pattern_counts[back]++] = word;
+    }
+
+    pattern_ticks[back] += (u_int64_t) (high_ticks + low_ticks) * repeat;
+
+    return true;
+}
+
+/**
+ * Pattern set the control block list for a buffer
+ * 
+ * @param u_int8_t buffer
+ * @return void
+ */
+static void pattern_set_list(u_int8_t buffer)
+{
+    pattern_block_t *list = pattern_lists[buffer];
+
+    // stream the buffer into the TX FIFO, one word per free slot
+    dma_channel_config data = dma_channel_get_default_config(pattern_data_chan);
+    channel_config_set_transfer_data_size(&data, DMA_SIZE_32);
+    channel_config_set_read_increment(&data, true);
+    channel_config_set_write_increment(&data, false);
+    channel_config_set_dreq(&data, pio_get_dreq(PATTERN_PIO, pattern_sm, true));
+    channel_config_set_chain_to(&data, pattern_ctrl_chan);
+
+    // restart the control channel, chaining to itself means no chain
+    dma_channel_config reload = dma_channel_get_default_config(pattern_data_chan);
+    channel_config_set_transfer_data_size(&reload, DMA_SIZE_32);
+    channel_config_set_read_increment(&reload, false);
+    channel_config_set_write_increment(&reload, false);
+
+    list[0].read_addr = pattern_buffers[buffer];
+    list[0].write_addr = &PATTERN_PIO->txf[pattern_sm];
+    list[0].transfer_count = pattern_counts[buffer];
+    list[0].ctrl = channel_config_get_ctrl_value(&data);
+
+    list[1].read_addr = &pattern_next_list;
+    list[1].write_addr = &dma_hw->ch[pattern_ctrl_chan].al3_read_addr_trig;
+    list[1].transfer_count = 1;
+    list[1].ctrl = channel_config_get_ctrl_value(&reload);
+}
+
+/**
+ * Pattern publish the back buffer
+ * 
+ * The reload block reads pattern_next_list at the end of every loop,
+ * so one pointer write switches buffers on a cycle boundary.
+ * 
+ * @return bool
+ */
+bool pattern_commit()
+{
+    u_int8_t back = !pattern_front;
+
+    if (pattern_counts[back] == 0 || pattern_is_pending()) {
+        return false;
+    }
+
+    if (pattern_is_active()) {
+        pattern_set_list(back);
+        pattern_next_list = pattern_lists[back];
+    }
+
+    pattern_front = back;
+
+    return true;
+}
+
+/**
+ * Pattern start on a pin
+ * 
+ * The state machine runs at the sys clock, so ticks are sys clock
+ * cycles and the shortest cycle is 4 ticks.
+ * 
+ * @param u_int8_t pin
+ * @return bool
+ */
+bool pattern_start(u_int8_t pin)
+{
+    if (pattern_is_active() || pattern_counts[pattern_front] == 0 || !pio_can_add_program(PATTERN_PIO, &pattern_program)) {
+        return false;
+    }
+
+    pattern_sm = pio_claim_unused_sm(PATTERN_PIO, false);
+    if (pattern_sm < 0) {
+        return false;
+    }
+
+    pattern_offset = pio_add_program(PATTERN_PIO, &pattern_program);
+
+    pio_sm_config c = pattern_program_get_default_config(pattern_offset);
+    sm_config_set_sideset_pins(&c, pin);
+    sm_config_set_out_shift(&c, true, true, 32);
+    sm_config_set_fifo_join(&c, PIO_FIFO_JOIN_TX);
+    sm_config_set_clkdiv_int_frac(&c, 1, 0);
+
+    pio_gpio_init(PATTERN_PIO, pin);
+    pio_sm_set_consecutive_pindirs(PATTERN_PIO, pattern_sm, pin, 1, true);
+    pio_sm_init(PATTERN_PIO, pattern_sm, pattern_offset, &c);
+
+    pattern_ctrl_chan = dma_claim_unused_channel(true);
+    pattern_data_chan = dma_claim_unused_channel(true);
+
+    pattern_set_list(pattern_front);
+    pattern_next_list = pattern_lists[pattern_front];
+
+    // the control channel writes one block per trigger into the data channel
+    dma_channel_config ctrl = dma_channel_get_default_config(pattern_ctrl_chan);
+    channel_config_set_transfer_data_size(&ctrl, DMA_SIZE_32);
+    channel_config_set_read_increment(&ctrl, true);
+    channel_config_set_write_increment(&ctrl, true);
+    channel_config_set_ring(&ctrl, true, 4);
+
+    dma_channel_configure(pattern_ctrl_chan, &ctrl, &dma_hw->ch[pattern_data_chan].read_addr, pattern_next_list, 4, true);
+
+    pio_sm_set_enabled(PATTERN_PIO, pattern_sm, true);
+
+    return true;
+}
+
+/**
+ * Pattern stop
+ * 
+ * Both channels are disabled before the abort so a chain trigger raised
+ * by the abort cannot restart the other one.
+ * 
+ * @return void
+ */
+void pattern_stop()
+{
+    if (!pattern_is_active()) {
+        return;
+    }
+
+    pio_sm_set_enabled(PATTERN_PIO, pattern_sm, false);
+
+    u_int32_t mask = (1u << pattern_ctrl_chan) | (1u << pattern_data_chan);
+
+    hw_clear_bits(&dma_hw->ch[pattern_ctrl_chan].al1_ctrl, DMA_CH0_CTRL_TRIG_EN_BITS);
+    hw_clear_bits(&dma_hw->ch[pattern_data_chan].al1_ctrl, DMA_CH0_CTRL_TRIG_EN_BITS);
+
+    dma_hw->abort = mask;
+    while (dma_hw->abort & mask) {
+        tight_loop_contents();
+    }
+
+    dma_channel_unclaim(pattern_ctrl_chan);
+    dma_channel_unclaim(pattern_data_chan);
+
+    pio_sm_clear_fifos(PATTERN_PIO, pattern_sm);
+    pio_remove_program(PATTERN_PIO, &pattern_program, pattern_offset);
+    pio_sm_unclaim(PATTERN_PIO, pattern_sm);
+
+    pattern_ctrl_chan = -1;
+    pattern_data_chan = -1;
+    pattern_sm = -1;
+}
+
+/**
+ * Pattern owns the state machine and DMA channels
+ * 
+ * @return bool
+ */
+bool pattern_is_active()
+{
+    return pattern_sm >= 0;
+}
+
+/**
+ * Pattern get cycle count of the published pattern
+ * 
+ * @return u_int16_t
+ */
+u_int16_t pattern_get_count()
+{
+    return pattern_counts[pattern_front];
+}
+
+/**
+ * Pattern get length of the published pattern in sys clock ticks
+ * 
+ * @return u_int64_t
+ */
+u_int64_t pattern_get_ticks()
+{
+    return pattern_ticks[pattern_front];
+}
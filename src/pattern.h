@@ -0,0 +1,86 @@
+#ifndef PATTERN_H
+#define PATTERN_H
+
+#include <stdbool.h>
+#include <sys/types.h>
+
+#ifndef PATTERN_LEN_MAX
+#define PATTERN_LEN_MAX 1024
+#endif
+
+#define PATTERN_TICKS_MIN 2
+#define PATTERN_TICKS_MAX 65537
+
+/**
+ * Pattern clear the back buffer for a new pattern
+ * 
+ * Fails while a previous update is still waiting for the running
+ * pattern to reach its end.
+ * 
+ * @return bool
+ */
+bool pattern_clear();
+
+/**
+ * Pattern append cycles to the back buffer
+ * 
+ * @param u_int32_t high_ticks
+ * @param u_int32_t low_ticks
+ * @param u_int32_t repeat
+ * @return bool
+ */
+bool pattern_add(u_int32_t high_ticks, u_int32_t low_ticks, u_int32_t repeat);
+
+/**
+ * Pattern publish the back buffer
+ * 
+ * A running pattern switches to it at the end of its current loop.
+ * 
+ * @return bool
+ */
+bool pattern_commit();
+
+/**
+ * Pattern start on a pin
+ * 
+ * @param u_int8_t pin
+ * @return bool
+ */
+bool pattern_start(u_int8_t pin);
+
+/**
+ * Pattern stop
+ * 
+ * @return void
+ */
+void pattern_stop();
+
+/**
+ * Pattern owns the state machine and DMA channels
+ * 
+ * @return bool
+ */
+bool pattern_is_active();
+
+/**
+ * Pattern update still waiting for the end of the running loop
+ * 
+ * @return bool
+ */
+bool pattern_is_pending();
+
+/**
+ * Pattern get cycle count of the published pattern
+ * 
+ * @return u_int16_t
+ */
+u_int16_t pattern_get_count();
+
+/**
+ * Pattern get length of the published pattern in sys clock ticks
+ * 
+ * @return u_int64_t
+ */
+u_int64_t pattern_get_ticks();
+
+#endif
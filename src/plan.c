@@ -0,0 +1,93 @@
+#include <stdint.h>
+#include "plan.h"
+#include "plan_core.h"
+
+/**
+ * Plan solve for a rational target frequency (num / den Hz)
+ * 
+ * @param u_int32_t sys_hz
+ * @param u_int64_t num
+ * @param u_int64_t den
+ * @param u_int32_t duty_ppm
+ * @param bool ph_correct
+ * @param plan_t *plan
+ * @return bool
+ */
+bool plan_solve(u_int32_t sys_hz, u_int64_t num, u_int64_t den, u_int32_t duty_ppm, bool ph_correct, plan_t *plan)
+{
+    return plan_core_solve(sys_hz, num, den, duty_ppm, ph_correct, plan);
+}
+
+/**
+ * Plan fit a target frequency in mHz to a fixed divider (8.4 fixed point)
+ * 
+ * @param u_int32_t sys_hz
+ * @param u_int64_t mhz
+ * @param u_int16_t div
+ * @param u_int32_t duty_ppm
+ * @param bool ph_correct
+ * @param plan_t *plan
+ * @return bool
+ */
+bool plan_fit(u_int32_t sys_hz, u_int64_t mhz, u_int16_t div, u_int32_t duty_ppm, bool ph_correct, plan_t *plan)
+{
+    if (mhz == 0 || div < PLAN_DIV_MIN || div > PLAN_DIV_MAX) {
+        return false;
+    }
+
+    u_int64_t num = mhz * (ph_correct ? 2 : 1);
+    u_int64_t target = (u_int64_t) sys_hz * 16 * 1000;
+    u_int64_t period = plan_core_div_round(target, div * num);
+
+    if (period < PLAN_PERIOD_MIN || period > PLAN_PERIOD_MAX) {
+        return false;
+    }
+
+    u_int64_t actual = div * period * num;
+
+    plan->div_int = div >> 4;
+    plan->div_frac = div & 0xf;
+    plan->top = period - 1;
+    plan->level = plan_get_level(plan, duty_ppm);
+    plan->error_ppb = plan_core_error_ppb(target, actual);
+    plan->ph_correct = ph_correct;
+
+    return true;
+}
+
+/**
+ * Plan get channel level for a duty cycle in ppm
+ * 
+ * @param const plan_t *plan
+ * @param u_int32_t duty_ppm
+ * @return u_int16_t
+ */
+u_int16_t plan_get_level(const plan_t *plan, u_int32_t duty_ppm)
+{
+    return plan_core_level(plan->top, duty_ppm);
+}
+
+/**
+ * Plan get divider in 1/16ths
+ * 
+ * @param const plan_t *plan
+ * @return u_int16_t
+ */
+u_int16_t plan_get_div(const plan_t *plan)
+{
+    return (plan->div_int << 4) | plan->div_frac;
+}
+
+/**
+ * Plan get actual frequency in mHz
+ * 
+ * @param const plan_t *plan
+ * @param u_int32_t sys_hz
+ * @return u_int64_t
+ */
+u_int64_t plan_get_freq_mhz(const plan_t *plan, u_int32_t sys_hz)
+{
+    u_int64_t period = (u_int64_t) plan_get_div(plan) * ((u_int32_t) plan->top + 1) * (plan->ph_correct ? 2 : 1);
+
+    return plan_core_div_round((u_int64_t) sys_hz * 16 * 1000, period);
+}
\ No newline at end of file
@@ -0,0 +1,90 @@
+#ifndef PLAN_H
+#define PLAN_H
+
+#include <stdbool.h>
+#include <sys/types.h>
+
+#define PLAN_DIV_MIN 16
+#define PLAN_DIV_MAX 4095
+#define PLAN_PERIOD_MIN 2
+#define PLAN_PERIOD_MAX 65535
+#define PLAN_SEARCH_SPAN 32
+
+/**
+ * Frequency plan type
+ * 
+ * Register values for one PWM slice. The divider is 8.4 fixed point and
+ * the period is top + 1 counter steps, or 2 * (top + 1) when the slice
+ * counts up and down in phase-correct mode. A TOP of 0 never toggles the
+ * output, so plans keep at least PLAN_PERIOD_MIN steps, and TOP stops at
+ * 65534 so a level of TOP + 1 (100% duty) still fits the 16-bit CC.
+ * 
+ * @var plan_t
+ */
+typedef struct {
+    u_int8_t div_int;
+    u_int8_t div_frac;
+    u_int16_t top;
+    u_int16_t level;
+    int32_t error_ppb;
+    bool ph_correct;
+} plan_t;
+
+/**
+ * Plan solve for a rational target frequency (num / den Hz)
+ * 
+ * Integer only. Scans at most PLAN_SEARCH_SPAN dividers upwards from the
+ * smallest one that fits the period into the counter, keeping the
+ * candidate with the lowest frequency error (ties keep the larger
+ * period for duty resolution).
+ * 
+ * @param u_int32_t sys_hz
+ * @param u_int64_t num
+ * @param u_int64_t den
+ * @param u_int32_t duty_ppm
+ * @param bool ph_correct
+ * @param plan_t *plan
+ * @return bool
+ */
+bool plan_solve(u_int32_t sys_hz, u_int64_t num, u_int64_t den, u_int32_t duty_ppm, bool ph_correct, plan_t *plan);
+
+/**
+ * Plan fit a target frequency in mHz to a fixed divider (8.4 fixed point)
+ * 
+ * @param u_int32_t sys_hz
+ * @param u_int64_t mhz
+ * @param u_int16_t div
+ * @param u_int32_t duty_ppm
+ * @param bool ph_correct
+ * @param plan_t *plan
+ * @return bool
+ */
+bool plan_fit(u_int32_t sys_hz, u_int64_t mhz, u_int16_t div, u_int32_t duty_ppm, bool ph_correct, plan_t *plan);
+
+/**
+ * Plan get channel level for a duty cycle in ppm
+ * 
+ * @param const plan_t *plan
+ * @param u_int32_t duty_ppm
+ * @return u_int16_t
+ */
+u_int16_t plan_get_level(const plan_t *plan, u_int32_t duty_ppm);
+
+/**
+ * Plan get divider in 1/16ths
+ * 
+ * @param const plan_t *plan
+ * @return u_int16_t
+ */
+u_int16_t plan_get_div(const plan_t *plan);
+
+/**
+ * Plan get actual frequency in mHz
+ * 
+ * @param const plan_t *plan
+ * @param u_int32_t sys_hz
+ * @return u_int64_t
+ */
+u_int64_t plan_get_freq_mhz(const plan_t *plan, u_int32_t sys_hz);
+
+#endif
\ No newline at end of file
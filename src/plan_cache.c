@@ -0,0 +1,192 @@
+#include <string.h>
+#include "plan_cache.h"
+
+/**
+ * Plan cache flash table sys clock
+ * 
+ * @var u_int32_t
+ */
+#define PLAN_CACHE_ROM_SYS_HZ 125000000
+
+/**
+ * Plan cache entry type
+ * 
+ * @var plan_cache_entry_t
+ */
+typedef struct {
+    u_int64_t mhz;
+    u_int8_t div_int;
+    u_int8_t div_frac;
+    u_int16_t top;
+    int32_t error_ppb;
+} plan_cache_entry_t;
+
+/**
+ * Plan cache RAM slot type
+ * 
+ * @var plan_cache_slot_t
+ */
+typedef struct {
+    u_int32_t sys_hz;
+    bool ph_correct;
+    bool uncounted;
+    u_int32_t used;
+    plan_cache_entry_t entry;
+} plan_cache_slot_t;
+
+/**
+ * Plan cache flash table of standard crystal frequencies
+ * 
+ * Solved with plan_solve() for a PLAN_CACHE_ROM_SYS_HZ sys clock in
+ * trailing-edge mode; test/plan_test.c fails when the solver changes
+ * and the table needs regenerating.
+ * 
+ * @var const plan_cache_entry_t[]
+ */
+static const plan_cache_entry_t plan_cache_rom[] = {
+    { 1000000ULL, 2, 0, 62499, 0 },
+    { 1000000000ULL, 1, 0, 124, 0 },
+    { 1022727000ULL, 1, 1, 114, 284438 },
+    { 1789773000ULL, 1, 10, 42, -482873 },
+    { 1843200000ULL, 1, 15, 34, 64004 },
+    { 2000000000ULL, 1, 4, 49, 0 },
+    { 3579545000ULL, 2, 11, 12, -482594 },
+    { 3686400000ULL, 1, 0, 33, -2693525 },
+    { 4000000000ULL, 1, 4, 24, 0 },
+    { 4915200000ULL, 2, 5, 10, -243140 },
+    { 8000000000ULL, 1, 9, 9, 0 },
+    { 10000000000ULL, 1, 4, 9, 0 },
+    { 14318180000ULL, 1, 4, 6, -2267446 },
+    { 16000000000ULL, 1, 9, 4, 0 },
+};
+
+/**
+ * Plan cache RAM slots
+ * 
+ * @var plan_cache_slot_t[]
+ */
+static plan_cache_slot_t plan_cache_slots[PLAN_CACHE_SIZE];
+
+/**
+ * Plan cache use counter (0 marks an empty slot)
+ * 
+ * @var u_int32_t
+ */
+static u_int32_t plan_cache_clock = 0;
+
+/**
+ * Plan cache statistics
+ * 
+ * @var plan_cache_stats_t
+ */
+static plan_cache_stats_t plan_cache_stats;
+
+/**
+ * Plan cache load entry into plan
+ * 
+ * @param const plan_cache_entry_t *entry
+ * @param u_int32_t duty_ppm
+ * @param bool ph_correct
+ * @param plan_t *plan
+ * @return void
+ */
+static void plan_cache_load(const plan_cache_entry_t *entry, u_int32_t duty_ppm, bool ph_correct, plan_t *plan)
+{
+    plan->ph_correct = ph_correct;
+    plan->div_int = entry->div_int;
+    plan->div_frac = entry->div_frac;
+    plan->top = entry->top;
+    plan->error_ppb = entry->error_ppb;
+    plan->level = plan_get_level(plan, duty_ppm);
+}
+
+/**
+ * Plan cache solve (flash table, then RAM LRU, then solver)
+ * 
+ * @param u_int32_t sys_hz
+ * @param u_int64_t mhz
+ * @param u_int32_t duty_ppm
+ * @param bool ph_correct
+ * @param bool count
+ * @param plan_t *plan
+ * @return bool
+ */
+bool plan_cache_solve(u_int32_t sys_hz, u_int64_t mhz, u_int32_t duty_ppm, bool ph_correct, bool count, plan_t *plan)
+{
+    if (sys_hz == PLAN_CACHE_ROM_SYS_HZ && !ph_correct) {
+        for (size_t i = 0; i < sizeof(plan_cache_rom) / sizeof(plan_cache_rom[0]); i++) {
+            if (plan_cache_rom[i].mhz == mhz) {
+                plan_cache_load(&plan_cache_rom[i], duty_ppm, false, plan);
+                plan_cache_stats.rom_hits += count;
+                return true;
+            }
+        }
+    }
+
+    plan_cache_slot_t *oldest = &plan_cache_slots[0];
+
+    for (int i = 0; i < PLAN_CACHE_SIZE; i++) {
+        plan_cache_slot_t *slot = &plan_cache_slots[i];
+
+        if (slot->used && slot->sys_hz == sys_hz && slot->ph_correct == ph_correct && slot->entry.mhz == mhz) {
+            slot->used = ++plan_cache_clock;
+            plan_cache_load(&slot->entry, duty_ppm, ph_correct, plan);
+
+            // a miss solved by an uncounted lookup is still the retune's miss
+            if (count && slot->uncounted) {
+                plan_cache_stats.misses++;
+            } else {
+                plan_cache_stats.ram_hits += count;
+            }
+
+            slot->uncounted = slot->uncounted && !count;
+            return true;
+        }
+
+        if (slot->used < oldest->used) {
+            oldest = slot;
+        }
+    }
+
+    plan_cache_stats.misses += count;
+
+    if (!plan_solve(sys_hz, mhz, 1000, duty_ppm, ph_correct, plan)) {
+        return false;
+    }
+
+    // evict the least recently used slot
+    oldest->sys_hz = sys_hz;
+    oldest->ph_correct = ph_correct;
+    oldest->uncounted = !count;
+    oldest->used = ++plan_cache_clock;
+    oldest->entry.mhz = mhz;
+    oldest->entry.div_int = plan->div_int;
+    oldest->entry.div_frac = plan->div_frac;
+    oldest->entry.top = plan->top;
+    oldest->entry.error_ppb = plan->error_ppb;
+
+    return true;
+}
+
+/**
+ * Plan cache get statistics
+ * 
+ * @param plan_cache_stats_t *stats
+ * @return void
+ */
+void plan_cache_get_stats(plan_cache_stats_t *stats)
+{
+    *stats = plan_cache_stats;
+}
+
+/**
+ * Plan cache reset (drops RAM entries and statistics)
+ * 
+ * @return void
+ */
+void plan_cache_reset()
+{
+    memset(plan_cache_slots, 0, sizeof(plan_cache_slots));
+    memset(&plan_cache_stats, 0, sizeof(plan_cache_stats));
+    plan_cache_clock = 0;
+}
\ No newline at end of file
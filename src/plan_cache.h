@@ -0,0 +1,55 @@
+#ifndef PLAN_CACHE_H
+#define PLAN_CACHE_H
+
+#include <stdbool.h>
+#include <sys/types.h>
+#include "plan.h"
+
+#define PLAN_CACHE_SIZE 8
+
+/**
+ * Plan cache statistics type
+ * 
+ * @var plan_cache_stats_t
+ */
+typedef struct {
+    u_int32_t rom_hits;
+    u_int32_t ram_hits;
+    u_int32_t misses;
+} plan_cache_stats_t;
+
+/**
+ * Plan cache solve (flash table, then RAM LRU, then solver)
+ * 
+ * A hit skips the solver's divider search, the caller still derives the
+ * level and scores the engines. Only lookups made to program a slice
+ * should be counted, so one retune counts once however often its plan
+ * is looked up on the way; a miss solved by an uncounted lookup is
+ * reported by the first counted one.
+ * 
+ * @param u_int32_t sys_hz
+ * @param u_int64_t mhz
+ * @param u_int32_t duty_ppm
+ * @param bool ph_correct
+ * @param bool count
+ * @param plan_t *plan
+ * @return bool
+ */
+bool plan_cache_solve(u_int32_t sys_hz, u_int64_t mhz, u_int32_t duty_ppm, bool ph_correct, bool count, plan_t *plan);
+
+/**
+ * Plan cache get statistics
+ * 
+ * @param plan_cache_stats_t *stats
+ * @return void
+ */
+void plan_cache_get_stats(plan_cache_stats_t *stats);
+
+/**
+ * Plan cache reset (drops RAM entries and statistics)
+ * 
+ * @return void
+ */
+void plan_cache_reset();
+
+#endif
\ No newline at end of file
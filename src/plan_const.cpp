@@ -0,0 +1,73 @@
+#include <stdint.h>
+
+extern "C" {
+#include "plan.h"
+#include "plan_const.h"
+#include "clock.h"
+}
+
+#include "plan_core.h"
+
+#if CLOCK_FIXED_FREQ
+
+namespace {
+
+/**
+ * Plan const result type
+ * 
+ * @var plan_const_result_t
+ */
+struct plan_const_result_t {
+    bool ok;
+    plan_t plan;
+};
+
+/**
+ * Plan const solve, plan_solve()'s own search run by the compiler
+ * 
+ * @param u_int32_t sys_hz
+ * @param u_int64_t num
+ * @param u_int64_t den
+ * @param u_int32_t duty_ppm
+ * @return plan_const_result_t
+ */
+constexpr plan_const_result_t plan_const_solve(u_int32_t sys_hz, u_int64_t num, u_int64_t den, u_int32_t duty_ppm)
+{
+    plan_const_result_t result = {};
+
+    result.ok = plan_core_solve(sys_hz, num, den, duty_ppm, false, &result.plan);
+
+    return result;
+}
+
+/**
+ * Plan const error check
+ * 
+ * A failing instantiation names the plan error in ppm as its template
+ * argument, e.g. plan_const_check_error_ppm<-482>.
+ */
+template <int32_t error_ppm>
+struct plan_const_check_error_ppm {
+    static_assert(
+        error_ppm <= CLOCK_FIXED_MAX_PPM && -error_ppm <= CLOCK_FIXED_MAX_PPM,
+        "CLOCK_DEF_FREQ_HZ plan error (ppm in the template argument) exceeds CLOCK_FIXED_MAX_PPM"
+    );
+
+    static constexpr bool value = true;
+};
+
+constexpr plan_const_result_t plan_const_result = plan_const_solve(
+    CLOCK_FIXED_SYS_HZ,
+    CLOCK_DEF_FREQ_HZ * 1000ULL,
+    1000,
+    CLOCK_DEF_DUTY_PPM
+);
+
+static_assert(plan_const_result.ok, "CLOCK_DEF_FREQ_HZ cannot be reached by the PWM divider and wrap");
+static_assert(plan_const_check_error_ppm<plan_const_result.plan.error_ppb / 1000>::value, "");
+
+}
+
+extern "C" const plan_t plan_const_default = plan_const_result.plan;
+
+#endif
\ No newline at end of file
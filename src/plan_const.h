@@ -0,0 +1,27 @@
+#ifndef PLAN_CONST_H
+#define PLAN_CONST_H
+
+#include "plan.h"
+
+#ifndef CLOCK_FIXED_FREQ
+#define CLOCK_FIXED_FREQ 0
+#endif
+
+#ifndef CLOCK_FIXED_SYS_HZ
+#define CLOCK_FIXED_SYS_HZ 125000000
+#endif
+
+#ifndef CLOCK_FIXED_MAX_PPM
+#define CLOCK_FIXED_MAX_PPM 100
+#endif
+
+#if CLOCK_FIXED_FREQ
+/**
+ * Plan for CLOCK_DEF_FREQ_HZ solved at compile time (plan_const.cpp)
+ * 
+ * @var const plan_t
+ */
+extern const plan_t plan_const_default;
+#endif
+
+#endif
\ No newline at end of file
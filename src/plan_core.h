@@ -0,0 +1,157 @@
+#ifndef PLAN_CORE_H
+#define PLAN_CORE_H
+
+#include <stdint.h>
+#include "plan.h"
+
+/**
+ * Plan core: the solver search shared by plan.c and the compile-time
+ * plan in plan_const.cpp, so both always produce the same plan. C gets
+ * static inline functions, C++ constexpr ones.
+ */
+#ifdef __cplusplus
+#define PLAN_CORE_FN constexpr
+#else
+#define PLAN_CORE_FN static inline
+#endif
+
+/**
+ * Plan core divide rounding to nearest
+ * 
+ * @param u_int64_t num
+ * @param u_int64_t den
+ * @return u_int64_t
+ */
+PLAN_CORE_FN u_int64_t plan_core_div_round(u_int64_t num, u_int64_t den)
+{
+    return (num + den / 2) / den;
+}
+
+/**
+ * Plan core get the error of an actual period against the target in ppb
+ * 
+ * Far-off plans drop low bits of both until the difference times 1e9
+ * fits in 64 bits, the result saturates at the int32 range.
+ * 
+ * @param u_int64_t target
+ * @param u_int64_t actual
+ * @return int32_t
+ */
+PLAN_CORE_FN int32_t plan_core_error_ppb(u_int64_t target, u_int64_t actual)
+{
+    bool positive = target > actual;
+    u_int64_t diff = positive ? target - actual : actual - target;
+
+    while (diff > UINT64_MAX / 1000000000) {
+        diff >>= 1;
+        actual >>= 1;
+    }
+
+    u_int64_t ppb = actual == 0 ? INT32_MAX : diff * 1000000000 / actual;
+    if (ppb > INT32_MAX) {
+        ppb = INT32_MAX;
+    }
+
+    return positive ? (int32_t) ppb : -(int32_t) ppb;
+}
+
+/**
+ * Plan core get channel level of a wrap for a duty cycle in ppm
+ * 
+ * @param u_int16_t top
+ * @param u_int32_t duty_ppm
+ * @return u_int16_t
+ */
+PLAN_CORE_FN u_int16_t plan_core_level(u_int16_t top, u_int32_t duty_ppm)
+{
+    u_int64_t level = plan_core_div_round(((u_int64_t) top + 1) * duty_ppm, 1000000);
+
+    // a TOP of 65535 cannot be held high, CC saturates one step short
+    return level > 0xffff ? 0xffff : (u_int16_t) level;
+}
+
+/**
+ * Plan core solve for a rational target frequency (num / den Hz)
+ * 
+ * The output period in 1/16th sys clock cycles is div * period, which
+ * should equal target = sys_hz * 16 * den / num. Comparing
+ * div * period * num against sys_hz * 16 * den keeps the error exact.
+ * 
+ * A phase-correct period is twice as many counter steps, so it is
+ * solved as a trailing-edge plan for twice the frequency.
+ * 
+ * @param u_int32_t sys_hz
+ * @param u_int64_t num
+ * @param u_int64_t den
+ * @param u_int32_t duty_ppm
+ * @param bool ph_correct
+ * @param plan_t *plan
+ * @return bool
+ */
+PLAN_CORE_FN bool plan_core_solve(u_int32_t sys_hz, u_int64_t num, u_int64_t den, u_int32_t duty_ppm, bool ph_correct, plan_t *plan)
+{
+    if (num == 0 || den == 0) {
+        return false;
+    }
+
+    if (ph_correct) {
+        num *= 2;
+    }
+
+    u_int64_t target = (u_int64_t) sys_hz * 16 * den;
+
+    // smallest divider that fits the period into the 16-bit counter
+    u_int64_t div_min = (target + num * PLAN_PERIOD_MAX - 1) / (num * PLAN_PERIOD_MAX);
+    if (div_min < PLAN_DIV_MIN) {
+        div_min = PLAN_DIV_MIN;
+    }
+
+    if (div_min > PLAN_DIV_MAX) {
+        return false;
+    }
+
+    u_int64_t div_max = div_min + PLAN_SEARCH_SPAN - 1;
+    if (div_max > PLAN_DIV_MAX) {
+        div_max = PLAN_DIV_MAX;
+    }
+
+    u_int64_t best_div = 0;
+    u_int64_t best_period = 0;
+    u_int64_t best_error = UINT64_MAX;
+
+    for (u_int64_t div = div_min; div <= div_max; div++) {
+        u_int64_t period = plan_core_div_round(target, div * num);
+
+        if (period < PLAN_PERIOD_MIN || period > PLAN_PERIOD_MAX) {
+            continue;
+        }
+
+        u_int64_t actual = div * period * num;
+        u_int64_t error = actual > target ? actual - target : target - actual;
+
+        if (error < best_error) {
+            best_div = div;
+            best_period = period;
+            best_error = error;
+        }
+
+        if (error == 0) {
+            break;
+        }
+    }
+
+    if (best_period == 0) {
+        return false;
+    }
+
+    plan->div_int = (u_int8_t) (best_div >> 4);
+    plan->div_frac = (u_int8_t) (best_div & 0xf);
+    plan->top = (u_int16_t) (best_period - 1);
+    plan->level = plan_core_level(plan->top, duty_ppm);
+    plan->error_ppb = plan_core_error_ppb(target, best_div * best_period * num);
+    plan->ph_correct = ph_correct;
+
+    return true;
+}
+
+#endif
@@ -0,0 +1,126 @@
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include "hardware/structs/systick.h"
+#include "prof.h"
+
+/**
+ * Profiler SysTick counter mask (24-bit)
+ * 
+ * @var u_int32_t
+ */
+#define PROF_SYSTICK_MASK 0xffffff
+
+/**
+ * Profiler site names
+ * 
+ * @var const char *[]
+ */
+static const char *prof_site_names[PROF_SITE_COUNT] = {
+    "clock_rpt_timer_callback",
+    "cmd_timer_callback",
+    "cmd_execute",
+    "clock_set_pwm",
+};
+
+/**
+ * Profiler site statistics
+ * 
+ * @var prof_site_t[]
+ */
+static prof_site_t prof_sites[PROF_SITE_COUNT];
+
+/**
+ * Profiler trace point overhead in cycles
+ * 
+ * @var u_int32_t
+ */
+static u_int32_t prof_overhead = 0;
+
+/**
+ * Profiler init (starts SysTick free-running on the processor clock)
+ * 
+ * @return void
+ */
+void prof_init()
+{
+    systick_hw->csr = 0;
+    systick_hw->rvr = PROF_SYSTICK_MASK;
+    systick_hw->cvr = 0;
+    systick_hw->csr = M0PLUS_SYST_CSR_CLKSOURCE_BITS | M0PLUS_SYST_CSR_ENABLE_BITS;
+
+    // measure an empty begin/end pair so it can be subtracted from samples
+    u_int32_t start = systick_hw->cvr;
+    u_int32_t end = systick_hw->cvr;
+    prof_overhead = (start - end) & PROF_SYSTICK_MASK;
+
+    prof_reset();
+}
+
+/**
+ * Profiler record site sample (interrupt safe)
+ * 
+ * SysTick counts down and wraps every 2^24 cycles, so longer sections
+ * alias modulo the counter width.
+ * 
+ * @param u_int8_t site
+ * @param u_int32_t start
+ * @return void
+ */
+void prof_record(u_int8_t site, u_int32_t start)
+{
+    u_int32_t cycles = (start - systick_hw->cvr) & PROF_SYSTICK_MASK;
+    cycles = cycles > prof_overhead ? cycles - prof_overhead : 0;
+
+    uint32_t status = save_and_disable_interrupts();
+    prof_site_t *stats = &prof_sites[site];
+
+    if (stats->count == 0 || cycles < stats->min) {
+        stats->min = cycles;
+    }
+
+    if (cycles > stats->max) {
+        stats->max = cycles;
+    }
+
+    stats->total += cycles;
+    stats->count++;
+    restore_interrupts(status);
+}
+
+/**
+ * Profiler get site statistics
+ * 
+ * @param u_int8_t site
+ * @param prof_site_t *stats
+ * @return void
+ */
+void prof_get_site(u_int8_t site, prof_site_t *stats)
+{
+    uint32_t status = save_and_disable_interrupts();
+    *stats = prof_sites[site];
+    restore_interrupts(status);
+}
+
+/**
+ * Profiler get site name
+ * 
+ * @param u_int8_t site
+ * @return const char *
+ */
+const char *prof_get_site_name(u_int8_t site)
+{
+    return prof_site_names[site];
+}
+
+/**
+ * Profiler reset statistics
+ * 
+ * @return void
+ */
+void prof_reset()
+{
+    uint32_t status = save_and_disable_interrupts();
+    memset(prof_sites, 0, sizeof(prof_sites));
+    restore_interrupts(status);
+}
\ No newline at end of file
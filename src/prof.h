@@ -0,0 +1,84 @@
+#ifndef PROF_H
+#define PROF_H
+
+#include <stdbool.h>
+#include <sys/types.h>
+#include "hardware/structs/systick.h"
+
+#ifndef PROF_ENABLED
+#define PROF_ENABLED 0
+#endif
+
+#define PROF_SITE_RPT_CALLBACK 0
+#define PROF_SITE_CMD_CALLBACK 1
+#define PROF_SITE_CMD_EXECUTE 2
+#define PROF_SITE_SET_PWM 3
+#define PROF_SITE_COUNT 4
+
+/**
+ * Profiler trace points
+ * 
+ * Expand to nothing unless PROF_ENABLED is set, so the hot paths carry
+ * no cost in builds without the profiler.
+ */
+#if PROF_ENABLED
+#define PROF_BEGIN(site) u_int32_t prof_start_##site = systick_hw->cvr
+#define PROF_END(site) prof_record(site, prof_start_##site)
+#else
+#define PROF_BEGIN(site)
+#define PROF_END(site)
+#endif
+
+/**
+ * Profiler site statistics type
+ * 
+ * @var prof_site_t
+ */
+typedef struct {
+    u_int32_t count;
+    u_int32_t min;
+    u_int32_t max;
+    u_int64_t total;
+} prof_site_t;
+
+/**
+ * Profiler init (starts SysTick free-running on the processor clock)
+ * 
+ * @return void
+ */
+void prof_init();
+
+/**
+ * Profiler record site sample (interrupt safe)
+ * 
+ * @param u_int8_t site
+ * @param u_int32_t start
+ * @return void
+ */
+void prof_record(u_int8_t site, u_int32_t start);
+
+/**
+ * Profiler get site statistics
+ * 
+ * @param u_int8_t site
+ * @param prof_site_t *stats
+ * @return void
+ */
+void prof_get_site(u_int8_t site, prof_site_t *stats);
+
+/**
+ * Profiler get site name
+ * 
+ * @param u_int8_t site
+ * @return const char *
+ */
+const char *prof_get_site_name(u_int8_t site);
+
+/**
+ * Profiler reset statistics
+ * 
+ * @return void
+ */
+void prof_reset();
+
+#endif
\ No newline at end of file
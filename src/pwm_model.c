@@ -0,0 +1,452 @@
+#include <string.h>
+#include "pwm_model.h"
+
+/**
+ * PWM model init (register reset values)
+ * 
+ * @param pwm_model_t *m
+ * @return void
+ */
+void pwm_model_init(pwm_model_t *m)
+{
+    memset(m, 0, sizeof(pwm_model_t));
+
+    m->div = 1 << 4;
+    m->pending.top = 0xffff;
+    m->active.top = 0xffff;
+}
+
+/**
+ * PWM model load raw slice registers
+ * 
+ * The shadow buffer cannot be read back from hardware, so the loaded
+ * TOP and CC values are treated as both pending and active.
+ * 
+ * @param pwm_model_t *m
+ * @param u_int32_t csr
+ * @param u_int32_t div
+ * @param u_int32_t ctr
+ * @param u_int32_t cc
+ * @param u_int32_t top
+ * @return void
+ */
+void pwm_model_load(pwm_model_t *m, u_int32_t csr, u_int32_t div, u_int32_t ctr, u_int32_t cc, u_int32_t top)
+{
+    pwm_model_init(m);
+
+    m->enabled = csr & 0x1;
+    m->ph_correct = (csr >> 1) & 0x1;
+    m->inv[PWM_MODEL_CHAN_A] = (csr >> 2) & 0x1;
+    m->inv[PWM_MODEL_CHAN_B] = (csr >> 3) & 0x1;
+    m->divmode = (csr >> 4) & 0x3;
+
+    pwm_model_set_clkdiv_int_frac(m, (div >> 4) & 0xff, div & 0xf);
+
+    m->ctr = ctr & 0xffff;
+    m->pending.top = top & 0xffff;
+    m->pending.cc[PWM_MODEL_CHAN_A] = cc & 0xffff;
+    m->pending.cc[PWM_MODEL_CHAN_B] = cc >> 16;
+    m->active = m->pending;
+}
+
+/**
+ * PWM model latch double buffered registers
+ * 
+ * @param pwm_model_t *m
+ * @return void
+ */
+static void pwm_model_latch(pwm_model_t *m)
+{
+    m->active = m->pending;
+}
+
+/**
+ * PWM model set clock divider (8.4, integer 0 = 256)
+ * 
+ * @param pwm_model_t *m
+ * @param u_int8_t integer
+ * @param u_int8_t fract
+ * @return void
+ */
+void pwm_model_set_clkdiv_int_frac(pwm_model_t *m, u_int8_t integer, u_int8_t fract)
+{
+    u_int16_t div_int = integer ? integer : 256;
+
+    m->div = (div_int << 4) | (fract & 0xf);
+    m->frac = 0;
+}
+
+/**
+ * PWM model set wrap (TOP)
+ * 
+ * @param pwm_model_t *m
+ * @param u_int16_t wrap
+ * @return void
+ */
+void pwm_model_set_wrap(pwm_model_t *m, u_int16_t wrap)
+{
+    m->pending.top = wrap;
+
+    // a disabled slice latches immediately
+    if (!m->enabled) {
+        pwm_model_latch(m);
+    }
+}
+
+/**
+ * PWM model set channel level (CC)
+ * 
+ * @param pwm_model_t *m
+ * @param u_int8_t channel
+ * @param u_int16_t level
+ * @return void
+ */
+void pwm_model_set_chan_level(pwm_model_t *m, u_int8_t channel, u_int16_t level)
+{
+    m->pending.cc[channel & 0x1] = level;
+
+    // a disabled slice latches immediately
+    if (!m->enabled) {
+        pwm_model_latch(m);
+    }
+}
+
+/**
+ * PWM model set phase correct mode
+ * 
+ * @param pwm_model_t *m
+ * @param bool ph_correct
+ * @return void
+ */
+void pwm_model_set_phase_correct(pwm_model_t *m, bool ph_correct)
+{
+    m->ph_correct = ph_correct;
+    m->down = false;
+}
+
+/**
+ * PWM model set output polarity
+ * 
+ * @param pwm_model_t *m
+ * @param bool inv_a
+ * @param bool inv_b
+ * @return void
+ */
+void pwm_model_set_output_polarity(pwm_model_t *m, bool inv_a, bool inv_b)
+{
+    m->inv[PWM_MODEL_CHAN_A] = inv_a;
+    m->inv[PWM_MODEL_CHAN_B] = inv_b;
+}
+
+/**
+ * PWM model set divider mode
+ * 
+ * @param pwm_model_t *m
+ * @param u_int8_t divmode
+ * @return void
+ */
+void pwm_model_set_clkdiv_mode(pwm_model_t *m, u_int8_t divmode)
+{
+    m->divmode = divmode & 0x3;
+}
+
+/**
+ * PWM model set counter
+ * 
+ * @param pwm_model_t *m
+ * @param u_int16_t ctr
+ * @return void
+ */
+void pwm_model_set_counter(pwm_model_t *m, u_int16_t ctr)
+{
+    m->ctr = ctr;
+}
+
+/**
+ * PWM model set enabled
+ * 
+ * @param pwm_model_t *m
+ * @param bool enabled
+ * @return void
+ */
+void pwm_model_set_enabled(pwm_model_t *m, bool enabled)
+{
+    m->enabled = enabled;
+}
+
+/**
+ * PWM model counter step
+ * 
+ * Trailing-edge mode counts 0..TOP and wraps to 0. Phase-correct mode
+ * counts 0..TOP..0, holding TOP and 0 for one step each while the
+ * direction changes, so a period is 2 * (TOP + 1) steps. TOP and CC
+ * latch at the wrap.
+ * 
+ * @param pwm_model_t *m
+ * @return void
+ */
+static void pwm_model_count(pwm_model_t *m)
+{
+    if (!m->ph_correct) {
+        if (m->ctr == m->active.top) {
+            m->ctr = 0;
+            m->wraps++;
+            pwm_model_latch(m);
+        } else {
+            m->ctr++;
+        }
+
+        return;
+    }
+
+    if (!m->down) {
+        if (m->ctr == m->active.top) {
+            m->down = true;
+        } else {
+            m->ctr++;
+        }
+    } else {
+        if (m->ctr == 0) {
+            m->down = false;
+            m->wraps++;
+            pwm_model_latch(m);
+        } else {
+            m->ctr--;
+        }
+    }
+}
+
+/**
+ * PWM model steps until the next wrap (inclusive)
+ * 
+ * @param pwm_model_t *m
+ * @return u_int32_t
+ */
+static u_int32_t pwm_model_counts_to_wrap(pwm_model_t *m)
+{
+    u_int32_t up = (u_int16_t) (m->active.top - m->ctr);
+
+    if (!m->ph_correct) {
+        return up + 1;
+    }
+
+    if (m->down) {
+        return m->ctr + 1;
+    }
+
+    return up + 1 + m->active.top + 1;
+}
+
+/**
+ * PWM model advance counter by steps without reaching the wrap
+ * 
+ * @param pwm_model_t *m
+ * @param u_int32_t counts
+ * @return void
+ */
+static void pwm_model_count_within(pwm_model_t *m, u_int32_t counts)
+{
+    u_int32_t up = (u_int16_t) (m->active.top - m->ctr);
+
+    if (!m->ph_correct) {
+        m->ctr += counts;
+        return;
+    }
+
+    if (m->down) {
+        m->ctr -= counts;
+        return;
+    }
+
+    if (counts <= up) {
+        m->ctr += counts;
+        return;
+    }
+
+    // reached TOP, one step turns around then counts down
+    counts -= up + 1;
+    m->down = true;
+    m->ctr = m->active.top - counts;
+}
+
+/**
+ * PWM model advance counter by steps
+ * 
+ * @param pwm_model_t *m
+ * @param u_int64_t counts
+ * @return void
+ */
+static void pwm_model_count_n(pwm_model_t *m, u_int64_t counts)
+{
+    while (counts > 0) {
+        u_int32_t to_wrap = pwm_model_counts_to_wrap(m);
+
+        if (counts < to_wrap) {
+            pwm_model_count_within(m, counts);
+            return;
+        }
+
+        counts -= to_wrap;
+        m->ctr = 0;
+        m->down = false;
+        m->wraps++;
+        pwm_model_latch(m);
+
+        // nothing is written while running, so every later period is identical
+        u_int32_t period = pwm_model_get_period_counts(m);
+
+        m->wraps += counts / period;
+        counts %= period;
+    }
+}
+
+/**
+ * PWM model advance a single sys clock cycle
+ * 
+ * @param pwm_model_t *m
+ * @param bool b_in
+ * @return void
+ */
+void pwm_model_tick(pwm_model_t *m, bool b_in)
+{
+    bool gate;
+
+    switch (m->divmode) {
+        case PWM_MODEL_DIV_B_HIGH:
+            gate = b_in;
+            break;
+        case PWM_MODEL_DIV_B_RISING:
+            gate = b_in && !m->b_last;
+            break;
+        case PWM_MODEL_DIV_B_FALLING:
+            gate = !b_in && m->b_last;
+            break;
+        default:
+            gate = true;
+            break;
+    }
+
+    m->b_last = b_in;
+    m->cycles++;
+
+    if (!m->enabled || !gate) {
+        return;
+    }
+
+    // fractional divider fires every div / 16 gated cycles on average
+    m->frac += 16;
+    if (m->frac >= m->div) {
+        m->frac -= m->div;
+        pwm_model_count(m);
+    }
+}
+
+/**
+ * PWM model fast-forward sys clock cycles with a constant B input
+ * 
+ * @param pwm_model_t *m
+ * @param u_int64_t cycles
+ * @param bool b_in
+ * @return void
+ */
+void pwm_model_run(pwm_model_t *m, u_int64_t cycles, bool b_in)
+{
+    if (cycles == 0) {
+        return;
+    }
+
+    // edge modes only see an edge on the first cycle
+    if (m->divmode == PWM_MODEL_DIV_B_RISING || m->divmode == PWM_MODEL_DIV_B_FALLING) {
+        pwm_model_tick(m, b_in);
+        m->cycles += cycles - 1;
+        return;
+    }
+
+    m->b_last = b_in;
+    m->cycles += cycles;
+
+    if (!m->enabled || (m->divmode == PWM_MODEL_DIV_B_HIGH && !b_in)) {
+        return;
+    }
+
+    u_int64_t acc = m->frac + cycles * 16;
+
+    m->frac = acc % m->div;
+    pwm_model_count_n(m, acc / m->div);
+}
+
+/**
+ * PWM model get channel output level
+ * 
+ * @param pwm_model_t *m
+ * @param u_int8_t channel
+ * @return bool
+ */
+bool pwm_model_get_output(pwm_model_t *m, u_int8_t channel)
+{
+    channel &= 0x1;
+
+    // B is an input in the gated and edge counting modes
+    if (channel == PWM_MODEL_CHAN_B && m->divmode != PWM_MODEL_DIV_FREE_RUNNING) {
+        return false;
+    }
+
+    return (m->ctr < m->active.cc[channel]) != m->inv[channel];
+}
+
+/**
+ * PWM model get period in counter steps
+ * 
+ * @param pwm_model_t *m
+ * @return u_int32_t
+ */
+u_int32_t pwm_model_get_period_counts(pwm_model_t *m)
+{
+    return ((u_int32_t) m->active.top + 1) * (m->ph_correct ? 2 : 1);
+}
+
+/**
+ * PWM model get period in 1/16th sys clock cycles
+ * 
+ * @param pwm_model_t *m
+ * @return u_int64_t
+ */
+u_int64_t pwm_model_get_period_x16(pwm_model_t *m)
+{
+    return (u_int64_t) pwm_model_get_period_counts(m) * m->div;
+}
+
+/**
+ * PWM model get output frequency in mHz
+ * 
+ * @param pwm_model_t *m
+ * @param u_int32_t sys_hz
+ * @return u_int64_t
+ */
+u_int64_t pwm_model_get_freq_mhz(pwm_model_t *m, u_int32_t sys_hz)
+{
+    u_int64_t period = pwm_model_get_period_x16(m);
+
+    return ((u_int64_t) sys_hz * 16 * 1000 + period / 2) / period;
+}
+
+/**
+ * PWM model get channel duty cycle in ppm
+ * 
+ * @param pwm_model_t *m
+ * @param u_int8_t channel
+ * @return u_int32_t
+ */
+u_int32_t pwm_model_get_duty_ppm(pwm_model_t *m, u_int8_t channel)
+{
+    u_int32_t steps = (u_int32_t) m->active.top + 1;
+    u_int32_t high = m->active.cc[channel & 0x1];
+
+    if (high > steps) {
+        high = steps;
+    }
+
+    u_int32_t ppm = (u_int32_t) (((u_int64_t) high * 1000000 + steps / 2) / steps);
+
+    return m->inv[channel & 0x1] ? 1000000 - ppm : ppm;
+}
\ No newline at end of file
@@ -0,0 +1,208 @@
+#ifndef PWM_MODEL_H
+#define PWM_MODEL_H
+
+#include <stdbool.h>
+#include <sys/types.h>
+
+#define PWM_MODEL_CHAN_A 0
+#define PWM_MODEL_CHAN_B 1
+
+#define PWM_MODEL_DIV_FREE_RUNNING 0
+#define PWM_MODEL_DIV_B_HIGH 1
+#define PWM_MODEL_DIV_B_RISING 2
+#define PWM_MODEL_DIV_B_FALLING 3
+
+/**
+ * PWM model double buffered registers
+ * 
+ * @var pwm_model_buffer_t
+ */
+typedef struct {
+    u_int16_t top;
+    u_int16_t cc[2];
+} pwm_model_buffer_t;
+
+/**
+ * PWM model slice state
+ * 
+ * The divider is kept in 8.4 fixed point (1/16th of a sys clock cycle),
+ * TOP and CC are written to the pending buffer and latched into the
+ * active buffer when the counter wraps.
+ * 
+ * @var pwm_model_t
+ */
+typedef struct {
+    bool enabled;
+    bool ph_correct;
+    bool inv[2];
+    u_int8_t divmode;
+    u_int16_t div;
+    pwm_model_buffer_t pending;
+    pwm_model_buffer_t active;
+    u_int16_t ctr;
+    bool down;
+    u_int16_t frac;
+    bool b_last;
+    u_int64_t cycles;
+    u_int64_t wraps;
+} pwm_model_t;
+
+/**
+ * PWM model init (register reset values)
+ * 
+ * @param pwm_model_t *m
+ * @return void
+ */
+void pwm_model_init(pwm_model_t *m);
+
+/**
+ * PWM model load raw slice registers
+ * 
+ * @param pwm_model_t *m
+ * @param u_int32_t csr
+ * @param u_int32_t div
+ * @param u_int32_t ctr
+ * @param u_int32_t cc
+ * @param u_int32_t top
+ * @return void
+ */
+void pwm_model_load(pwm_model_t *m, u_int32_t csr, u_int32_t div, u_int32_t ctr, u_int32_t cc, u_int32_t top);
+
+/**
+ * PWM model set clock divider (8.4, integer 0 = 256)
+ * 
+ * @param pwm_model_t *m
+ * @param u_int8_t integer
+ * @param u_int8_t fract
+ * @return void
+ */
+void pwm_model_set_clkdiv_int_frac(pwm_model_t *m, u_int8_t integer, u_int8_t fract);
+
+/**
+ * PWM model set wrap (TOP)
+ * 
+ * @param pwm_model_t *m
+ * @param u_int16_t wrap
+ * @return void
+ */
+void pwm_model_set_wrap(pwm_model_t *m, u_int16_t wrap);
+
+/**
+ * PWM model set channel level (CC)
+ * 
+ * @param pwm_model_t *m
+ * @param u_int8_t channel
+ * @param u_int16_t level
+ * @return void
+ */
+void pwm_model_set_chan_level(pwm_model_t *m, u_int8_t channel, u_int16_t level);
+
+/**
+ * PWM model set phase correct mode
+ * 
+ * @param pwm_model_t *m
+ * @param bool ph_correct
+ * @return void
+ */
+void pwm_model_set_phase_correct(pwm_model_t *m, bool ph_correct);
+
+/**
+ * PWM model set output polarity
+ * 
+ * @param pwm_model_t *m
+ * @param bool inv_a
+ * @param bool inv_b
+ * @return void
+ */
+void pwm_model_set_output_polarity(pwm_model_t *m, bool inv_a, bool inv_b);
+
+/**
+ * PWM model set divider mode
+ * 
+ * @param pwm_model_t *m
+ * @param u_int8_t divmode
+ * @return void
+ */
+void pwm_model_set_clkdiv_mode(pwm_model_t *m, u_int8_t divmode);
+
+/**
+ * PWM model set counter
+ * 
+ * @param pwm_model_t *m
+ * @param u_int16_t ctr
+ * @return void
+ */
+void pwm_model_set_counter(pwm_model_t *m, u_int16_t ctr);
+
+/**
+ * PWM model set enabled
+ * 
+ * @param pwm_model_t *m
+ * @param bool enabled
+ * @return void
+ */
+void pwm_model_set_enabled(pwm_model_t *m, bool enabled);
+
+/**
+ * PWM model advance a single sys clock cycle
+ * 
+ * @param pwm_model_t *m
+ * @param bool b_in
+ * @return void
+ */
+void pwm_model_tick(pwm_model_t *m, bool b_in);
+
+/**
+ * PWM model fast-forward sys clock cycles with a constant B input
+ * 
+ * @param pwm_model_t *m
+ * @param u_int64_t cycles
+ * @param bool b_in
+ * @return void
+ */
+void pwm_model_run(pwm_model_t *m, u_int64_t cycles, bool b_in);
+
+/**
+ * PWM model get channel output level
+ * 
+ * @param pwm_model_t *m
+ * @param u_int8_t channel
+ * @return bool
+ */
+bool pwm_model_get_output(pwm_model_t *m, u_int8_t channel);
+
+/**
+ * PWM model get period in counter steps
+ * 
+ * @param pwm_model_t *m
+ * @return u_int32_t
+ */
+u_int32_t pwm_model_get_period_counts(pwm_model_t *m);
+
+/**
+ * PWM model get period in 1/16th sys clock cycles
+ * 
+ * @param pwm_model_t *m
+ * @return u_int64_t
+ */
+u_int64_t pwm_model_get_period_x16(pwm_model_t *m);
+
+/**
+ * PWM model get output frequency in mHz
+ * 
+ * @param pwm_model_t *m
+ * @param u_int32_t sys_hz
+ * @return u_int64_t
+ */
+u_int64_t pwm_model_get_freq_mhz(pwm_model_t *m, u_int32_t sys_hz);
+
+/**
+ * PWM model get channel duty cycle in ppm
+ * 
+ * @param pwm_model_t *m
+ * @param u_int8_t channel
+ * @return u_int32_t
+ */
+u_int32_t pwm_model_get_duty_ppm(pwm_model_t *m, u_int8_t channel);
+
+#endif
\ No newline at end of file
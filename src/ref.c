@@ -0,0 +1,295 @@
+#include "pico/stdlib.h"
+#include "hardware/irq.h"
+#include "hardware/pwm.h"
+#include "ref.h"
+
+/**
+ * Ref PWM slice counting the input edges (-1 when idle)
+ * 
+ * @var int
+ */
+static int ref_slice = -1;
+
+/**
+ * Ref input pin
+ * 
+ * @var u_int8_t
+ */
+static u_int8_t ref_pin = 0;
+
+/**
+ * Ref nominal frequency
+ * 
+ * @var u_int32_t
+ */
+static u_int32_t ref_nominal_hz = 0;
+
+/**
+ * Ref edges per counter wrap
+ * 
+ * @var u_int32_t
+ */
+static u_int32_t ref_edges_per_wrap = 1;
+
+/**
+ * Ref wraps seen
+ * 
+ * @var volatile u_int64_t
+ */
+static volatile u_int64_t ref_wraps = 0;
+
+/**
+ * Ref timestamp of the first wrap
+ * 
+ * @var volatile u_int64_t
+ */
+static volatile u_int64_t ref_first_us = 0;
+
+/**
+ * Ref timestamp of the last wrap
+ * 
+ * @var volatile u_int64_t
+ */
+static volatile u_int64_t ref_last_us = 0;
+
+/**
+ * Ref wrap interrupt handler
+ * 
+ * Every wrap lands on a reference edge, so its timestamp only carries
+ * the interrupt latency.
+ * 
+ * @return void
+ */
+static void ref_irq_handler()
+{
+    if (ref_slice < 0 || !(pwm_get_irq_status_mask() & (1u << ref_slice))) {
+        return;
+    }
+
+    pwm_clear_irq(ref_slice);
+
+    u_int64_t now = time_us_64();
+
+    if (ref_wraps == 0) {
+        ref_first_us = now;
+    }
+
+    ref_last_us = now;
+    ref_wraps++;
+}
+
+/**
+ * Ref start measuring a reference clock on a PWM B pin
+ * 
+ * The slice counts rising edges on its B input, with the divider and
+ * wrap set for about REF_IRQ_HZ wraps per second (one per edge for a
+ * 1PPS input). The wrap interrupt runs above the timer callbacks so a
+ * busy console does not delay the timestamps.
+ * 
+ * @param u_int8_t pin
+ * @param u_int32_t nominal_hz
+ * @return bool
+ */
+bool ref_start(u_int8_t pin, u_int32_t nominal_hz)
+{
+    if (ref_is_active() || pwm_gpio_to_channel(pin) != PWM_CHAN_B || nominal_hz == 0 || nominal_hz > REF_HZ_MAX) {
+        return false;
+    }
+
+    u_int32_t edges = nominal_hz / REF_IRQ_HZ;
+    edges = edges < 1 ? 1 : edges;
+
+    u_int32_t div = (edges + 65535) / 65536;
+    u_int32_t wrap = edges / div;
+
+    ref_slice = pwm_gpio_to_slice_num(pin);
+    ref_pin = pin;
+    ref_nominal_hz = nominal_hz;
+    ref_edges_per_wrap = div * wrap;
+    ref_wraps = 0;
+
+    pwm_config config = pwm_get_default_config();
+    pwm_config_set_clkdiv_mode(&config, PWM_DIV_B_RISING);
+    pwm_config_set_clkdiv_int(&config, div);
+    pwm_config_set_wrap(&config, wrap - 1);
+    pwm_init(ref_slice, &config, false);
+
+    gpio_set_function(pin, GPIO_FUNC_PWM);
+
+    pwm_clear_irq(ref_slice);
+    pwm_set_irq_enabled(ref_slice, true);
+    irq_add_shared_handler(PWM_IRQ_WRAP, ref_irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_priority(PWM_IRQ_WRAP, PICO_HIGHEST_IRQ_PRIORITY);
+    irq_set_enabled(PWM_IRQ_WRAP, true);
+
+    pwm_set_enabled(ref_slice, true);
+
+    return true;
+}
+
+/**
+ * Ref stop
+ * 
+ * @return void
+ */
+void ref_stop()
+{
+    if (!ref_is_active()) {
+        return;
+    }
+
+    pwm_set_enabled(ref_slice, false);
+    pwm_set_irq_enabled(ref_slice, false);
+    pwm_clear_irq(ref_slice);
+
+    irq_set_enabled(PWM_IRQ_WRAP, false);
+    irq_remove_handler(PWM_IRQ_WRAP, ref_irq_handler);
+
+    gpio_set_function(ref_pin, GPIO_FUNC_NULL);
+
+    ref_slice = -1;
+}
+
+/**
+ * Ref restart the measurement window at the next edge
+ * 
+ * @return void
+ */
+void ref_reset()
+{
+    u_int32_t status = save_and_disable_interrupts();
+    ref_wraps = 0;
+    restore_interrupts(status);
+}
+
+/**
+ * Ref owns a PWM slice
+ * 
+ * @return bool
+ */
+bool ref_is_active()
+{
+    return ref_slice >= 0;
+}
+
+/**
+ * Ref input has edges within the timeout
+ * 
+ * @return bool
+ */
+bool ref_has_signal()
+{
+    return ref_is_active() && ref_wraps > 0 && time_us_64() - ref_last_us < REF_TIMEOUT_US;
+}
+
+/**
+ * Ref get input pin
+ * 
+ * @return u_int8_t
+ */
+u_int8_t ref_get_pin()
+{
+    return ref_pin;
+}
+
+/**
+ * Ref get nominal frequency
+ * 
+ * @return u_int32_t
+ */
+u_int32_t ref_get_nominal_hz()
+{
+    return ref_nominal_hz;
+}
+
+/**
+ * Ref get edges counted and the timestamp of the last counted edge
+ * 
+ * Counting starts at the first wrap, so the edges before it are not
+ * included.
+ * 
+ * @param u_int64_t *edges
+ * @param u_int64_t *us
+ * @return bool
+ */
+bool ref_get_snapshot(u_int64_t *edges, u_int64_t *us)
+{
+    u_int32_t status = save_and_disable_interrupts();
+    u_int64_t wraps = ref_wraps;
+    *us = ref_last_us;
+    restore_interrupts(status);
+
+    if (!ref_is_active() || wraps == 0) {
+        return false;
+    }
+
+    *edges = (wraps - 1) * ref_edges_per_wrap;
+
+    return true;
+}
+
+/**
+ * Ref get measurement window since the start in microseconds
+ * 
+ * @return u_int64_t
+ */
+u_int64_t ref_get_window_us()
+{
+    u_int64_t edges, us;
+
+    if (!ref_get_snapshot(&edges, &us)) {
+        return 0;
+    }
+
+    return us - ref_first_us;
+}
+
+/**
+ * Ref get frequency measured since the start
+ * 
+ * @param u_int64_t *mhz
+ * @return bool
+ */
+bool ref_get_freq_mhz(u_int64_t *mhz)
+{
+    u_int64_t edges, us;
+
+    if (!ref_get_snapshot(&edges, &us) || edges == 0) {
+        return false;
+    }
+
+    // whole hertz first so long windows do not overflow
+    u_int64_t window_us = us - ref_first_us;
+    u_int64_t scaled = edges * 1000000;
+
+    *mhz = scaled / window_us * 1000 + scaled % window_us * 1000 / window_us;
+
+    return true;
+}
+
+/**
+ * Ref get offset from the nominal frequency since the start
+ * 
+ * Positive when the reference counts fast against the board, which
+ * means the board's crystal is slow.
+ * 
+ * @param int64_t *ppb
+ * @return bool
+ */
+bool ref_get_error_ppb(int64_t *ppb)
+{
+    u_int64_t edges, us;
+
+    if (!ref_get_snapshot(&edges, &us) || edges == 0) {
+        return false;
+    }
+
+    // difference in edges scaled by a million, kept small before the ppb
+    // scaling so it fits 64 bits for windows of hours at 10MHz
+    int64_t expected = (int64_t) ((us - ref_first_us) * ref_nominal_hz);
+    int64_t diff = (int64_t) (edges * 1000000) - expected;
+
+    *ppb = diff * 1000000 / (expected / 1000);
+
+    return true;
+}
@@ -0,0 +1,101 @@
+#ifndef REF_H
+#define REF_H
+
+#include <stdbool.h>
+#include <sys/types.h>
+
+// wrap interrupts per second on a fast reference
+#define REF_IRQ_HZ 100
+
+#define REF_HZ_MAX 25000000
+
+// no reference edge for this long means the signal is gone
+#define REF_TIMEOUT_US 2000000
+
+/**
+ * Ref start measuring a reference clock on a PWM B pin
+ * 
+ * @param u_int8_t pin
+ * @param u_int32_t nominal_hz
+ * @return bool
+ */
+bool ref_start(u_int8_t pin, u_int32_t nominal_hz);
+
+/**
+ * Ref stop
+ * 
+ * @return void
+ */
+void ref_stop();
+
+/**
+ * Ref restart the measurement window at the next edge
+ * 
+ * @return void
+ */
+void ref_reset();
+
+/**
+ * Ref owns a PWM slice
+ * 
+ * @return bool
+ */
+bool ref_is_active();
+
+/**
+ * Ref input has edges within the timeout
+ * 
+ * @return bool
+ */
+bool ref_has_signal();
+
+/**
+ * Ref get input pin
+ * 
+ * @return u_int8_t
+ */
+u_int8_t ref_get_pin();
+
+/**
+ * Ref get nominal frequency
+ * 
+ * @return u_int32_t
+ */
+u_int32_t ref_get_nominal_hz();
+
+/**
+ * Ref get edges counted and the timestamp of the last counted edge
+ * 
+ * The difference between two snapshots measures the reference over that
+ * interval against the board's own timebase.
+ * 
+ * @param u_int64_t *edges
+ * @param u_int64_t *us
+ * @return bool
+ */
+bool ref_get_snapshot(u_int64_t *edges, u_int64_t *us);
+
+/**
+ * Ref get frequency measured since the start
+ * 
+ * @param u_int64_t *mhz
+ * @return bool
+ */
+bool ref_get_freq_mhz(u_int64_t *mhz);
+
+/**
+ * Ref get offset from the nominal frequency since the start
+ * 
+ * @param int64_t *ppb
+ * @return bool
+ */
+bool ref_get_error_ppb(int64_t *ppb);
+
+/**
+ * Ref get measurement window since the start in microseconds
+ * 
+ * @return u_int64_t
+ */
+u_int64_t ref_get_window_us();
+
+#endif
@@ -0,0 +1,224 @@
+#include "pico/stdlib.h"
+#include "hardware/dma.h"
+#include "hardware/pwm.h"
+#include "plan.h"
+#include "spread.h"
+
+/**
+ * Spread profile names
+ * 
+ * @var const char *[]
+ */
+static const char *spread_profile_names[] = { "triangle", "kiss" };
+
+/**
+ * Spread TOP value per output period over one modulation cycle
+ * 
+ * @var u_int32_t[]
+ */
+static u_int32_t spread_table[SPREAD_TABLE_MAX];
+
+/**
+ * Spread table start (read by the restart channel)
+ * 
+ * @var const u_int32_t *
+ */
+static const u_int32_t *spread_table_start = spread_table;
+
+/**
+ * Spread table length
+ * 
+ * @var u_int32_t
+ */
+static u_int32_t spread_count = 0;
+
+/**
+ * Spread centre TOP value
+ * 
+ * @var u_int32_t
+ */
+static u_int32_t spread_top = 0;
+
+/**
+ * Spread modulated slice (-1 when idle)
+ * 
+ * @var int
+ */
+static int spread_slice = -1;
+
+/**
+ * Spread DMA data channel
+ * 
+ * @var int
+ */
+static int spread_data_chan = -1;
+
+/**
+ * Spread DMA restart channel
+ * 
+ * @var int
+ */
+static int spread_ctrl_chan = -1;
+
+/**
+ * Spread get profile deviation for a phase in Q16
+ * 
+ * The phase runs -1 .. 1 .. -1 over the cycle. The kiss profile is a
+ * cubic approximation of the Hershey-kiss: it moves faster near the
+ * extremes, which flattens the horns a triangle leaves at the band
+ * edges.
+ * 
+ * @param u_int32_t i
+ * @param u_int32_t count
+ * @param u_int8_t profile
+ * @return int32_t
+ */
+static int32_t spread_get_deviation(u_int32_t i, u_int32_t count, u_int8_t profile)
+{
+    int64_t x = (int64_t) i * 4 * 65536 / count;
+    x = x < 2 * 65536 ? x - 65536 : 3 * 65536 - x;
+
+    if (profile == SPREAD_KISS) {
+        x = (x + x * x / 65536 * x / 65536) / 2;
+    }
+
+    return x;
+}
+
+/**
+ * Spread start modulating a running PWM slice's wrap
+ * 
+ * TOP is double buffered, so each entry written after a wrap takes
+ * effect on the following one. CC stays at the centre level, so the
+ * duty cycle moves by about the spread depth.
+ * 
+ * @param u_int8_t slice_num
+ * @param u_int32_t period
+ * @param u_int32_t periods
+ * @param u_int32_t depth_ppm
+ * @param u_int8_t profile
+ * @return bool
+ */
+bool spread_start(u_int8_t slice_num, u_int32_t period, u_int32_t periods, u_int32_t depth_ppm, u_int8_t profile)
+{
+    if (spread_slice >= 0 || periods < SPREAD_TABLE_MIN || periods > SPREAD_TABLE_MAX || depth_ppm > SPREAD_DEPTH_MAX_PPM) {
+        return false;
+    }
+
+    for (u_int32_t i = 0; i < periods; i++) {
+        int64_t dev = (int64_t) period * depth_ppm * spread_get_deviation(i, periods, profile) / 65536;
+        int64_t entry = ((int64_t) period * 1000000 + dev + 500000) / 1000000;
+
+        if (entry < 1) {
+            entry = 1;
+        }
+
+        if (entry > PLAN_PERIOD_MAX) {
+            entry = PLAN_PERIOD_MAX;
+        }
+
+        spread_table[i] = entry - 1;
+    }
+
+    spread_count = periods;
+    spread_top = period - 1;
+    spread_slice = slice_num;
+
+    spread_data_chan = dma_claim_unused_channel(true);
+    spread_ctrl_chan = dma_claim_unused_channel(true);
+
+    // one TOP value per counter wrap
+    dma_channel_config data = dma_channel_get_default_config(spread_data_chan);
+    channel_config_set_transfer_data_size(&data, DMA_SIZE_32);
+    channel_config_set_read_increment(&data, true);
+    channel_config_set_write_increment(&data, false);
+    channel_config_set_dreq(&data, pwm_get_dreq(slice_num));
+    channel_config_set_chain_to(&data, spread_ctrl_chan);
+
+    dma_channel_configure(spread_data_chan, &data, &pwm_hw->slice[slice_num].top, spread_table, periods, false);
+
+    // re-arm the data channel at the start of the table
+    dma_channel_config ctrl = dma_channel_get_default_config(spread_ctrl_chan);
+    channel_config_set_transfer_data_size(&ctrl, DMA_SIZE_32);
+    channel_config_set_read_increment(&ctrl, false);
+    channel_config_set_write_increment(&ctrl, false);
+
+    dma_channel_configure(spread_ctrl_chan, &ctrl, &dma_hw->ch[spread_data_chan].al3_read_addr_trig, &spread_table_start, 1, true);
+
+    return true;
+}
+
+/**
+ * Spread stop and restore the centre wrap
+ * 
+ * Both channels are disabled before the abort so a chain trigger raised
+ * by the abort cannot restart the other one.
+ * 
+ * @return void
+ */
+void spread_stop()
+{
+    if (spread_slice < 0) {
+        return;
+    }
+
+    u_int32_t mask = (1u << spread_ctrl_chan) | (1u << spread_data_chan);
+
+    hw_clear_bits(&dma_hw->ch[spread_ctrl_chan].al1_ctrl, DMA_CH0_CTRL_TRIG_EN_BITS);
+    hw_clear_bits(&dma_hw->ch[spread_data_chan].al1_ctrl, DMA_CH0_CTRL_TRIG_EN_BITS);
+
+    dma_hw->abort = mask;
+    while (dma_hw->abort & mask) {
+        tight_loop_contents();
+    }
+
+    dma_channel_unclaim(spread_ctrl_chan);
+    dma_channel_unclaim(spread_data_chan);
+
+    pwm_set_wrap(spread_slice, spread_top);
+
+    spread_ctrl_chan = -1;
+    spread_data_chan = -1;
+    spread_slice = -1;
+}
+
+/**
+ * Spread get modulated slice (-1 when idle)
+ * 
+ * @return int
+ */
+int spread_get_slice()
+{
+    return spread_slice;
+}
+
+/**
+ * Spread get shortest and longest period in the table
+ * 
+ * @param u_int32_t *min_period
+ * @param u_int32_t *max_period
+ * @return void
+ */
+void spread_get_range(u_int32_t *min_period, u_int32_t *max_period)
+{
+    *min_period = PLAN_PERIOD_MAX;
+    *max_period = 0;
+
+    for (u_int32_t i = 0; i < spread_count; i++) {
+        u_int32_t period = spread_table[i] + 1;
+
+        *min_period = period < *min_period ? period : *min_period;
+        *max_period = period > *max_period ? period : *max_period;
+    }
+}
+
+/**
+ * Spread get profile name
+ * 
+ * @param u_int8_t profile
+ * @return const char *
+ */
+const char *spread_get_profile_name(u_int8_t profile)
+{
+    return profile <= SPREAD_KISS ? spread_profile_names[profile] : "?";
+}
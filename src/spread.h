@@ -0,0 +1,63 @@
+#ifndef SPREAD_H
+#define SPREAD_H
+
+#include <stdbool.h>
+#include <sys/types.h>
+
+#ifndef SPREAD_TABLE_MAX
+#define SPREAD_TABLE_MAX 1024
+#endif
+
+#define SPREAD_TABLE_MIN 4
+#define SPREAD_DEPTH_MAX_PPM 20000
+
+#define SPREAD_TRIANGLE 0
+#define SPREAD_KISS 1
+
+/**
+ * Spread start modulating a running PWM slice's wrap
+ * 
+ * One table entry per output period, so a modulation cycle is
+ * `periods` long and the table is replayed by DMA on every wrap.
+ * 
+ * @param u_int8_t slice_num
+ * @param u_int32_t period
+ * @param u_int32_t periods
+ * @param u_int32_t depth_ppm
+ * @param u_int8_t profile
+ * @return bool
+ */
+bool spread_start(u_int8_t slice_num, u_int32_t period, u_int32_t periods, u_int32_t depth_ppm, u_int8_t profile);
+
+/**
+ * Spread stop and restore the centre wrap
+ * 
+ * @return void
+ */
+void spread_stop();
+
+/**
+ * Spread get modulated slice (-1 when idle)
+ * 
+ * @return int
+ */
+int spread_get_slice();
+
+/**
+ * Spread get shortest and longest period in the table
+ * 
+ * @param u_int32_t *min_period
+ * @param u_int32_t *max_period
+ * @return void
+ */
+void spread_get_range(u_int32_t *min_period, u_int32_t *max_period);
+
+/**
+ * Spread get profile name
+ * 
+ * @param u_int8_t profile
+ * @return const char *
+ */
+const char *spread_get_profile_name(u_int8_t profile);
+
+#endif
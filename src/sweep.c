@@ -0,0 +1,532 @@
+#include "pico/stdlib.h"
+#include "hardware/dma.h"
+#include "hardware/pwm.h"
+#include "plan.h"
+#include "sweep.h"
+
+/**
+ * Sweep DMA control block type
+ * 
+ * Written by the control channel over the data channel's first register
+ * alias (READ_ADDR, WRITE_ADDR, TRANS_COUNT, CTRL_TRIG), so loading a
+ * block also starts it. A block of zeroes is a null trigger and ends
+ * the chain.
+ * 
+ * @var sweep_block_t
+ */
+typedef struct {
+    const volatile void *read_addr;
+    volatile void *write_addr;
+    u_int32_t transfer_count;
+    u_int32_t ctrl;
+} sweep_block_t;
+
+/**
+ * Sweep 2^(2^-k) for k = 1..16 in Q31
+ * 
+ * @var const u_int32_t[]
+ */
+static const u_int32_t sweep_exp2_table[16] = {
+    3037000500u, 2553802834u, 2341847524u, 2242560872u,
+    2194507417u, 2170868212u, 2159144272u, 2153306067u,
+    2150392887u, 2148937775u, 2148210589u, 2147847087u,
+    2147665360u, 2147574502u, 2147529075u, 2147506361u,
+};
+
+/**
+ * Sweep step frequencies in mHz
+ * 
+ * @var u_int64_t[]
+ */
+static u_int64_t sweep_freq_mhz[SWEEP_STEPS_MAX];
+
+/**
+ * Sweep step count
+ * 
+ * @var u_int16_t
+ */
+static u_int16_t sweep_count = 0;
+
+/**
+ * Sweep type
+ * 
+ * @var u_int8_t
+ */
+static u_int8_t sweep_type = SWEEP_LINEAR;
+
+/**
+ * Sweep dwell time per step in ms
+ * 
+ * @var u_int32_t
+ */
+static u_int32_t sweep_dwell_ms = 0;
+
+/**
+ * Sweep loop mode
+ * 
+ * @var bool
+ */
+static bool sweep_loop = false;
+
+/**
+ * Sweep shared PWM divider (8.4 fixed point)
+ * 
+ * @var u_int16_t
+ */
+static u_int16_t sweep_div = 0;
+
+/**
+ * Sweep CC and TOP register values per step (adjacent in the slice)
+ * 
+ * @var u_int32_t[][]
+ */
+static u_int32_t sweep_regs[SWEEP_STEPS_MAX][2];
+
+/**
+ * Sweep control blocks, two per step plus the end or loop block
+ * 
+ * @var sweep_block_t[]
+ */
+static sweep_block_t sweep_blocks[SWEEP_STEPS_MAX * 2 + 1];
+
+/**
+ * Sweep control block list start (read by the loop block)
+ * 
+ * @var const sweep_block_t *
+ */
+static const sweep_block_t *sweep_blocks_start = sweep_blocks;
+
+/**
+ * Sweep dwell counter source and sink
+ * 
+ * @var u_int32_t
+ */
+static u_int32_t sweep_sink = 0;
+
+/**
+ * Sweep DMA control channel (-1 when idle)
+ * 
+ * @var int
+ */
+static int sweep_ctrl_chan = -1;
+
+/**
+ * Sweep DMA data channel (-1 when idle)
+ * 
+ * @var int
+ */
+static int sweep_data_chan = -1;
+
+/**
+ * Sweep integer log2 in Q16
+ * 
+ * @param u_int64_t x
+ * @return u_int32_t
+ */
+static u_int32_t sweep_log2_q16(u_int64_t x)
+{
+    u_int32_t exp = 63 - __builtin_clzll(x);
+    u_int32_t result = exp << 16;
+
+    // mantissa in [1, 2) as Q31, squared once per fraction bit
+    u_int64_t m = exp > 31 ? x >> (exp - 31) : x << (31 - exp);
+
+    for (u_int32_t bit = 1 << 15; bit; bit >>= 1) {
+        m = (m * m) >> 31;
+
+        if (m >= (1ULL << 32)) {
+            m >>= 1;
+            result |= bit;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Sweep integer 2^x for x in Q16
+ * 
+ * @param u_int32_t x
+ * @return u_int64_t
+ */
+static u_int64_t sweep_exp2_q16(u_int32_t x)
+{
+    u_int32_t exp = x >> 16;
+    u_int64_t m = 1ULL << 31;
+
+    for (u_int8_t k = 0; k < 16; k++) {
+        if (x & (1 << (15 - k))) {
+            m = (m * sweep_exp2_table[k] + (1ULL << 30)) >> 31;
+        }
+    }
+
+    return exp >= 31 ? m << (exp - 31) : (m + (1ULL << (30 - exp))) >> (31 - exp);
+}
+
+/**
+ * Sweep interpolate point i of n over a linear or logarithmic range
+ * 
+ * Logarithmic points are interpolated in Q16 log2, within a few tens of
+ * ppm of the exact geometric series, with both ends exact.
+ * 
+ * @param u_int8_t type
+ * @param u_int64_t start_mhz
+ * @param u_int64_t stop_mhz
+ * @param u_int16_t i
+ * @param u_int16_t count
+ * @return u_int64_t
+ */
+u_int64_t sweep_interpolate(u_int8_t type, u_int64_t start_mhz, u_int64_t stop_mhz, u_int16_t i, u_int16_t count)
+{
+    if (i == 0) {
+        return start_mhz;
+    }
+
+    if (i >= count - 1) {
+        return stop_mhz;
+    }
+
+    if (type == SWEEP_LOG) {
+        int64_t log_start = sweep_log2_q16(start_mhz);
+        int64_t log_stop = sweep_log2_q16(stop_mhz);
+
+        return sweep_exp2_q16(log_start + (log_stop - log_start) * i / (count - 1));
+    }
+
+    return start_mhz + ((int64_t) stop_mhz - (int64_t) start_mhz) * i / (count - 1);
+}
+
+/**
+ * Sweep set linear or logarithmic range (both ends included)
+ * 
+ * @param u_int8_t type
+ * @param u_int64_t start_mhz
+ * @param u_int64_t stop_mhz
+ * @param u_int16_t steps
+ * @return bool
+ */
+bool sweep_set_range(u_int8_t type, u_int64_t start_mhz, u_int64_t stop_mhz, u_int16_t steps)
+{
+    if (sweep_is_active() || steps < 2 || steps > SWEEP_STEPS_MAX || start_mhz == 0 || stop_mhz == 0) {
+        return false;
+    }
+
+    for (u_int16_t i = 0; i < steps; i++) {
+        sweep_freq_mhz[i] = sweep_interpolate(type, start_mhz, stop_mhz, i, steps);
+    }
+
+    sweep_count = steps;
+    sweep_type = type;
+
+    return true;
+}
+
+/**
+ * Sweep set step list
+ * 
+ * @param const u_int64_t *mhz
+ * @param u_int16_t count
+ * @return bool
+ */
+bool sweep_set_list(const u_int64_t *mhz, u_int16_t count)
+{
+    if (sweep_is_active() || count == 0 || count > SWEEP_STEPS_MAX) {
+        return false;
+    }
+
+    for (u_int16_t i = 0; i < count; i++) {
+        if (mhz[i] == 0) {
+            return false;
+        }
+
+        sweep_freq_mhz[i] = mhz[i];
+    }
+
+    sweep_count = count;
+    sweep_type = SWEEP_LIST;
+
+    return true;
+}
+
+/**
+ * Sweep get type
+ * 
+ * @return u_int8_t
+ */
+u_int8_t sweep_get_type()
+{
+    return sweep_type;
+}
+
+/**
+ * Sweep get step count
+ * 
+ * @return u_int16_t
+ */
+u_int16_t sweep_get_count()
+{
+    return sweep_count;
+}
+
+/**
+ * Sweep get step frequency in mHz
+ * 
+ * @param u_int16_t step
+ * @return u_int64_t
+ */
+u_int64_t sweep_get_freq_mhz(u_int16_t step)
+{
+    return step < sweep_count ? sweep_freq_mhz[step] : 0;
+}
+
+/**
+ * Sweep get dwell time per step in ms
+ * 
+ * @return u_int32_t
+ */
+u_int32_t sweep_get_dwell_ms()
+{
+    return sweep_dwell_ms;
+}
+
+/**
+ * Sweep get loop mode
+ * 
+ * @return bool
+ */
+bool sweep_get_loop()
+{
+    return sweep_loop;
+}
+
+/**
+ * Sweep get shared PWM divider (8.4 fixed point)
+ * 
+ * @return u_int16_t
+ */
+u_int16_t sweep_get_div()
+{
+    return sweep_div;
+}
+
+/**
+ * Sweep set a control block
+ * 
+ * @param sweep_block_t *block
+ * @param const volatile void *read_addr
+ * @param volatile void *write_addr
+ * @param u_int32_t transfer_count
+ * @param u_int32_t ctrl
+ * @return void
+ */
+static void sweep_set_block(sweep_block_t *block, const volatile void *read_addr, volatile void *write_addr, u_int32_t transfer_count, u_int32_t ctrl)
+{
+    block->read_addr = read_addr;
+    block->write_addr = write_addr;
+    block->transfer_count = transfer_count;
+    block->ctrl = ctrl;
+}
+
+/**
+ * Sweep start on a PWM slice
+ * 
+ * The divider is shared by all steps, the smallest one that fits the
+ * lowest step into the 16-bit counter, so only TOP and CC change and
+ * each step is a single double-buffered register pair.
+ * 
+ * Per step the control channel loads two blocks into the data channel:
+ * an unpaced copy of CC/TOP, which latches at the next wrap, then a
+ * dummy transfer paced by the slice's wrap DREQ that counts the dwell
+ * in whole periods. The last block either ends the chain or points the
+ * control channel back at the start of the list.
+ * 
+ * @param u_int8_t slice_num
+ * @param u_int32_t sys_hz
+ * @param u_int32_t duty_ppm
+ * @param bool ph_correct
+ * @param u_int32_t dwell_ms
+ * @param bool loop
+ * @return bool
+ */
+bool sweep_start(u_int8_t slice_num, u_int32_t sys_hz, u_int32_t duty_ppm, bool ph_correct, u_int32_t dwell_ms, bool loop)
+{
+    if (sweep_is_active() || sweep_count == 0 || dwell_ms == 0) {
+        return false;
+    }
+
+    u_int64_t min_mhz = sweep_freq_mhz[0];
+    for (u_int16_t i = 1; i < sweep_count; i++) {
+        if (sweep_freq_mhz[i] < min_mhz) {
+            min_mhz = sweep_freq_mhz[i];
+        }
+    }
+
+    // output period in 1/16th sys clock cycles is target / mhz
+    u_int64_t target = (u_int64_t) sys_hz * 16 * 1000 / (ph_correct ? 2 : 1);
+    u_int64_t div = (target + min_mhz * PLAN_PERIOD_MAX - 1) / (min_mhz * PLAN_PERIOD_MAX);
+
+    if (div < PLAN_DIV_MIN) {
+        div = PLAN_DIV_MIN;
+    }
+
+    if (div > PLAN_DIV_MAX) {
+        return false;
+    }
+
+    for (u_int16_t i = 0; i < sweep_count; i++) {
+        u_int64_t period = (target + div * sweep_freq_mhz[i] / 2) / (div * sweep_freq_mhz[i]);
+
+        // the highest step must still leave a toggling counter period
+        if (period < PLAN_PERIOD_MIN) {
+            return false;
+        }
+
+        plan_t plan = { .top = period - 1 };
+        u_int16_t level = plan_get_level(&plan, duty_ppm);
+
+        sweep_regs[i][0] = ((u_int32_t) level << PWM_CH0_CC_B_LSB) | level;
+        sweep_regs[i][1] = plan.top;
+    }
+
+    sweep_ctrl_chan = dma_claim_unused_channel(true);
+    sweep_data_chan = dma_claim_unused_channel(true);
+
+    pwm_slice_hw_t *slice = &pwm_hw->slice[slice_num];
+
+    // CC/TOP copy, unpaced
+    dma_channel_config copy = dma_channel_get_default_config(sweep_data_chan);
+    channel_config_set_transfer_data_size(&copy, DMA_SIZE_32);
+    channel_config_set_read_increment(&copy, true);
+    channel_config_set_write_increment(&copy, true);
+    channel_config_set_chain_to(&copy, sweep_ctrl_chan);
+
+    // dwell, one transfer per counter wrap
+    dma_channel_config dwell = dma_channel_get_default_config(sweep_data_chan);
+    channel_config_set_transfer_data_size(&dwell, DMA_SIZE_32);
+    channel_config_set_read_increment(&dwell, false);
+    channel_config_set_write_increment(&dwell, false);
+    channel_config_set_dreq(&dwell, pwm_get_dreq(slice_num));
+    channel_config_set_chain_to(&dwell, sweep_ctrl_chan);
+
+    // restart, chaining to itself means no chain
+    dma_channel_config restart = dma_channel_get_default_config(sweep_data_chan);
+    channel_config_set_transfer_data_size(&restart, DMA_SIZE_32);
+    channel_config_set_read_increment(&restart, false);
+    channel_config_set_write_increment(&restart, false);
+
+    sweep_block_t *block = sweep_blocks;
+    for (u_int16_t i = 0; i < sweep_count; i++) {
+        u_int64_t periods = ((u_int64_t) dwell_ms * sweep_freq_mhz[i] + 500000) / 1000000;
+
+        if (periods < 1) {
+            periods = 1;
+        }
+
+        if (periods > UINT32_MAX) {
+            periods = UINT32_MAX;
+        }
+
+        sweep_set_block(block++, sweep_regs[i], &slice->cc, 2, channel_config_get_ctrl_value(&copy));
+        sweep_set_block(block++, &sweep_sink, &sweep_sink, periods, channel_config_get_ctrl_value(&dwell));
+    }
+
+    if (loop) {
+        sweep_set_block(block, &sweep_blocks_start, &dma_hw->ch[sweep_ctrl_chan].al3_read_addr_trig, 1, channel_config_get_ctrl_value(&restart));
+    } else {
+        sweep_set_block(block, NULL, NULL, 0, 0);
+    }
+
+    // the control channel writes one block per trigger into the data channel
+    dma_channel_config ctrl = dma_channel_get_default_config(sweep_ctrl_chan);
+    channel_config_set_transfer_data_size(&ctrl, DMA_SIZE_32);
+    channel_config_set_read_increment(&ctrl, true);
+    channel_config_set_write_increment(&ctrl, true);
+    channel_config_set_ring(&ctrl, true, 4);
+
+    // first step is programmed directly so the slice starts on it
+    pwm_set_enabled(slice_num, false);
+    pwm_set_clkdiv_int_frac(slice_num, div >> 4, div & 0xf);
+    slice->cc = sweep_regs[0][0];
+    slice->top = sweep_regs[0][1];
+    pwm_set_counter(slice_num, 0);
+    pwm_set_enabled(slice_num, true);
+
+    sweep_div = div;
+    sweep_dwell_ms = dwell_ms;
+    sweep_loop = loop;
+
+    dma_channel_configure(sweep_ctrl_chan, &ctrl, &dma_hw->ch[sweep_data_chan].read_addr, sweep_blocks, 4, true);
+
+    return true;
+}
+
+/**
+ * Sweep stop (the slice keeps the last step)
+ * 
+ * Both channels are disabled before the abort so a chain trigger raised
+ * by the abort cannot restart the other one.
+ * 
+ * @return void
+ */
+void sweep_stop()
+{
+    if (!sweep_is_active()) {
+        return;
+    }
+
+    u_int32_t mask = (1u << sweep_ctrl_chan) | (1u << sweep_data_chan);
+
+    hw_clear_bits(&dma_hw->ch[sweep_ctrl_chan].al1_ctrl, DMA_CH0_CTRL_TRIG_EN_BITS);
+    hw_clear_bits(&dma_hw->ch[sweep_data_chan].al1_ctrl, DMA_CH0_CTRL_TRIG_EN_BITS);
+
+    dma_hw->abort = mask;
+    while (dma_hw->abort & mask) {
+        tight_loop_contents();
+    }
+
+    dma_channel_unclaim(sweep_ctrl_chan);
+    dma_channel_unclaim(sweep_data_chan);
+
+    sweep_ctrl_chan = -1;
+    sweep_data_chan = -1;
+}
+
+/**
+ * Sweep owns the DMA channels
+ * 
+ * @return bool
+ */
+bool sweep_is_active()
+{
+    return sweep_ctrl_chan >= 0;
+}
+
+/**
+ * Sweep still stepping
+ * 
+ * @return bool
+ */
+bool sweep_is_running()
+{
+    return sweep_is_active() && (dma_channel_is_busy(sweep_ctrl_chan) || dma_channel_is_busy(sweep_data_chan));
+}
+
+/**
+ * Sweep get current step
+ * 
+ * The control channel's read address points past the last block it
+ * loaded, two blocks per step.
+ * 
+ * @return u_int16_t
+ */
+u_int16_t sweep_get_step()
+{
+    if (!sweep_is_active()) {
+        return 0;
+    }
+
+    u_int32_t loaded = ((uintptr_t) dma_hw->ch[sweep_ctrl_chan].read_addr - (uintptr_t) sweep_blocks) / sizeof(sweep_block_t);
+    u_int16_t step = loaded > 0 ? (loaded - 1) / 2 : 0;
+
+    return step < sweep_count ? step : sweep_count - 1;
+}
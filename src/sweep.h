@@ -0,0 +1,135 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <stdbool.h>
+#include <sys/types.h>
+
+#ifndef SWEEP_STEPS_MAX
+#define SWEEP_STEPS_MAX 256
+#endif
+
+#define SWEEP_LINEAR 0
+#define SWEEP_LOG 1
+#define SWEEP_LIST 2
+
+/**
+ * Sweep interpolate point i of n over a linear or logarithmic range
+ * 
+ * @param u_int8_t type
+ * @param u_int64_t start_mhz
+ * @param u_int64_t stop_mhz
+ * @param u_int16_t i
+ * @param u_int16_t count
+ * @return u_int64_t
+ */
+u_int64_t sweep_interpolate(u_int8_t type, u_int64_t start_mhz, u_int64_t stop_mhz, u_int16_t i, u_int16_t count);
+
+/**
+ * Sweep set linear or logarithmic range (both ends included)
+ * 
+ * @param u_int8_t type
+ * @param u_int64_t start_mhz
+ * @param u_int64_t stop_mhz
+ * @param u_int16_t steps
+ * @return bool
+ */
+bool sweep_set_range(u_int8_t type, u_int64_t start_mhz, u_int64_t stop_mhz, u_int16_t steps);
+
+/**
+ * Sweep set step list
+ * 
+ * @param const u_int64_t *mhz
+ * @param u_int16_t count
+ * @return bool
+ */
+bool sweep_set_list(const u_int64_t *mhz, u_int16_t count);
+
+/**
+ * Sweep get type
+ * 
+ * @return u_int8_t
+ */
+u_int8_t sweep_get_type();
+
+/**
+ * Sweep get step count
+ * 
+ * @return u_int16_t
+ */
+u_int16_t sweep_get_count();
+
+/**
+ * Sweep get step frequency in mHz
+ * 
+ * @param u_int16_t step
+ * @return u_int64_t
+ */
+u_int64_t sweep_get_freq_mhz(u_int16_t step);
+
+/**
+ * Sweep get dwell time per step in ms
+ * 
+ * @return u_int32_t
+ */
+u_int32_t sweep_get_dwell_ms();
+
+/**
+ * Sweep get loop mode
+ * 
+ * @return bool
+ */
+bool sweep_get_loop();
+
+/**
+ * Sweep get shared PWM divider (8.4 fixed point)
+ * 
+ * @return u_int16_t
+ */
+u_int16_t sweep_get_div();
+
+/**
+ * Sweep start on a PWM slice
+ * 
+ * Programs the first step and hands the slice to DMA. Every step is
+ * held for dwell_ms worth of whole output periods and the next TOP/CC
+ * pair latches at a counter wrap, so the CPU is not involved.
+ * 
+ * @param u_int8_t slice_num
+ * @param u_int32_t sys_hz
+ * @param u_int32_t duty_ppm
+ * @param bool ph_correct
+ * @param u_int32_t dwell_ms
+ * @param bool loop
+ * @return bool
+ */
+bool sweep_start(u_int8_t slice_num, u_int32_t sys_hz, u_int32_t duty_ppm, bool ph_correct, u_int32_t dwell_ms, bool loop);
+
+/**
+ * Sweep stop (the slice keeps the last step)
+ * 
+ * @return void
+ */
+void sweep_stop();
+
+/**
+ * Sweep owns the DMA channels
+ * 
+ * @return bool
+ */
+bool sweep_is_active();
+
+/**
+ * Sweep still stepping
+ * 
+ * @return bool
+ */
+bool sweep_is_running();
+
+/**
+ * Sweep get current step
+ * 
+ * @return u_int16_t
+ */
+u_int16_t sweep_get_step();
+
+#endif
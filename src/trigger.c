@@ -0,0 +1,193 @@
+#include "pico/stdlib.h"
+#include "hardware/pio.h"
+#include "trigger.pio.h"
+#include "trigger.h"
+
+// the trigger state machine lives on the second PIO block, the pattern
+// engine keeps the first
+#define TRIGGER_PIO pio1
+
+/**
+ * Trigger state machine (-1 when idle)
+ * 
+ * @var int
+ */
+static int trigger_sm = -1;
+
+/**
+ * Trigger loaded program
+ * 
+ * @var const pio_program_t *
+ */
+static const pio_program_t *trigger_program = NULL;
+
+/**
+ * Trigger program offset
+ * 
+ * @var u_int32_t
+ */
+static u_int32_t trigger_offset = 0;
+
+/**
+ * Trigger input pin
+ * 
+ * @var u_int8_t
+ */
+static u_int8_t trigger_pin = 0;
+
+/**
+ * Trigger burst length (TRIGGER_GATE when gating)
+ * 
+ * @var u_int32_t
+ */
+static u_int32_t trigger_count = TRIGGER_GATE;
+
+/**
+ * Trigger half period in sys clock ticks
+ * 
+ * @var u_int64_t
+ */
+static u_int64_t trigger_half_ticks = 0;
+
+/**
+ * Trigger load a register through the TX FIFO
+ * 
+ * The state machine is still disabled, so the pull and move are forced
+ * in with exec and the program never sees the FIFO.
+ * 
+ * @param u_int32_t value
+ * @param enum pio_src_dest dest
+ * @return void
+ */
+static void trigger_load(u_int32_t value, enum pio_src_dest dest)
+{
+    pio_sm_put_blocking(TRIGGER_PIO, trigger_sm, value);
+    pio_sm_exec(TRIGGER_PIO, trigger_sm, pio_encode_pull(false, true));
+
+    if (dest != pio_osr) {
+        pio_sm_exec(TRIGGER_PIO, trigger_sm, pio_encode_mov(dest, pio_osr));
+    }
+}
+
+/**
+ * Trigger start gating the clock pin from an input pin
+ * 
+ * The input has a pull-down, so an unconnected trigger keeps the clock
+ * stopped. Both outputs idle low between cycles.
+ * 
+ * @param u_int8_t pin
+ * @param u_int8_t input_pin
+ * @param u_int64_t half_ticks
+ * @param u_int32_t count
+ * @return bool
+ */
+bool trigger_start(u_int8_t pin, u_int8_t input_pin, u_int64_t half_ticks, u_int32_t count)
+{
+    const pio_program_t *program = count == TRIGGER_GATE ? &gate_program : &burst_program;
+
+    if (
+        trigger_is_active() ||
+        half_ticks < TRIGGER_HALF_TICKS_MIN || half_ticks > TRIGGER_HALF_TICKS_MAX ||
+        !pio_can_add_program(TRIGGER_PIO, program)
+    ) {
+        return false;
+    }
+
+    trigger_sm = pio_claim_unused_sm(TRIGGER_PIO, false);
+    if (trigger_sm < 0) {
+        return false;
+    }
+
+    trigger_program = program;
+    trigger_offset = pio_add_program(TRIGGER_PIO, program);
+    trigger_pin = input_pin;
+    trigger_count = count;
+    trigger_half_ticks = half_ticks;
+
+    pio_sm_config c = count == TRIGGER_GATE ?
+        gate_program_get_default_config(trigger_offset) :
+        burst_program_get_default_config(trigger_offset);
+    sm_config_set_sideset_pins(&c, pin);
+    sm_config_set_in_pins(&c, input_pin);
+    sm_config_set_clkdiv_int_frac(&c, 1, 0);
+
+    gpio_init(input_pin);
+    gpio_set_dir(input_pin, GPIO_IN);
+    gpio_pull_down(input_pin);
+
+    pio_gpio_init(TRIGGER_PIO, pin);
+    pio_sm_set_consecutive_pindirs(TRIGGER_PIO, trigger_sm, pin, 1, true);
+    pio_sm_init(TRIGGER_PIO, trigger_sm, trigger_offset, &c);
+
+    // half period in the ISR, burst length minus one in the OSR
+    trigger_load(half_ticks - TRIGGER_HALF_TICKS_MIN, pio_isr);
+    if (count != TRIGGER_GATE) {
+        trigger_load(count - 1, pio_osr);
+    }
+
+    pio_sm_set_enabled(TRIGGER_PIO, trigger_sm, true);
+
+    return true;
+}
+
+/**
+ * Trigger stop
+ * 
+ * @return void
+ */
+void trigger_stop()
+{
+    if (!trigger_is_active()) {
+        return;
+    }
+
+    pio_sm_set_enabled(TRIGGER_PIO, trigger_sm, false);
+    pio_sm_clear_fifos(TRIGGER_PIO, trigger_sm);
+    pio_remove_program(TRIGGER_PIO, trigger_program, trigger_offset);
+    pio_sm_unclaim(TRIGGER_PIO, trigger_sm);
+
+    gpio_disable_pulls(trigger_pin);
+
+    trigger_program = NULL;
+    trigger_sm = -1;
+}
+
+/**
+ * Trigger owns a state machine
+ * 
+ * @return bool
+ */
+bool trigger_is_active()
+{
+    return trigger_sm >= 0;
+}
+
+/**
+ * Trigger get input pin
+ * 
+ * @return u_int8_t
+ */
+u_int8_t trigger_get_pin()
+{
+    return trigger_pin;
+}
+
+/**
+ * Trigger get burst length (TRIGGER_GATE when gating)
+ * 
+ * @return u_int32_t
+ */
+u_int32_t trigger_get_count()
+{
+    return trigger_count;
+}
+
+/**
+ * Trigger get half period in sys clock ticks
+ * 
+ * @return u_int64_t
+ */
+u_int64_t trigger_get_half_ticks()
+{
+    return trigger_half_ticks;
+}
@@ -0,0 +1,61 @@
+#ifndef TRIGGER_H
+#define TRIGGER_H
+
+#include <stdbool.h>
+#include <sys/types.h>
+
+#define TRIGGER_GATE 0
+
+#define TRIGGER_HALF_TICKS_MIN 3
+#define TRIGGER_HALF_TICKS_MAX 0x100000002ULL
+
+/**
+ * Trigger start gating the clock pin from an input pin
+ * 
+ * A count of TRIGGER_GATE runs whole cycles while the input is high,
+ * any other count fires that many cycles on each rising edge.
+ * 
+ * @param u_int8_t pin
+ * @param u_int8_t input_pin
+ * @param u_int64_t half_ticks
+ * @param u_int32_t count
+ * @return bool
+ */
+bool trigger_start(u_int8_t pin, u_int8_t input_pin, u_int64_t half_ticks, u_int32_t count);
+
+/**
+ * Trigger stop
+ * 
+ * @return void
+ */
+void trigger_stop();
+
+/**
+ * Trigger owns a state machine
+ * 
+ * @return bool
+ */
+bool trigger_is_active();
+
+/**
+ * Trigger get input pin
+ * 
+ * @return u_int8_t
+ */
+u_int8_t trigger_get_pin();
+
+/**
+ * Trigger get burst length (TRIGGER_GATE when gating)
+ * 
+ * @return u_int32_t
+ */
+u_int32_t trigger_get_count();
+
+/**
+ * Trigger get half period in sys clock ticks
+ * 
+ * @return u_int64_t
+ */
+u_int64_t trigger_get_half_ticks();
+
+#endif
@@ -0,0 +1,302 @@
+#include "pico/stdlib.h"
+#include "hardware/adc.h"
+#include "hardware/dma.h"
+#include "sweep.h"
+#include "vco.h"
+
+/**
+ * Vco sample ring, written by DMA and aligned for its address wrap
+ * 
+ * @var volatile u_int16_t[]
+ */
+static volatile u_int16_t vco_ring[VCO_SAMPLES] __attribute__((aligned(1 << VCO_RING_BITS)));
+
+/**
+ * Vco samples per data channel run (re-armed by the control channel)
+ * 
+ * @var const u_int32_t
+ */
+static const u_int32_t vco_ring_count = VCO_SAMPLES;
+
+/**
+ * Vco curve frequencies in mHz, evenly spaced over the ADC range
+ * 
+ * @var u_int64_t[]
+ */
+static u_int64_t vco_curve[VCO_POINTS_MAX];
+
+/**
+ * Vco curve point count
+ * 
+ * @var u_int8_t
+ */
+static u_int8_t vco_count = 0;
+
+/**
+ * Vco curve type
+ * 
+ * @var u_int8_t
+ */
+static u_int8_t vco_type = SWEEP_LINEAR;
+
+/**
+ * Vco sampled ADC input
+ * 
+ * @var u_int8_t
+ */
+static u_int8_t vco_input = 0;
+
+/**
+ * Vco DMA data channel (-1 when idle)
+ * 
+ * @var int
+ */
+static int vco_data_chan = -1;
+
+/**
+ * Vco DMA restart channel
+ * 
+ * @var int
+ */
+static int vco_ctrl_chan = -1;
+
+/**
+ * Vco set curve points spread evenly over the ADC range
+ * 
+ * @param const u_int64_t *mhz
+ * @param u_int8_t count
+ * @return bool
+ */
+bool vco_set_curve(const u_int64_t *mhz, u_int8_t count)
+{
+    if (count < VCO_POINTS_MIN || count > VCO_POINTS_MAX) {
+        return false;
+    }
+
+    for (u_int8_t i = 0; i < count; i++) {
+        if (mhz[i] == 0) {
+            return false;
+        }
+    }
+
+    for (u_int8_t i = 0; i < count; i++) {
+        vco_curve[i] = mhz[i];
+    }
+
+    vco_count = count;
+    vco_type = SWEEP_LIST;
+
+    return true;
+}
+
+/**
+ * Vco set linear or logarithmic curve between two frequencies
+ * 
+ * A logarithmic curve is approximated by VCO_POINTS_MAX geometric
+ * points with linear segments in between.
+ * 
+ * @param u_int8_t type
+ * @param u_int64_t min_mhz
+ * @param u_int64_t max_mhz
+ * @return bool
+ */
+bool vco_set_range(u_int8_t type, u_int64_t min_mhz, u_int64_t max_mhz)
+{
+    if (min_mhz == 0 || max_mhz == 0) {
+        return false;
+    }
+
+    u_int8_t count = type == SWEEP_LOG ? VCO_POINTS_MAX : VCO_POINTS_MIN;
+
+    for (u_int8_t i = 0; i < count; i++) {
+        vco_curve[i] = sweep_interpolate(type, min_mhz, max_mhz, i, count);
+    }
+
+    vco_count = count;
+    vco_type = type;
+
+    return true;
+}
+
+/**
+ * Vco get curve type (SWEEP_LINEAR, SWEEP_LOG or SWEEP_LIST)
+ * 
+ * @return u_int8_t
+ */
+u_int8_t vco_get_type()
+{
+    return vco_type;
+}
+
+/**
+ * Vco get lowest and highest curve frequency
+ * 
+ * @param u_int64_t *min_mhz
+ * @param u_int64_t *max_mhz
+ * @return void
+ */
+void vco_get_span(u_int64_t *min_mhz, u_int64_t *max_mhz)
+{
+    *min_mhz = UINT64_MAX;
+    *max_mhz = 0;
+
+    for (u_int8_t i = 0; i < vco_count; i++) {
+        *min_mhz = vco_curve[i] < *min_mhz ? vco_curve[i] : *min_mhz;
+        *max_mhz = vco_curve[i] > *max_mhz ? vco_curve[i] : *max_mhz;
+    }
+}
+
+/**
+ * Vco map an ADC level through the curve
+ * 
+ * @param u_int16_t level
+ * @return u_int64_t
+ */
+u_int64_t vco_get_freq_mhz(u_int16_t level)
+{
+    if (vco_count < VCO_POINTS_MIN) {
+        return 0;
+    }
+
+    // position along the curve in 1/VCO_LEVEL_MAX segment units
+    u_int32_t pos = (u_int32_t) (level > VCO_LEVEL_MAX ? VCO_LEVEL_MAX : level) * (vco_count - 1);
+    u_int8_t seg = pos / VCO_LEVEL_MAX;
+    u_int32_t frac = pos % VCO_LEVEL_MAX;
+
+    if (seg >= vco_count - 1) {
+        return vco_curve[vco_count - 1];
+    }
+
+    int64_t from = vco_curve[seg];
+    int64_t to = vco_curve[seg + 1];
+
+    return from + (to - from) * frac / VCO_LEVEL_MAX;
+}
+
+/**
+ * Vco start sampling an ADC input into the ring
+ * 
+ * The ADC runs free at VCO_SAMPLE_HZ and DMA keeps overwriting the
+ * ring, so the latest VCO_SAMPLES samples are always in RAM without
+ * CPU time.
+ * 
+ * @param u_int8_t input
+ * @return bool
+ */
+bool vco_start(u_int8_t input)
+{
+    if (vco_is_active() || input > VCO_INPUT_MAX || vco_count < VCO_POINTS_MIN) {
+        return false;
+    }
+
+    vco_input = input;
+
+    adc_init();
+    adc_gpio_init(VCO_GPIO_BASE + input);
+    adc_select_input(input);
+    adc_fifo_setup(true, true, 1, false, false);
+
+    // 48MHz adc clock, integer divider so no soft-float
+    adc_hw->div = (48000000 / VCO_SAMPLE_HZ - 1) << ADC_DIV_INT_LSB;
+
+    vco_data_chan = dma_claim_unused_channel(true);
+    vco_ctrl_chan = dma_claim_unused_channel(true);
+
+    // one sample per conversion, wrapping around the ring
+    dma_channel_config data = dma_channel_get_default_config(vco_data_chan);
+    channel_config_set_transfer_data_size(&data, DMA_SIZE_16);
+    channel_config_set_read_increment(&data, false);
+    channel_config_set_write_increment(&data, true);
+    channel_config_set_ring(&data, true, VCO_RING_BITS);
+    channel_config_set_dreq(&data, DREQ_ADC);
+    channel_config_set_chain_to(&data, vco_ctrl_chan);
+
+    dma_channel_configure(vco_data_chan, &data, vco_ring, &adc_hw->fifo, VCO_SAMPLES, true);
+
+    // re-arm the data channel, its write address carries on round the ring
+    dma_channel_config ctrl = dma_channel_get_default_config(vco_ctrl_chan);
+    channel_config_set_transfer_data_size(&ctrl, DMA_SIZE_32);
+    channel_config_set_read_increment(&ctrl, false);
+    channel_config_set_write_increment(&ctrl, false);
+
+    dma_channel_configure(vco_ctrl_chan, &ctrl, &dma_hw->ch[vco_data_chan].al1_transfer_count_trig, &vco_ring_count, 1, false);
+
+    adc_run(true);
+
+    return true;
+}
+
+/**
+ * Vco stop sampling
+ * 
+ * Both channels are disabled before the abort so a chain trigger raised
+ * by the abort cannot restart the other one.
+ * 
+ * @return void
+ */
+void vco_stop()
+{
+    if (!vco_is_active()) {
+        return;
+    }
+
+    adc_run(false);
+
+    u_int32_t mask = (1u << vco_ctrl_chan) | (1u << vco_data_chan);
+
+    hw_clear_bits(&dma_hw->ch[vco_ctrl_chan].al1_ctrl, DMA_CH0_CTRL_TRIG_EN_BITS);
+    hw_clear_bits(&dma_hw->ch[vco_data_chan].al1_ctrl, DMA_CH0_CTRL_TRIG_EN_BITS);
+
+    dma_hw->abort = mask;
+    while (dma_hw->abort & mask) {
+        tight_loop_contents();
+    }
+
+    dma_channel_unclaim(vco_ctrl_chan);
+    dma_channel_unclaim(vco_data_chan);
+
+    adc_fifo_drain();
+    adc_fifo_setup(false, false, 0, false, false);
+
+    vco_ctrl_chan = -1;
+    vco_data_chan = -1;
+}
+
+/**
+ * Vco owns the ADC and DMA channels
+ * 
+ * @return bool
+ */
+bool vco_is_active()
+{
+    return vco_data_chan >= 0;
+}
+
+/**
+ * Vco get sampled ADC input
+ * 
+ * @return u_int8_t
+ */
+u_int8_t vco_get_input()
+{
+    return vco_input;
+}
+
+/**
+ * Vco get the mean level of the ring
+ * 
+ * Averages VCO_SAMPLES / VCO_SAMPLE_HZ (6.4ms) of input, which filters
+ * the ADC noise well below one curve step.
+ * 
+ * @return u_int16_t
+ */
+u_int16_t vco_get_level()
+{
+    u_int32_t sum = 0;
+
+    for (u_int32_t i = 0; i < VCO_SAMPLES; i++) {
+        sum += vco_ring[i];
+    }
+
+    return (sum + VCO_SAMPLES / 2) / VCO_SAMPLES;
+}
@@ -0,0 +1,100 @@
+#ifndef VCO_H
+#define VCO_H
+
+#include <stdbool.h>
+#include <sys/types.h>
+
+#define VCO_POINTS_MAX 16
+#define VCO_POINTS_MIN 2
+
+// ADC0..2 on GPIO 26..28, ADC3 is the VSYS sense pin on the Pico W
+#define VCO_GPIO_BASE 26
+#define VCO_INPUT_MAX 2
+
+// 64 samples of 16 bits in a 128 byte DMA write ring
+#define VCO_RING_BITS 7
+#define VCO_SAMPLES ((1 << VCO_RING_BITS) / 2)
+
+#define VCO_SAMPLE_HZ 10000
+#define VCO_LEVEL_MAX 4095
+
+/**
+ * Vco set curve points spread evenly over the ADC range
+ * 
+ * @param const u_int64_t *mhz
+ * @param u_int8_t count
+ * @return bool
+ */
+bool vco_set_curve(const u_int64_t *mhz, u_int8_t count);
+
+/**
+ * Vco set linear or logarithmic curve between two frequencies
+ * 
+ * @param u_int8_t type
+ * @param u_int64_t min_mhz
+ * @param u_int64_t max_mhz
+ * @return bool
+ */
+bool vco_set_range(u_int8_t type, u_int64_t min_mhz, u_int64_t max_mhz);
+
+/**
+ * Vco get curve type (SWEEP_LINEAR, SWEEP_LOG or SWEEP_LIST)
+ * 
+ * @return u_int8_t
+ */
+u_int8_t vco_get_type();
+
+/**
+ * Vco get lowest and highest curve frequency
+ * 
+ * @param u_int64_t *min_mhz
+ * @param u_int64_t *max_mhz
+ * @return void
+ */
+void vco_get_span(u_int64_t *min_mhz, u_int64_t *max_mhz);
+
+/**
+ * Vco map an ADC level through the curve
+ * 
+ * @param u_int16_t level
+ * @return u_int64_t
+ */
+u_int64_t vco_get_freq_mhz(u_int16_t level);
+
+/**
+ * Vco start sampling an ADC input into the ring
+ * 
+ * @param u_int8_t input
+ * @return bool
+ */
+bool vco_start(u_int8_t input);
+
+/**
+ * Vco stop sampling
+ * 
+ * @return void
+ */
+void vco_stop();
+
+/**
+ * Vco owns the ADC and DMA channels
+ * 
+ * @return bool
+ */
+bool vco_is_active();
+
+/**
+ * Vco get sampled ADC input
+ * 
+ * @return u_int8_t
+ */
+u_int8_t vco_get_input();
+
+/**
+ * Vco get the mean level of the ring
+ * 
+ * @return u_int16_t
+ */
+u_int16_t vco_get_level();
+
+#endif
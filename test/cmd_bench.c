@@ -0,0 +1,76 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "pico/stdlib.h"
+#include "clock.h"
+#include "cmd.h"
+#include "prof.h"
+
+/**
+ * Bench console lines, valid and rejected arguments of the common commands
+ *
+ * @var const char *[]
+ */
+static const char *bench_lines[] = {
+    "freq 1000", "freq 1.8432M", "freq 3579545.45Hz", "freq", "freq 12x",
+    "duty 25", "duty 33.333%", "duty 101", "high 500ns", "high 8t",
+    "phase 1 90.5", "phase 1 12t", "calibrate -12.5", "spread 1 10k",
+    "channel add 99", "sweep lin 1000 2000 10", "unknown",
+};
+
+/**
+ * Bench get monotonic time in ns
+ *
+ * @return u_int64_t
+ */
+static u_int64_t bench_get_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+ * Bench console line throughput of cmd_execute() on the host
+ *
+ * Console output goes to /dev/null, the result to stderr. The optional
+ * argument is the number of passes over the lines.
+ *
+ * @return int
+ */
+int main(int argc, char **argv)
+{
+    u_int32_t passes = argc > 1 ? strtoul(argv[1], NULL, 10) : 2000;
+    size_t count = sizeof(bench_lines) / sizeof(bench_lines[0]);
+    char line[256];
+
+    if (freopen("/dev/null", "w", stdout) == NULL) {
+        return 1;
+    }
+
+    prof_init();
+    clock_init();
+    cmd_init();
+
+    u_int64_t start = bench_get_ns();
+
+    for (u_int32_t pass = 0; pass < passes; pass++) {
+        for (size_t i = 0; i < count; i++) {
+            strcpy(line, bench_lines[i]);
+            cmd_execute(line);
+        }
+    }
+
+    u_int64_t elapsed = bench_get_ns() - start;
+    u_int64_t lines = (u_int64_t) passes * count;
+
+    fprintf(stderr, "cmd_bench: %llu lines in %llums, %llu lines/s\n",
+        (unsigned long long) lines,
+        (unsigned long long) (elapsed / 1000000),
+        (unsigned long long) (lines * 1000000000ULL / (elapsed ? elapsed : 1))
+    );
+
+    return 0;
+}
@@ -0,0 +1,333 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "clock.h"
+#include "cmd.h"
+#include "prof.h"
+#include "host.h"
+
+// console buffer size in cmd_timer_poll()
+#define FUZZ_LINE_MAX 255
+
+// virtual time per line, long enough for the timers a command arms
+#define FUZZ_RUN_US 1000
+
+// console bytes queued at most at a time, less than the host input queue holds
+#define FUZZ_CHUNK 4096
+
+// the console's repeating timer, its user data is the live cmd_data_t
+extern struct repeating_timer cmd_timer;
+bool cmd_timer_callback(repeating_timer_t *t);
+
+/**
+ * Fuzz let a line's timers run and check none leaked
+ *
+ * A command that leaks a repeating timer exhausts the alarm pool.
+ *
+ * @param const uint8_t *line
+ * @param size_t len
+ * @return void
+ */
+static void fuzz_after_line(const uint8_t *line, size_t len)
+{
+    host_run_us(FUZZ_RUN_US);
+
+    if (host_get_alarm_count() >= HOST_ALARMS_MAX) {
+        fprintf(stderr, "cmd_fuzz: repeating timer pool exhausted after \"%.*s\"\n", (int) len, (const char *) line);
+        abort();
+    }
+}
+
+/**
+ * Fuzz seed lines, one per command and argument shape
+ *
+ * @var const char *[]
+ */
+static const char *fuzz_seeds[] = {
+    "?", "start", "stop", "step", "", "exit", "reset", "clear", "reboot", "jitter", "prof",
+    "freq", "freq 1000", "freq 1.8432M", "freq 3579545.45Hz", "freq 0.001", "freq 62.5M", "freq 1k", "freq 18446744074M", "freq 0.999999999999M",
+    "duty", "duty 25", "duty 33.3%", "duty 100", "high 500ns", "high 8t",
+    "pulse follow", "pulse invert", "pulse blink", "pulse phi1 4", "pulse 25",
+    "align trailing", "align center", "engine", "engine auto", "engine rpt", "engine pwm", "engine gpout",
+    "channel", "channel 1", "channel add 2", "channel add 4 invert", "channel remove 1",
+    "sweep lin 1000 2000 10 50", "sweep log 10 10k 20 5 loop", "sweep list 20 100 200 300", "sweep stop",
+    "pattern 100:200 50:50*3", "pattern stop", "trigger gate 3", "trigger burst 3 4", "trigger stop",
+    "spread 1 10k", "spread 2.5 30 kiss", "spread off", "phase 1 90", "phase 1 12t", "phase 1 off",
+    "ref 20 10M", "ref off", "track 3/2", "track off", "calibrate", "calibrate -12.5", "calibrate clear",
+    "vco lin 0 100 1000", "vco list 1 10 20 30", "vco stop", "profile standard", "profile performance",
+    "freqq\x7f 1000", "\b\x7f\bstop",
+};
+
+/**
+ * Fuzz bytes mutations are built from
+ *
+ * @var const char[]
+ */
+static const char fuzz_alphabet[] = "0123456789.-+ kMHzntdegpm%tx\b\x7f\xff";
+
+/**
+ * Fuzz execute an input, a line per '\r' or '\n' as the console splits them
+ *
+ * Every line is executed from an allocation of its exact length, so a read
+ * past the terminator is caught by AddressSanitizer.
+ *
+ * @param const uint8_t *data
+ * @param size_t size
+ * @return void
+ */
+static void fuzz_run_lines(const uint8_t *data, size_t size)
+{
+    size_t start = 0;
+
+    for (size_t i = 0; i <= size; i++) {
+        if (i < size && data[i] != '\r' && data[i] != '\n') {
+            continue;
+        }
+
+        size_t len = i - start < FUZZ_LINE_MAX ? i - start : FUZZ_LINE_MAX;
+        char *line = malloc(len + 1);
+
+        memcpy(line, data + start, len);
+        line[len] = '\0';
+
+        cmd_execute(line);
+        free(line);
+        fuzz_after_line(data + start, len);
+
+        start = i + 1;
+    }
+}
+
+/**
+ * Fuzz type an input at the console, byte by byte
+ *
+ * The raw bytes go through getchar_timeout_us() into the console poll,
+ * so backspaces, NULs and lines past the 255-byte buffer take the
+ * firmware's own path. A line is queued once the one before it ran, as
+ * typed, since the console flushes what was typed ahead of a command.
+ *
+ * @param const uint8_t *data
+ * @param size_t size
+ * @return void
+ */
+static void fuzz_run_console(const uint8_t *data, size_t size)
+{
+    size_t fed = 0;
+    size_t start = 0;
+
+    while (fed < size || host_input_pending() > 0) {
+        if (host_input_pending() == 0) {
+            size_t len = 0;
+
+            while (fed + len < size && len < FUZZ_CHUNK && data[fed + len] != '\r' && data[fed + len] != '\n') {
+                len++;
+            }
+
+            // the terminator goes with its line
+            len += fed + len < size && len < FUZZ_CHUNK;
+
+            host_input_bytes((const char *) data + fed, len);
+            fed += len;
+        }
+
+        size_t at = fed - host_input_pending();
+
+        cmd_timer_callback(&cmd_timer);
+
+        if (data[at] == '\r' || data[at] == '\n') {
+            fuzz_after_line(data + start, at - start);
+            start = fed - host_input_pending();
+        }
+    }
+
+    // an unterminated line is left in the console buffer, end it
+    host_input("\r");
+    cmd_timer_callback(&cmd_timer);
+    fuzz_after_line(data + start, size - start);
+}
+
+/**
+ * Fuzz run one input, as whole lines and then typed at the console
+ *
+ * @param const uint8_t *data
+ * @param size_t size
+ * @return int
+ */
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    fuzz_run_lines(data, size);
+    fuzz_run_console(data, size);
+
+    return 0;
+}
+
+/**
+ * Fuzz boot the firmware once, console output goes to /dev/null
+ *
+ * @param int *argc
+ * @param char ***argv
+ * @return int
+ */
+int LLVMFuzzerInitialize(int *argc, char ***argv)
+{
+    if (freopen("/dev/null", "w", stdout) == NULL) {
+        return 1;
+    }
+
+    prof_init();
+    clock_init();
+    cmd_init();
+
+    return 0;
+}
+
+#if !CMD_FUZZ_LIBFUZZER
+
+/**
+ * Fuzz xorshift random number, fixed seed so runs repeat
+ *
+ * @return u_int32_t
+ */
+static u_int32_t fuzz_random()
+{
+    static u_int32_t state = 0x2545f491;
+
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+
+    return state;
+}
+
+/**
+ * Fuzz mutate seed lines into a random input
+ *
+ * @param char *buffer
+ * @param size_t size
+ * @return size_t
+ */
+static size_t fuzz_mutate(char *buffer, size_t size)
+{
+    size_t seeds = sizeof(fuzz_seeds) / sizeof(fuzz_seeds[0]);
+    size_t len = 0;
+
+    // one to three lines
+    for (u_int32_t n = fuzz_random() % 3 + 1; n > 0 && len < size / 2; n--) {
+        len += snprintf(buffer + len, size / 2 - len, "%s\n", fuzz_seeds[fuzz_random() % seeds]);
+    }
+
+    for (u_int32_t n = fuzz_random() % 8; n > 0; n--) {
+        size_t at = fuzz_random() % (len + 1);
+
+        switch (fuzz_random() % 4) {
+            // insert a byte
+            case 0:
+                if (len < size) {
+                    memmove(buffer + at + 1, buffer + at, len - at);
+                    buffer[at] = fuzz_alphabet[fuzz_random() % (sizeof(fuzz_alphabet) - 1)];
+                    len++;
+                }
+                break;
+            // delete a byte
+            case 1:
+                if (at < len) {
+                    memmove(buffer + at, buffer + at + 1, len - at - 1);
+                    len--;
+                }
+                break;
+            // replace a byte
+            case 2:
+                if (at < len) {
+                    buffer[at] = fuzz_random() % 256;
+                }
+                break;
+            // truncate
+            default:
+                len = at;
+                break;
+        }
+    }
+
+    return len;
+}
+
+/**
+ * Fuzz run a file as one input, as libFuzzer does to reproduce a crash
+ *
+ * @param const char *path
+ * @return bool
+ */
+static bool fuzz_run_file(const char *path)
+{
+    static char buffer[1 << 20];
+    FILE *file = fopen(path, "rb");
+
+    if (file == NULL) {
+        fprintf(stderr, "cmd_fuzz: cannot open %s\n", path);
+        return false;
+    }
+
+    size_t len = fread(buffer, 1, sizeof(buffer), file);
+    fclose(file);
+
+    LLVMFuzzerTestOneInput((const uint8_t *) buffer, len);
+    return true;
+}
+
+/**
+ * Fuzz standalone driver for compilers without libFuzzer
+ *
+ * Runs every seed truncated at every length, then random mutations of
+ * the seeds. The argument is the number of mutations, or input files to
+ * run instead.
+ *
+ * @return int
+ */
+int main(int argc, char **argv)
+{
+    u_int32_t runs = 20000;
+    char buffer[512];
+
+    if (LLVMFuzzerInitialize(&argc, &argv) != 0) {
+        return 1;
+    }
+
+    if (argc > 1 && (argv[1][0] < '0' || argv[1][0] > '9')) {
+        for (int i = 1; i < argc; i++) {
+            if (!fuzz_run_file(argv[i])) {
+                return 1;
+            }
+        }
+
+        return 0;
+    }
+
+    if (argc > 1) {
+        runs = strtoul(argv[1], NULL, 10);
+    }
+
+    for (size_t s = 0; s < sizeof(fuzz_seeds) / sizeof(fuzz_seeds[0]); s++) {
+        for (size_t len = 0; len <= strlen(fuzz_seeds[s]); len++) {
+            LLVMFuzzerTestOneInput((const uint8_t *) fuzz_seeds[s], len);
+        }
+    }
+
+    // a line past the console buffer, then one erased past its start
+    memset(buffer, '1', sizeof(buffer));
+    memcpy(buffer, "freq ", 5);
+    LLVMFuzzerTestOneInput((const uint8_t *) buffer, sizeof(buffer));
+    memset(buffer, 0x7f, sizeof(buffer));
+    LLVMFuzzerTestOneInput((const uint8_t *) buffer, sizeof(buffer));
+
+    for (u_int32_t i = 0; i < runs; i++) {
+        size_t len = fuzz_mutate(buffer, sizeof(buffer));
+        LLVMFuzzerTestOneInput((const uint8_t *) buffer, len);
+    }
+
+    fprintf(stderr, "cmd_fuzz: %u inputs\n", runs);
+
+    return 0;
+}
+
+#endif
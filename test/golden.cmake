@@ -0,0 +1,34 @@
+# replay a console session and compare against its golden files:
+# cmake -DREPLAY=<golden_replay> -DSESSION=<name> -DGOLDEN=<dir> -DOUT=<dir> [-DRECORD=ON] -P golden.cmake
+
+set(CONSOLE ${OUT}/${SESSION}.console)
+set(TRACE ${OUT}/${SESSION}.trace)
+
+execute_process(
+    COMMAND ${REPLAY} ${GOLDEN}/${SESSION}.session ${TRACE}
+    OUTPUT_FILE ${CONSOLE}
+    RESULT_VARIABLE result
+)
+
+if (NOT result EQUAL 0)
+    message(FATAL_ERROR "golden_replay failed on ${SESSION}: ${result}")
+endif()
+
+# regenerate the golden files after an intended change
+if (RECORD)
+    file(COPY ${CONSOLE} ${TRACE} DESTINATION ${GOLDEN})
+    return()
+endif()
+
+foreach(file ${CONSOLE} ${TRACE})
+    get_filename_component(name ${file} NAME)
+
+    execute_process(
+        COMMAND ${CMAKE_COMMAND} -E compare_files ${GOLDEN}/${name} ${file}
+        RESULT_VARIABLE result
+    )
+
+    if (NOT result EQUAL 0)
+        message(FATAL_ERROR "${name} differs from the golden file, diff ${GOLDEN}/${name} ${file}")
+    endif()
+endforeach()
@@ -0,0 +1,85 @@
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "clock.h"
+#include "cmd.h"
+#include "prof.h"
+#include "host.h"
+
+// cmd_run() polls the console every 50ms and reads one character a poll
+#define REPLAY_POLL_US 50000
+
+/**
+ * Replay a console session against the firmware on the host SDK
+ *
+ * Each session line is typed at the console and its carriage return
+ * starts a new trace section, so a section holds the edges that follow
+ * the command. Lines starting with '#' are comments,
+ * "@run <ms>" lets time pass without typing, "@adc <input> <level>"
+ * sets what an ADC input converts to and starts a section of its own,
+ * and an empty line is a bare Enter. The console output goes to stdout, the pin trace to the file.
+ *
+ * @return int
+ */
+int main(int argc, char **argv)
+{
+    if (argc != 3) {
+        fprintf(stderr, "Usage: golden_replay <session> <trace>\n");
+        return 2;
+    }
+
+    FILE *session = fopen(argv[1], "r");
+    FILE *trace = fopen(argv[2], "w");
+
+    if (session == NULL || trace == NULL) {
+        fprintf(stderr, "golden_replay: cannot open %s or %s\n", argv[1], argv[2]);
+        return 2;
+    }
+
+    host_trace(trace);
+    host_trace_mark("boot");
+
+    prof_init();
+    clock_init();
+    cmd_init();
+
+    char line[256];
+    u_int32_t ms;
+    u_int32_t input;
+    u_int32_t level;
+
+    while (fgets(line, sizeof(line), session) != NULL) {
+        line[strcspn(line, "\r\n")] = '\0';
+
+        if (line[0] == '#') {
+            continue;
+        }
+
+        if (sscanf(line, "@run %u", &ms) == 1) {
+            host_run_us(ms * 1000ULL);
+            clock_poll();
+            continue;
+        }
+
+        if (sscanf(line, "@adc %u %u", &input, &level) == 2) {
+            host_trace_mark(line);
+            host_adc_level(input, level);
+            continue;
+        }
+
+        host_input_line(line);
+
+        while (host_input_pending() > 0) {
+            host_run_us(REPLAY_POLL_US);
+            clock_poll();
+        }
+    }
+
+    host_trace_mark("end");
+
+    fflush(stdout);
+    fclose(trace);
+    fclose(session);
+
+    return 0;
+}
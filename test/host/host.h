@@ -0,0 +1,102 @@
+#ifndef HOST_H
+#define HOST_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <sys/types.h>
+
+// repeating timers in the SDK's default alarm pool
+#define HOST_ALARMS_MAX 16
+
+// edges traced per pin between two marks, the rest are counted
+#define HOST_TRACE_EDGES 8
+
+/**
+ * Host queue console input for getchar_timeout_us()
+ *
+ * @param const char *text
+ * @return void
+ */
+void host_input(const char *text);
+
+/**
+ * Host queue raw console bytes, NULs included
+ *
+ * @param const char *data
+ * @param size_t len
+ * @return void
+ */
+void host_input_bytes(const char *data, size_t len);
+
+/**
+ * Host queue a console line, the trace is marked with the line when the
+ * firmware reads its carriage return
+ *
+ * @param const char *line
+ * @return void
+ */
+void host_input_line(const char *line);
+
+/**
+ * Host console input still queued
+ *
+ * @return size_t
+ */
+size_t host_input_pending();
+
+/**
+ * Host advance virtual time, firing repeating timers on the way
+ *
+ * @param u_int64_t us
+ * @return void
+ */
+void host_run_us(u_int64_t us);
+
+/**
+ * Host get virtual time in ns
+ *
+ * @return u_int64_t
+ */
+u_int64_t host_get_ns();
+
+/**
+ * Host get the number of armed repeating timers
+ *
+ * @return u_int8_t
+ */
+u_int8_t host_get_alarm_count();
+
+/**
+ * Host start tracing pin edges to a file (NULL stops)
+ *
+ * Edges of SIO pins come from gpio_put(), edges of PWM pins from the
+ * slice model. DMA, PIO and clk_gpout outputs are not simulated, a pin
+ * moving to one of them is traced as a function change.
+ *
+ * @param FILE *file
+ * @return void
+ */
+void host_trace(FILE *file);
+
+/**
+ * Host start a new trace section
+ *
+ * @param const char *label
+ * @return void
+ */
+void host_trace_mark(const char *label);
+
+/**
+ * Host set the level an ADC input converts to
+ *
+ * While the ADC runs on the input, every DMA channel reading its FIFO
+ * has its whole destination filled with the level, as if the ring had
+ * been streaming it for a while.
+ *
+ * @param u_int8_t input
+ * @param u_int16_t level
+ * @return void
+ */
+void host_adc_level(u_int8_t input, u_int16_t level);
+
+#endif
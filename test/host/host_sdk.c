@@ -0,0 +1,1244 @@
+#include <stdlib.h>
+#include <string.h>
+#include "host_sdk.h"
+#include "host.h"
+#include "pwm_model.h"
+
+/**
+ * Host virtual time in ns
+ *
+ * @var u_int64_t
+ */
+static u_int64_t host_now_ns = 0;
+
+/**
+ * Host sys clock, and the time and cycle count it was set at
+ *
+ * @var u_int32_t
+ */
+static u_int32_t host_sys_hz = 125000000;
+static u_int64_t host_base_ns = 0;
+static u_int64_t host_base_cycles = 0;
+
+/**
+ * Host alarm pool, one alarm per repeating timer
+ *
+ * @var host_alarm_t[]
+ */
+typedef struct {
+    bool active;
+    alarm_id_t id;
+    u_int64_t next_ns;
+    repeating_timer_t *rt;
+} host_alarm_t;
+
+static host_alarm_t host_alarms[HOST_ALARMS_MAX];
+static alarm_id_t host_alarm_id = 0;
+
+/**
+ * Host console input queue
+ *
+ * @var char[]
+ */
+static char host_input_buf[65536];
+static size_t host_input_head = 0;
+static size_t host_input_tail = 0;
+
+/**
+ * Host trace label of the queued line
+ *
+ * @var char[]
+ */
+static char host_input_label[256];
+
+/**
+ * Host pin state, the level is -1 while the pin is not simulated
+ *
+ * @var host_gpio_t[]
+ */
+typedef struct {
+    u_int8_t function;
+    bool out;
+    bool value;
+    int8_t level;
+    u_int32_t edges;
+} host_gpio_t;
+
+static host_gpio_t host_gpios[NUM_BANK0_GPIOS];
+
+/**
+ * Host trace file
+ *
+ * @var FILE *
+ */
+static FILE *host_trace_file = NULL;
+
+/**
+ * Host PWM slices
+ *
+ * @var pwm_model_t[]
+ */
+static pwm_model_t host_pwm[NUM_PWM_SLICES];
+
+/**
+ * Host register blocks
+ */
+static pwm_hw_t host_pwm_hw;
+static dma_hw_t host_dma_hw;
+static clocks_hw_t host_clocks_hw;
+static adc_hw_t host_adc_hw;
+static systick_hw_t host_systick_hw;
+static pio_hw_t host_pio_hw[2];
+
+pwm_hw_t *pwm_hw = &host_pwm_hw;
+dma_hw_t *dma_hw = &host_dma_hw;
+clocks_hw_t *clocks_hw = &host_clocks_hw;
+adc_hw_t *adc_hw = &host_adc_hw;
+systick_hw_t *systick_hw = &host_systick_hw;
+PIO pio0 = &host_pio_hw[0];
+PIO pio1 = &host_pio_hw[1];
+uart_inst_t *uart_default_inst = NULL;
+uint8_t host_flash[PICO_FLASH_SIZE_BYTES];
+
+/**
+ * Host claimed DMA channels
+ *
+ * @var u_int16_t
+ */
+static u_int16_t host_dma_claimed = 0;
+
+/**
+ * Host ADC input levels, the selected input and whether it runs
+ */
+static u_int16_t host_adc_levels[5];
+static u_int8_t host_adc_input = 0;
+static bool host_adc_running = false;
+
+/**
+ * Host reset state: PWM slices at their reset values, erased flash
+ *
+ * @return void
+ */
+__attribute__((constructor)) static void host_init()
+{
+    for (u_int8_t s = 0; s < NUM_PWM_SLICES; s++) {
+        pwm_model_init(&host_pwm[s]);
+        host_pwm_hw.slice[s].div = 1 << 4;
+        host_pwm_hw.slice[s].top = 0xffff;
+    }
+
+    for (u_int8_t gpio = 0; gpio < NUM_BANK0_GPIOS; gpio++) {
+        host_gpios[gpio].function = GPIO_FUNC_NULL;
+        host_gpios[gpio].level = -1;
+    }
+
+    memset(host_flash, 0xff, sizeof(host_flash));
+}
+
+/**
+ * Host convert a time to sys clock cycles
+ *
+ * @param u_int64_t ns
+ * @return u_int64_t
+ */
+static u_int64_t host_ns_to_cycles(u_int64_t ns)
+{
+    return host_base_cycles + (ns - host_base_ns) * (host_sys_hz / 1000) / 1000000;
+}
+
+/**
+ * Host convert sys clock cycles to a time
+ *
+ * @param u_int64_t cycles
+ * @return u_int64_t
+ */
+static u_int64_t host_cycles_to_ns(u_int64_t cycles)
+{
+    return host_base_ns + (cycles - host_base_cycles) * 1000000 / (host_sys_hz / 1000);
+}
+
+/**
+ * Host print a time as us.ns
+ *
+ * @param u_int64_t ns
+ * @return void
+ */
+static void host_trace_time(u_int64_t ns)
+{
+    fprintf(host_trace_file, "%llu.%03llu", (unsigned long long) (ns / 1000), (unsigned long long) (ns % 1000));
+}
+
+/**
+ * Host record a pin level, tracing it when it changed
+ *
+ * A level of -1 is a pin the host does not simulate, an SIO input in the
+ * trace ("z").
+ *
+ * @param u_int8_t gpio
+ * @param int8_t level
+ * @param u_int64_t ns
+ * @return void
+ */
+static void host_trace_level(u_int8_t gpio, int8_t level, u_int64_t ns)
+{
+    host_gpio_t *pin = &host_gpios[gpio];
+
+    if (pin->level == level) {
+        return;
+    }
+
+    pin->level = level;
+
+    if (host_trace_file == NULL || pin->edges++ >= HOST_TRACE_EDGES) {
+        return;
+    }
+
+    host_trace_time(ns);
+
+    if (level < 0) {
+        fprintf(host_trace_file, " GPIO%u z\n", gpio);
+    } else {
+        fprintf(host_trace_file, " GPIO%u %u\n", gpio, level);
+    }
+}
+
+/**
+ * Host trace the outputs of a PWM slice
+ *
+ * @param u_int8_t slice
+ * @param u_int64_t ns
+ * @return void
+ */
+static void host_pwm_trace(u_int8_t slice, u_int64_t ns)
+{
+    for (u_int8_t chan = 0; chan < 2; chan++) {
+        u_int8_t gpio = slice * 2 + chan;
+
+        // slices 0 to 6 also drive GPIO 16 to 29
+        for (; gpio < NUM_BANK0_GPIOS; gpio += 16) {
+            if (host_gpios[gpio].function == GPIO_FUNC_PWM) {
+                host_trace_level(gpio, pwm_model_get_output(&host_pwm[slice], chan), ns);
+            }
+        }
+    }
+}
+
+/**
+ * Host get whether a PWM channel toggles, a level of 0 or past TOP holds
+ * the output
+ *
+ * @param pwm_model_t *m
+ * @param u_int8_t chan
+ * @return bool
+ */
+static bool host_pwm_toggles(pwm_model_t *m, u_int8_t chan)
+{
+    return m->active.cc[chan] > 0 && m->active.cc[chan] <= m->active.top;
+}
+
+/**
+ * Host count the edges of a fast-forward over a wrap as untraced
+ *
+ * @param u_int8_t slice
+ * @return void
+ */
+static void host_pwm_count_edges(u_int8_t slice)
+{
+    pwm_model_t *m = &host_pwm[slice];
+
+    for (u_int8_t chan = 0; chan < 2; chan++) {
+        if (!host_pwm_toggles(m, chan)) {
+            continue;
+        }
+
+        for (u_int8_t gpio = slice * 2 + chan; gpio < NUM_BANK0_GPIOS; gpio += 16) {
+            if (host_gpios[gpio].function == GPIO_FUNC_PWM && host_gpios[gpio].edges <= HOST_TRACE_EDGES) {
+                host_gpios[gpio].edges = HOST_TRACE_EDGES + 1;
+            }
+        }
+    }
+}
+
+/**
+ * Host get whether a toggling pin of a PWM slice still traces edges
+ *
+ * @param u_int8_t slice
+ * @return bool
+ */
+static bool host_pwm_is_traced(u_int8_t slice)
+{
+    for (u_int8_t chan = 0; chan < 2; chan++) {
+        if (!host_pwm_toggles(&host_pwm[slice], chan)) {
+            continue;
+        }
+
+        for (u_int8_t gpio = slice * 2 + chan; gpio < NUM_BANK0_GPIOS; gpio += 16) {
+            if (host_gpios[gpio].function == GPIO_FUNC_PWM && host_gpios[gpio].edges < HOST_TRACE_EDGES) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Host get the counts until the next output edge or wrap of a slice
+ *
+ * @param pwm_model_t *m
+ * @return u_int32_t
+ */
+static u_int32_t host_pwm_counts_to_event(pwm_model_t *m)
+{
+    u_int32_t best;
+
+    if (!m->ph_correct) {
+        best = (u_int16_t) (m->active.top - m->ctr) + 1;
+
+        for (u_int8_t chan = 0; chan < 2; chan++) {
+            u_int16_t cc = m->active.cc[chan];
+
+            if (cc > m->ctr && (u_int32_t) (cc - m->ctr) < best) {
+                best = cc - m->ctr;
+            }
+        }
+    } else if (!m->down) {
+        // the turnaround at TOP
+        best = m->ctr < m->active.top ? m->active.top - m->ctr : 1;
+
+        for (u_int8_t chan = 0; chan < 2; chan++) {
+            u_int16_t cc = m->active.cc[chan];
+
+            if (cc > m->ctr && (u_int32_t) (cc - m->ctr) < best) {
+                best = cc - m->ctr;
+            }
+        }
+    } else {
+        best = m->ctr + 1;
+
+        for (u_int8_t chan = 0; chan < 2; chan++) {
+            u_int16_t cc = m->active.cc[chan];
+
+            if (cc > 0 && cc <= m->ctr && (u_int32_t) (m->ctr - cc + 1) < best) {
+                best = m->ctr - cc + 1;
+            }
+        }
+    }
+
+    return best;
+}
+
+/**
+ * Host bring every PWM slice up to the current time
+ *
+ * Slices step from edge to edge while a pin of theirs traces edges, the
+ * rest fast-forward and only settle their pin levels.
+ *
+ * @return void
+ */
+static void host_pwm_sync()
+{
+    u_int64_t target = host_ns_to_cycles(host_now_ns);
+
+    for (u_int8_t s = 0; s < NUM_PWM_SLICES; s++) {
+        pwm_model_t *m = &host_pwm[s];
+
+        bool step_edges = host_trace_file != NULL && m->enabled && m->divmode == PWM_MODEL_DIV_FREE_RUNNING;
+
+        while (step_edges && m->cycles < target && host_pwm_is_traced(s)) {
+            // cycles to the count that reaches the event
+            u_int64_t counts = host_pwm_counts_to_event(m);
+            u_int64_t step = (counts * m->div - m->frac + 15) / 16;
+
+            if (step == 0) {
+                step = 1;
+            }
+
+            if (step > target - m->cycles) {
+                step = target - m->cycles;
+            }
+
+            pwm_model_run(m, step, false);
+            host_pwm_trace(s, host_cycles_to_ns(m->cycles));
+        }
+
+        if (m->cycles < target) {
+            u_int64_t wraps = m->wraps;
+
+            pwm_model_run(m, target - m->cycles, false);
+            host_pwm_trace(s, host_now_ns);
+
+            if (m->wraps != wraps) {
+                host_pwm_count_edges(s);
+            }
+        }
+
+        pwm_hw->slice[s].ctr = m->ctr;
+    }
+}
+
+/**
+ * Host move virtual time forward without firing timers
+ *
+ * @param u_int64_t ns
+ * @return void
+ */
+static void host_advance(u_int64_t ns)
+{
+    if (ns > host_now_ns) {
+        host_now_ns = ns;
+    }
+
+    host_pwm_sync();
+}
+
+/**
+ * Host fire the earliest alarm due by a time
+ *
+ * A callback returning true re-arms its alarm, one returning false clears
+ * the timer's alarm id like the SDK, even when the timer was re-added
+ * under a new alarm in the callback.
+ *
+ * @param u_int64_t until_ns
+ * @return bool
+ */
+static bool host_fire_next(u_int64_t until_ns)
+{
+    host_alarm_t *next = NULL;
+
+    for (u_int8_t i = 0; i < HOST_ALARMS_MAX; i++) {
+        host_alarm_t *a = &host_alarms[i];
+
+        if (a->active && a->next_ns <= until_ns && (next == NULL || a->next_ns < next->next_ns || (a->next_ns == next->next_ns && a->id < next->id))) {
+            next = a;
+        }
+    }
+
+    if (next == NULL) {
+        return false;
+    }
+
+    host_advance(next->next_ns);
+
+    alarm_id_t id = next->id;
+    repeating_timer_t *rt = next->rt;
+    bool again = rt->callback(rt);
+
+    // cancelled in its own callback, the slot may be a new alarm now
+    if (!next->active || next->id != id) {
+        return true;
+    }
+
+    if (again) {
+        int64_t delay_us = rt->delay_us < 0 ? -rt->delay_us : rt->delay_us;
+        next->next_ns = host_now_ns + delay_us * 1000;
+    } else {
+        next->active = false;
+        rt->alarm_id = 0;
+    }
+
+    return true;
+}
+
+void host_input(const char *text)
+{
+    host_input_bytes(text, strlen(text));
+}
+
+void host_input_bytes(const char *data, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        if (host_input_tail - host_input_head < sizeof(host_input_buf)) {
+            host_input_buf[host_input_tail++ % sizeof(host_input_buf)] = data[i];
+        }
+    }
+}
+
+void host_input_line(const char *line)
+{
+    snprintf(host_input_label, sizeof(host_input_label), "%s", line[0] != '\0' ? line : "(enter)");
+    host_input(line);
+    host_input("\r");
+}
+
+size_t host_input_pending()
+{
+    return host_input_tail - host_input_head;
+}
+
+void host_run_us(u_int64_t us)
+{
+    u_int64_t until_ns = host_now_ns + us * 1000;
+
+    while (host_fire_next(until_ns)) {
+    }
+
+    host_advance(until_ns);
+}
+
+u_int64_t host_get_ns()
+{
+    return host_now_ns;
+}
+
+u_int8_t host_get_alarm_count()
+{
+    u_int8_t count = 0;
+
+    for (u_int8_t i = 0; i < HOST_ALARMS_MAX; i++) {
+        count += host_alarms[i].active;
+    }
+
+    return count;
+}
+
+/**
+ * Host fill the destinations of the DMA channels paced by the ADC
+ *
+ * @return void
+ */
+static void host_adc_fill()
+{
+    u_int16_t level = host_adc_levels[host_adc_input];
+
+    adc_hw->result = level;
+    adc_hw->fifo = level;
+
+    if (!host_adc_running) {
+        return;
+    }
+
+    for (u_int8_t channel = 0; channel < NUM_DMA_CHANNELS; channel++) {
+        dma_channel_hw_t *hw = &dma_hw->ch[channel];
+
+        if (!(host_dma_claimed & (1u << channel)) || hw->read_addr != (uintptr_t) &adc_hw->fifo) {
+            continue;
+        }
+
+        if (((hw->al1_ctrl >> 2) & 0x3u) != DMA_SIZE_16) {
+            fprintf(stderr, "host: ADC DMA on channel %u is not 16 bit\n", channel);
+            abort();
+        }
+
+        volatile u_int16_t *dst = (volatile u_int16_t *) hw->write_addr;
+
+        for (u_int32_t i = 0; i < hw->transfer_count; i++) {
+            dst[i] = level;
+        }
+    }
+}
+
+void host_adc_level(u_int8_t input, u_int16_t level)
+{
+    host_adc_levels[input % 5] = level & 0xfff;
+    host_adc_fill();
+}
+
+void host_trace(FILE *file)
+{
+    host_pwm_sync();
+    host_trace_file = file;
+}
+
+void host_trace_mark(const char *label)
+{
+    host_pwm_sync();
+
+    if (host_trace_file == NULL) {
+        return;
+    }
+
+    for (u_int8_t gpio = 0; gpio < NUM_BANK0_GPIOS; gpio++) {
+        if (host_gpios[gpio].edges > HOST_TRACE_EDGES) {
+            fprintf(host_trace_file, "  GPIO%u more edges\n", gpio);
+        }
+
+        host_gpios[gpio].edges = 0;
+    }
+
+    host_trace_time(host_now_ns);
+    fprintf(host_trace_file, " > %s [%u timers]\n", label, host_get_alarm_count());
+}
+
+// time
+
+bool add_repeating_timer_us(int64_t delay_us, repeating_timer_callback_t callback, void *user_data, repeating_timer_t *out)
+{
+    if (delay_us == 0) {
+        delay_us = 1;
+    }
+
+    for (u_int8_t i = 0; i < HOST_ALARMS_MAX; i++) {
+        host_alarm_t *a = &host_alarms[i];
+
+        if (!a->active) {
+            out->delay_us = delay_us;
+            out->callback = callback;
+            out->user_data = user_data;
+            out->alarm_id = ++host_alarm_id;
+
+            a->active = true;
+            a->id = out->alarm_id;
+            a->rt = out;
+            a->next_ns = host_now_ns + (delay_us < 0 ? -delay_us : delay_us) * 1000;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool add_repeating_timer_ms(int32_t delay_ms, repeating_timer_callback_t callback, void *user_data, repeating_timer_t *out)
+{
+    return add_repeating_timer_us(delay_ms * 1000LL, callback, user_data, out);
+}
+
+bool cancel_repeating_timer(repeating_timer_t *timer)
+{
+    bool cancelled = false;
+
+    for (u_int8_t i = 0; i < HOST_ALARMS_MAX && timer->alarm_id != 0; i++) {
+        if (host_alarms[i].active && host_alarms[i].id == timer->alarm_id) {
+            host_alarms[i].active = false;
+            cancelled = true;
+        }
+    }
+
+    timer->alarm_id = 0;
+
+    return cancelled;
+}
+
+uint64_t time_us_64(void)
+{
+    return host_now_ns / 1000;
+}
+
+uint32_t time_us_32(void)
+{
+    return (uint32_t) time_us_64();
+}
+
+void sleep_ms(uint32_t ms)
+{
+    host_run_us(ms * 1000ULL);
+}
+
+void busy_wait_us(uint64_t us)
+{
+    host_advance(host_now_ns + us * 1000);
+}
+
+void busy_wait_at_least_cycles(uint32_t cycles)
+{
+    host_advance(host_cycles_to_ns(host_ns_to_cycles(host_now_ns) + cycles) + 1);
+}
+
+void tight_loop_contents(void)
+{
+    // aborts finish at once
+    dma_hw->abort = 0;
+}
+
+// stdio
+
+bool stdio_init_all(void)
+{
+    return true;
+}
+
+void stdio_flush(void)
+{
+    fflush(stdout);
+}
+
+int getchar_timeout_us(uint32_t timeout_us)
+{
+    if (host_input_pending() == 0) {
+        return PICO_ERROR_TIMEOUT;
+    }
+
+    char c = host_input_buf[host_input_head++ % sizeof(host_input_buf)];
+
+    if (c == '\r' && host_input_label[0] != '\0') {
+        host_trace_mark(host_input_label);
+        host_input_label[0] = '\0';
+    }
+
+    return (unsigned char) c;
+}
+
+// sync and irq
+
+uint32_t save_and_disable_interrupts(void)
+{
+    return 0;
+}
+
+void restore_interrupts(uint32_t status)
+{
+}
+
+void hw_set_bits(io_rw_32 *addr, uint32_t mask)
+{
+    *addr |= mask;
+}
+
+void hw_clear_bits(io_rw_32 *addr, uint32_t mask)
+{
+    *addr &= ~(uintptr_t) mask;
+}
+
+void irq_add_shared_handler(unsigned num, void (*handler)(void), uint8_t order_priority)
+{
+}
+
+void irq_remove_handler(unsigned num, void (*handler)(void))
+{
+}
+
+void irq_set_enabled(unsigned num, bool enabled)
+{
+}
+
+void irq_set_priority(unsigned num, uint8_t priority)
+{
+}
+
+// gpio
+
+/**
+ * Host get the name of a pin function for the trace
+ *
+ * @param u_int8_t function
+ * @return const char *
+ */
+static const char *host_gpio_function_name(u_int8_t function)
+{
+    switch (function) {
+        case GPIO_FUNC_SIO:
+            return "sio";
+        case GPIO_FUNC_PWM:
+            return "pwm";
+        case GPIO_FUNC_PIO0:
+            return "pio0";
+        case GPIO_FUNC_PIO1:
+            return "pio1";
+        case GPIO_FUNC_GPCK:
+            return "gpck";
+        default:
+            return "null";
+    }
+}
+
+/**
+ * Host get the simulated level of a pin
+ *
+ * @param u_int8_t gpio
+ * @return int8_t
+ */
+static int8_t host_gpio_get_level(u_int8_t gpio)
+{
+    host_gpio_t *pin = &host_gpios[gpio];
+
+    if (pin->function == GPIO_FUNC_SIO) {
+        return pin->out ? pin->value : -1;
+    }
+
+    if (pin->function == GPIO_FUNC_PWM) {
+        return pwm_model_get_output(&host_pwm[(gpio >> 1) & 7], gpio & 1);
+    }
+
+    return -1;
+}
+
+void gpio_init(unsigned gpio)
+{
+    gpio_set_dir(gpio, GPIO_IN);
+    host_gpios[gpio].value = false;
+    gpio_set_function(gpio, GPIO_FUNC_SIO);
+}
+
+void gpio_set_dir(unsigned gpio, bool out)
+{
+    host_pwm_sync();
+    host_gpios[gpio].out = out;
+    host_trace_level(gpio, host_gpio_get_level(gpio), host_now_ns);
+}
+
+void gpio_put(unsigned gpio, bool value)
+{
+    host_pwm_sync();
+    host_gpios[gpio].value = value;
+    host_trace_level(gpio, host_gpio_get_level(gpio), host_now_ns);
+}
+
+void gpio_set_function(unsigned gpio, enum gpio_function fn)
+{
+    host_pwm_sync();
+
+    if (host_gpios[gpio].function == fn) {
+        return;
+    }
+
+    host_gpios[gpio].function = fn;
+
+    if (host_trace_file != NULL) {
+        host_trace_time(host_now_ns);
+        fprintf(host_trace_file, " GPIO%u %s\n", gpio, host_gpio_function_name(fn));
+    }
+
+    // the level of the new function is traced from scratch, not as a z
+    host_gpios[gpio].level = -1;
+    host_trace_level(gpio, host_gpio_get_level(gpio), host_now_ns);
+}
+
+void gpio_pull_down(unsigned gpio)
+{
+}
+
+void gpio_disable_pulls(unsigned gpio)
+{
+}
+
+// clocks
+
+uint32_t clock_get_hz(enum clock_index clk_index)
+{
+    switch (clk_index) {
+        case clk_sys:
+            return host_sys_hz;
+        case clk_ref:
+            return 12000000;
+        case clk_peri:
+        case clk_usb:
+        case clk_adc:
+            return 48000000;
+        default:
+            return 0;
+    }
+}
+
+bool clock_configure(enum clock_index clk_index, uint32_t src, uint32_t auxsrc, uint32_t src_freq, uint32_t freq)
+{
+    return true;
+}
+
+void clock_gpio_init_int_frac(unsigned gpio, unsigned src, uint32_t div_int, uint8_t div_frac)
+{
+    gpio_set_function(gpio, GPIO_FUNC_GPCK);
+}
+
+void clock_stop(enum clock_index clk_index)
+{
+}
+
+bool set_sys_clock_khz(uint32_t freq_khz, bool required)
+{
+    // slices run on the old clock up to now
+    host_pwm_sync();
+    host_base_cycles = host_ns_to_cycles(host_now_ns);
+    host_base_ns = host_now_ns;
+    host_sys_hz = freq_khz * 1000;
+
+    return true;
+}
+
+// vreg, uart, bootrom, wireless
+
+void vreg_set_voltage(enum vreg_voltage voltage)
+{
+}
+
+uint32_t uart_set_baudrate(uart_inst_t *uart, uint32_t baudrate)
+{
+    return baudrate;
+}
+
+void reset_usb_boot(uint32_t gpio_activity_pin_mask, uint32_t disable_interface_mask)
+{
+}
+
+int cyw43_arch_init(void)
+{
+    return 0;
+}
+
+void cyw43_arch_gpio_put(unsigned wl_gpio, bool value)
+{
+}
+
+// pwm
+
+/**
+ * Host mirror a slice model into its registers
+ *
+ * @param unsigned slice_num
+ * @return void
+ */
+static void host_pwm_store(unsigned slice_num)
+{
+    pwm_model_t *m = &host_pwm[slice_num];
+    pwm_slice_hw_t *hw = &pwm_hw->slice[slice_num];
+
+    hw->csr = m->enabled | (m->ph_correct << 1) | (m->inv[0] << 2) | (m->inv[1] << 3) | (m->divmode << 4);
+    hw->div = m->div;
+    hw->ctr = m->ctr;
+    hw->cc = m->pending.cc[0] | ((u_int32_t) m->pending.cc[1] << PWM_CH0_CC_B_LSB);
+    hw->top = m->pending.top;
+
+    if (m->enabled) {
+        pwm_hw->en |= 1u << slice_num;
+    } else {
+        pwm_hw->en &= ~(1u << slice_num);
+    }
+
+    host_pwm_trace(slice_num, host_now_ns);
+}
+
+unsigned pwm_gpio_to_slice_num(unsigned gpio)
+{
+    return (gpio >> 1) & 7;
+}
+
+unsigned pwm_gpio_to_channel(unsigned gpio)
+{
+    return gpio & 1;
+}
+
+void pwm_set_clkdiv_int_frac(unsigned slice_num, uint8_t integer, uint8_t fract)
+{
+    host_pwm_sync();
+    pwm_model_set_clkdiv_int_frac(&host_pwm[slice_num], integer, fract);
+    host_pwm_store(slice_num);
+}
+
+void pwm_set_wrap(unsigned slice_num, uint16_t wrap)
+{
+    host_pwm_sync();
+    pwm_model_set_wrap(&host_pwm[slice_num], wrap);
+    host_pwm_store(slice_num);
+}
+
+void pwm_set_chan_level(unsigned slice_num, unsigned chan, uint16_t level)
+{
+    host_pwm_sync();
+    pwm_model_set_chan_level(&host_pwm[slice_num], chan, level);
+    host_pwm_store(slice_num);
+}
+
+void pwm_set_enabled(unsigned slice_num, bool enabled)
+{
+    host_pwm_sync();
+    pwm_model_set_enabled(&host_pwm[slice_num], enabled);
+    host_pwm_store(slice_num);
+}
+
+void pwm_set_mask_enabled(uint32_t mask)
+{
+    host_pwm_sync();
+
+    for (u_int8_t s = 0; s < NUM_PWM_SLICES; s++) {
+        pwm_model_set_enabled(&host_pwm[s], mask & (1u << s));
+        host_pwm_store(s);
+    }
+}
+
+void pwm_set_phase_correct(unsigned slice_num, bool phase_correct)
+{
+    host_pwm_sync();
+    pwm_model_set_phase_correct(&host_pwm[slice_num], phase_correct);
+    host_pwm_store(slice_num);
+}
+
+void pwm_set_output_polarity(unsigned slice_num, bool a, bool b)
+{
+    host_pwm_sync();
+    pwm_model_set_output_polarity(&host_pwm[slice_num], a, b);
+    host_pwm_store(slice_num);
+}
+
+void pwm_set_counter(unsigned slice_num, uint16_t c)
+{
+    host_pwm_sync();
+    pwm_model_set_counter(&host_pwm[slice_num], c);
+    host_pwm_store(slice_num);
+}
+
+void pwm_clear_irq(unsigned slice_num)
+{
+}
+
+void pwm_set_irq_enabled(unsigned slice_num, bool enabled)
+{
+}
+
+uint32_t pwm_get_irq_status_mask(void)
+{
+    return pwm_hw->ints;
+}
+
+unsigned pwm_get_dreq(unsigned slice_num)
+{
+    return 24 + slice_num;
+}
+
+pwm_config pwm_get_default_config(void)
+{
+    pwm_config c = { 0, 1 << 4, 0xffff };
+    return c;
+}
+
+void pwm_config_set_clkdiv_mode(pwm_config *c, enum pwm_clkdiv_mode mode)
+{
+    c->csr = (c->csr & ~(3u << 4)) | (mode << 4);
+}
+
+void pwm_config_set_clkdiv_int(pwm_config *c, unsigned div)
+{
+    c->div = div << 4;
+}
+
+void pwm_config_set_wrap(pwm_config *c, uint16_t wrap)
+{
+    c->top = wrap;
+}
+
+void pwm_init(unsigned slice_num, pwm_config *c, bool start)
+{
+    host_pwm_sync();
+    pwm_model_load(&host_pwm[slice_num], c->csr | start, c->div, 0, 0, c->top);
+    host_pwm_store(slice_num);
+}
+
+// dma
+
+int dma_claim_unused_channel(bool required)
+{
+    for (u_int8_t channel = 0; channel < NUM_DMA_CHANNELS; channel++) {
+        if (!(host_dma_claimed & (1u << channel))) {
+            host_dma_claimed |= 1u << channel;
+            return channel;
+        }
+    }
+
+    if (required) {
+        fprintf(stderr, "host: no free DMA channel\n");
+        abort();
+    }
+
+    return -1;
+}
+
+void dma_channel_unclaim(unsigned channel)
+{
+    host_dma_claimed &= ~(1u << channel);
+}
+
+dma_channel_config dma_channel_get_default_config(unsigned channel)
+{
+    // EN, 32-bit, read increment, chained to itself, unpaced
+    dma_channel_config c = { 0x1u | (DMA_SIZE_32 << 2) | (1u << 4) | (channel << 11) | (0x3fu << 15) };
+    return c;
+}
+
+void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size size)
+{
+    c->ctrl = (c->ctrl & ~(3u << 2)) | (size << 2);
+}
+
+void channel_config_set_read_increment(dma_channel_config *c, bool incr)
+{
+    c->ctrl = (c->ctrl & ~(1u << 4)) | (incr << 4);
+}
+
+void channel_config_set_write_increment(dma_channel_config *c, bool incr)
+{
+    c->ctrl = (c->ctrl & ~(1u << 5)) | (incr << 5);
+}
+
+void channel_config_set_dreq(dma_channel_config *c, unsigned dreq)
+{
+    c->ctrl = (c->ctrl & ~(0x3fu << 15)) | (dreq << 15);
+}
+
+void channel_config_set_ring(dma_channel_config *c, bool write, unsigned size_bits)
+{
+    c->ctrl = (c->ctrl & ~(0x1fu << 6)) | (size_bits << 6) | (write << 10);
+}
+
+void channel_config_set_chain_to(dma_channel_config *c, unsigned chain_to)
+{
+    c->ctrl = (c->ctrl & ~(0xfu << 11)) | (chain_to << 11);
+}
+
+uint32_t channel_config_get_ctrl_value(const dma_channel_config *config)
+{
+    return config->ctrl;
+}
+
+void dma_channel_configure(unsigned channel, const dma_channel_config *config, volatile void *write_addr, const volatile void *read_addr, unsigned transfer_count, bool trigger)
+{
+    dma_channel_hw_t *hw = &dma_hw->ch[channel];
+
+    hw->read_addr = (uintptr_t) read_addr;
+    hw->write_addr = (uintptr_t) write_addr;
+    hw->transfer_count = transfer_count;
+    hw->al1_ctrl = config->ctrl;
+}
+
+bool dma_channel_is_busy(unsigned channel)
+{
+    return false;
+}
+
+// pio
+
+bool pio_can_add_program(PIO pio, const pio_program_t *program)
+{
+    return pio->used + program->length <= PIO_INSTRUCTION_COUNT;
+}
+
+unsigned pio_add_program(PIO pio, const pio_program_t *program)
+{
+    unsigned offset = pio->used;
+    pio->used += program->length;
+
+    return offset;
+}
+
+void pio_remove_program(PIO pio, const pio_program_t *program, unsigned loaded_offset)
+{
+    pio->used -= program->length;
+}
+
+int pio_claim_unused_sm(PIO pio, bool required)
+{
+    for (u_int8_t sm = 0; sm < NUM_PIO_STATE_MACHINES; sm++) {
+        if (!(pio->sm_claimed & (1u << sm))) {
+            pio->sm_claimed |= 1u << sm;
+            return sm;
+        }
+    }
+
+    if (required) {
+        fprintf(stderr, "host: no free PIO state machine\n");
+        abort();
+    }
+
+    return -1;
+}
+
+void pio_sm_unclaim(PIO pio, unsigned sm)
+{
+    pio->sm_claimed &= ~(1u << sm);
+}
+
+void pio_sm_set_enabled(PIO pio, unsigned sm, bool enabled)
+{
+}
+
+void pio_sm_init(PIO pio, unsigned sm, unsigned initial_pc, const pio_sm_config *config)
+{
+}
+
+void pio_sm_set_consecutive_pindirs(PIO pio, unsigned sm, unsigned pin_base, unsigned pin_count, bool is_out)
+{
+}
+
+void pio_sm_clear_fifos(PIO pio, unsigned sm)
+{
+}
+
+void pio_sm_put_blocking(PIO pio, unsigned sm, uint32_t data)
+{
+    pio->txf[sm] = data;
+}
+
+void pio_sm_exec(PIO pio, unsigned sm, unsigned instr)
+{
+}
+
+void pio_gpio_init(PIO pio, unsigned pin)
+{
+    gpio_set_function(pin, pio == pio0 ? GPIO_FUNC_PIO0 : GPIO_FUNC_PIO1);
+}
+
+unsigned pio_get_dreq(PIO pio, unsigned sm, bool is_tx)
+{
+    return (pio == pio0 ? 0 : 8) + sm + (is_tx ? 0 : 4);
+}
+
+unsigned pio_encode_pull(bool if_empty, bool block)
+{
+    return 0x8080 | (if_empty << 6) | (block << 5);
+}
+
+unsigned pio_encode_mov(enum pio_src_dest dest, enum pio_src_dest src)
+{
+    return 0xa000 | ((dest & 7) << 5) | (src & 7);
+}
+
+void sm_config_set_sideset_pins(pio_sm_config *c, unsigned sideset_base)
+{
+}
+
+void sm_config_set_in_pins(pio_sm_config *c, unsigned in_base)
+{
+}
+
+void sm_config_set_clkdiv_int_frac(pio_sm_config *c, uint16_t div_int, uint8_t div_frac)
+{
+    c->clkdiv = (div_int << 16) | (div_frac << 8);
+}
+
+void sm_config_set_out_shift(pio_sm_config *c, bool shift_right, bool autopull, unsigned pull_threshold)
+{
+}
+
+void sm_config_set_fifo_join(pio_sm_config *c, unsigned join)
+{
+}
+
+// adc
+
+void adc_init(void)
+{
+}
+
+void adc_gpio_init(unsigned gpio)
+{
+    gpio_set_function(gpio, GPIO_FUNC_NULL);
+}
+
+void adc_select_input(unsigned input)
+{
+    host_adc_input = input % 5;
+    host_adc_fill();
+}
+
+void adc_fifo_setup(bool en, bool dreq_en, uint16_t dreq_thresh, bool err_in_fifo, bool byte_shift)
+{
+}
+
+void adc_run(bool run)
+{
+    host_adc_running = run;
+    host_adc_fill();
+}
+
+void adc_fifo_drain(void)
+{
+}
+
+// flash
+
+void flash_range_erase(uint32_t flash_offs, size_t count)
+{
+    memset(host_flash + flash_offs, 0xff, count);
+}
+
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count)
+{
+    memcpy(host_flash + flash_offs, data, count);
+}
@@ -0,0 +1,343 @@
+#ifndef HOST_SDK_H
+#define HOST_SDK_H
+
+// Host stand-in for the parts of the Pico SDK the firmware uses. Every
+// SDK header the firmware includes is generated as a one-line include
+// of this file by test/CMakeLists.txt.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/types.h>
+
+// registers are as wide as a pointer, so DMA addresses survive a 64-bit host
+typedef volatile uintptr_t io_rw_32;
+
+#define PICO_ERROR_TIMEOUT -1
+#define PICO_FLASH_SIZE_BYTES (2 * 1024 * 1024)
+#define PICO_DEFAULT_UART_BAUD_RATE 115200
+#define PICO_HIGHEST_IRQ_PRIORITY 0x00
+#define PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY 0x80
+#define LIB_PICO_STDIO_UART 1
+
+#define MHZ 1000000
+#define NUM_BANK0_GPIOS 30
+
+#define __not_in_flash_func(f) f
+#define __time_critical_func(f) f
+
+// time
+
+typedef int32_t alarm_id_t;
+typedef struct repeating_timer repeating_timer_t;
+typedef bool (*repeating_timer_callback_t)(repeating_timer_t *rt);
+
+struct repeating_timer {
+    int64_t delay_us;
+    alarm_id_t alarm_id;
+    repeating_timer_callback_t callback;
+    void *user_data;
+};
+
+bool add_repeating_timer_us(int64_t delay_us, repeating_timer_callback_t callback, void *user_data, repeating_timer_t *out);
+bool add_repeating_timer_ms(int32_t delay_ms, repeating_timer_callback_t callback, void *user_data, repeating_timer_t *out);
+bool cancel_repeating_timer(repeating_timer_t *timer);
+uint64_t time_us_64(void);
+uint32_t time_us_32(void);
+void sleep_ms(uint32_t ms);
+void busy_wait_us(uint64_t us);
+void busy_wait_at_least_cycles(uint32_t cycles);
+void tight_loop_contents(void);
+
+// stdio
+
+bool stdio_init_all(void);
+void stdio_flush(void);
+int getchar_timeout_us(uint32_t timeout_us);
+
+// sync and irq
+
+#define __compiler_memory_barrier() __asm__ volatile ("" : : : "memory")
+
+uint32_t save_and_disable_interrupts(void);
+void restore_interrupts(uint32_t status);
+void hw_set_bits(io_rw_32 *addr, uint32_t mask);
+void hw_clear_bits(io_rw_32 *addr, uint32_t mask);
+void irq_add_shared_handler(unsigned num, void (*handler)(void), uint8_t order_priority);
+void irq_remove_handler(unsigned num, void (*handler)(void));
+void irq_set_enabled(unsigned num, bool enabled);
+void irq_set_priority(unsigned num, uint8_t priority);
+
+#define PWM_IRQ_WRAP 4
+
+// gpio
+
+#define GPIO_OUT 1
+#define GPIO_IN 0
+
+enum gpio_function {
+    GPIO_FUNC_SIO = 5,
+    GPIO_FUNC_PIO0 = 6,
+    GPIO_FUNC_PIO1 = 7,
+    GPIO_FUNC_PWM = 4,
+    GPIO_FUNC_GPCK = 8,
+    GPIO_FUNC_NULL = 0x1f
+};
+
+void gpio_init(unsigned gpio);
+void gpio_set_dir(unsigned gpio, bool out);
+void gpio_put(unsigned gpio, bool value);
+void gpio_set_function(unsigned gpio, enum gpio_function fn);
+void gpio_pull_down(unsigned gpio);
+void gpio_disable_pulls(unsigned gpio);
+
+// clocks
+
+enum clock_index { clk_gpout0, clk_gpout1, clk_gpout2, clk_gpout3, clk_ref, clk_sys, clk_peri, clk_usb, clk_adc, clk_rtc, CLK_COUNT };
+
+#define CLOCKS_CLK_GPOUT0_CTRL_AUXSRC_VALUE_CLK_SYS 6
+#define CLOCKS_CLK_GPOUT0_CTRL_AUXSRC_VALUE_CLK_USB 7
+#define CLOCKS_CLK_GPOUT0_CTRL_DC50_BITS 0x1000u
+#define CLOCKS_CLK_PERI_CTRL_AUXSRC_VALUE_CLKSRC_PLL_USB 2
+
+typedef struct {
+    io_rw_32 ctrl;
+    io_rw_32 div;
+    io_rw_32 selected;
+} clock_hw_t;
+
+typedef struct {
+    clock_hw_t clk[CLK_COUNT];
+} clocks_hw_t;
+
+extern clocks_hw_t *clocks_hw;
+
+uint32_t clock_get_hz(enum clock_index clk_index);
+bool clock_configure(enum clock_index clk_index, uint32_t src, uint32_t auxsrc, uint32_t src_freq, uint32_t freq);
+void clock_gpio_init_int_frac(unsigned gpio, unsigned src, uint32_t div_int, uint8_t div_frac);
+void clock_stop(enum clock_index clk_index);
+bool set_sys_clock_khz(uint32_t freq_khz, bool required);
+
+// vreg, uart, bootrom, wireless
+
+enum vreg_voltage { VREG_VOLTAGE_1_10 = 0b1011, VREG_VOLTAGE_1_15 = 0b1100 };
+
+typedef struct uart_inst uart_inst_t;
+extern uart_inst_t *uart_default_inst;
+#define uart_default uart_default_inst
+
+void vreg_set_voltage(enum vreg_voltage voltage);
+uint32_t uart_set_baudrate(uart_inst_t *uart, uint32_t baudrate);
+void reset_usb_boot(uint32_t gpio_activity_pin_mask, uint32_t disable_interface_mask);
+
+#define CYW43_WL_GPIO_LED_PIN 0
+
+int cyw43_arch_init(void);
+void cyw43_arch_gpio_put(unsigned wl_gpio, bool value);
+
+// pwm
+
+#define NUM_PWM_SLICES 8
+#define PWM_CH0_CC_B_LSB 16u
+
+enum pwm_clkdiv_mode { PWM_DIV_FREE_RUNNING, PWM_DIV_B_HIGH, PWM_DIV_B_RISING, PWM_DIV_B_FALLING };
+enum pwm_chan { PWM_CHAN_A = 0, PWM_CHAN_B = 1 };
+
+typedef struct {
+    uint32_t csr;
+    uint32_t div;
+    uint32_t top;
+} pwm_config;
+
+typedef struct {
+    io_rw_32 csr;
+    io_rw_32 div;
+    io_rw_32 ctr;
+    io_rw_32 cc;
+    io_rw_32 top;
+} pwm_slice_hw_t;
+
+typedef struct {
+    pwm_slice_hw_t slice[NUM_PWM_SLICES];
+    io_rw_32 en;
+    io_rw_32 intr;
+    io_rw_32 inte;
+    io_rw_32 intf;
+    io_rw_32 ints;
+} pwm_hw_t;
+
+extern pwm_hw_t *pwm_hw;
+
+unsigned pwm_gpio_to_slice_num(unsigned gpio);
+unsigned pwm_gpio_to_channel(unsigned gpio);
+void pwm_set_clkdiv_int_frac(unsigned slice_num, uint8_t integer, uint8_t fract);
+void pwm_set_wrap(unsigned slice_num, uint16_t wrap);
+void pwm_set_chan_level(unsigned slice_num, unsigned chan, uint16_t level);
+void pwm_set_enabled(unsigned slice_num, bool enabled);
+void pwm_set_mask_enabled(uint32_t mask);
+void pwm_set_phase_correct(unsigned slice_num, bool phase_correct);
+void pwm_set_output_polarity(unsigned slice_num, bool a, bool b);
+void pwm_set_counter(unsigned slice_num, uint16_t c);
+void pwm_clear_irq(unsigned slice_num);
+void pwm_set_irq_enabled(unsigned slice_num, bool enabled);
+uint32_t pwm_get_irq_status_mask(void);
+unsigned pwm_get_dreq(unsigned slice_num);
+pwm_config pwm_get_default_config(void);
+void pwm_config_set_clkdiv_mode(pwm_config *c, enum pwm_clkdiv_mode mode);
+void pwm_config_set_clkdiv_int(pwm_config *c, unsigned div);
+void pwm_config_set_wrap(pwm_config *c, uint16_t wrap);
+void pwm_init(unsigned slice_num, pwm_config *c, bool start);
+
+// dma
+
+#define NUM_DMA_CHANNELS 12
+#define DMA_CH0_CTRL_TRIG_EN_BITS 0x1u
+#define DREQ_ADC 36
+
+enum dma_channel_transfer_size { DMA_SIZE_8 = 0, DMA_SIZE_16 = 1, DMA_SIZE_32 = 2 };
+
+typedef struct {
+    uint32_t ctrl;
+} dma_channel_config;
+
+typedef struct {
+    io_rw_32 read_addr;
+    io_rw_32 write_addr;
+    io_rw_32 transfer_count;
+    io_rw_32 ctrl_trig;
+    io_rw_32 al1_ctrl;
+    io_rw_32 al1_read_addr;
+    io_rw_32 al1_write_addr;
+    io_rw_32 al1_transfer_count_trig;
+    io_rw_32 al2_ctrl;
+    io_rw_32 al2_transfer_count;
+    io_rw_32 al2_read_addr;
+    io_rw_32 al2_write_addr_trig;
+    io_rw_32 al3_ctrl;
+    io_rw_32 al3_write_addr;
+    io_rw_32 al3_transfer_count;
+    io_rw_32 al3_read_addr_trig;
+} dma_channel_hw_t;
+
+typedef struct {
+    dma_channel_hw_t ch[NUM_DMA_CHANNELS];
+    io_rw_32 abort;
+} dma_hw_t;
+
+extern dma_hw_t *dma_hw;
+
+int dma_claim_unused_channel(bool required);
+void dma_channel_unclaim(unsigned channel);
+dma_channel_config dma_channel_get_default_config(unsigned channel);
+void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size size);
+void channel_config_set_read_increment(dma_channel_config *c, bool incr);
+void channel_config_set_write_increment(dma_channel_config *c, bool incr);
+void channel_config_set_dreq(dma_channel_config *c, unsigned dreq);
+void channel_config_set_ring(dma_channel_config *c, bool write, unsigned size_bits);
+void channel_config_set_chain_to(dma_channel_config *c, unsigned chain_to);
+uint32_t channel_config_get_ctrl_value(const dma_channel_config *config);
+void dma_channel_configure(unsigned channel, const dma_channel_config *config, volatile void *write_addr, const volatile void *read_addr, unsigned transfer_count, bool trigger);
+bool dma_channel_is_busy(unsigned channel);
+
+// pio
+
+#define NUM_PIO_STATE_MACHINES 4
+#define PIO_INSTRUCTION_COUNT 32
+#define PIO_FIFO_JOIN_TX 1
+
+enum pio_src_dest { pio_pins = 0, pio_x = 1, pio_y = 2, pio_null = 3, pio_pindirs = 4, pio_exec_mov = 5, pio_status = 6, pio_pc = 7, pio_isr = 8, pio_osr = 9 };
+
+typedef struct {
+    io_rw_32 txf[NUM_PIO_STATE_MACHINES];
+    io_rw_32 rxf[NUM_PIO_STATE_MACHINES];
+    uint8_t sm_claimed;
+    uint8_t used;
+} pio_hw_t;
+
+typedef pio_hw_t *PIO;
+
+extern PIO pio0;
+extern PIO pio1;
+
+typedef struct {
+    uint32_t clkdiv;
+    uint32_t execctrl;
+    uint32_t shiftctrl;
+    uint32_t pinctrl;
+} pio_sm_config;
+
+typedef struct pio_program {
+    const uint16_t *instructions;
+    uint8_t length;
+    int8_t origin;
+} pio_program_t;
+
+bool pio_can_add_program(PIO pio, const pio_program_t *program);
+unsigned pio_add_program(PIO pio, const pio_program_t *program);
+void pio_remove_program(PIO pio, const pio_program_t *program, unsigned loaded_offset);
+int pio_claim_unused_sm(PIO pio, bool required);
+void pio_sm_unclaim(PIO pio, unsigned sm);
+void pio_sm_set_enabled(PIO pio, unsigned sm, bool enabled);
+void pio_sm_init(PIO pio, unsigned sm, unsigned initial_pc, const pio_sm_config *config);
+void pio_sm_set_consecutive_pindirs(PIO pio, unsigned sm, unsigned pin_base, unsigned pin_count, bool is_out);
+void pio_sm_clear_fifos(PIO pio, unsigned sm);
+void pio_sm_put_blocking(PIO pio, unsigned sm, uint32_t data);
+void pio_sm_exec(PIO pio, unsigned sm, unsigned instr);
+void pio_gpio_init(PIO pio, unsigned pin);
+unsigned pio_get_dreq(PIO pio, unsigned sm, bool is_tx);
+unsigned pio_encode_pull(bool if_empty, bool block);
+unsigned pio_encode_mov(enum pio_src_dest dest, enum pio_src_dest src);
+void sm_config_set_sideset_pins(pio_sm_config *c, unsigned sideset_base);
+void sm_config_set_in_pins(pio_sm_config *c, unsigned in_base);
+void sm_config_set_clkdiv_int_frac(pio_sm_config *c, uint16_t div_int, uint8_t div_frac);
+void sm_config_set_out_shift(pio_sm_config *c, bool shift_right, bool autopull, unsigned pull_threshold);
+void sm_config_set_fifo_join(pio_sm_config *c, unsigned join);
+
+// adc
+
+#define ADC_DIV_INT_LSB 8
+
+typedef struct {
+    io_rw_32 cs;
+    io_rw_32 result;
+    io_rw_32 fcs;
+    io_rw_32 fifo;
+    io_rw_32 div;
+} adc_hw_t;
+
+extern adc_hw_t *adc_hw;
+
+void adc_init(void);
+void adc_gpio_init(unsigned gpio);
+void adc_select_input(unsigned input);
+void adc_fifo_setup(bool en, bool dreq_en, uint16_t dreq_thresh, bool err_in_fifo, bool byte_shift);
+void adc_run(bool run);
+void adc_fifo_drain(void);
+
+// flash, mapped to host memory
+
+#define FLASH_SECTOR_SIZE 4096u
+#define FLASH_PAGE_SIZE 256u
+
+extern uint8_t host_flash[PICO_FLASH_SIZE_BYTES];
+#define XIP_BASE ((uintptr_t) host_flash)
+
+void flash_range_erase(uint32_t flash_offs, size_t count);
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count);
+
+// systick
+
+#define M0PLUS_SYST_CSR_ENABLE_BITS 0x1u
+#define M0PLUS_SYST_CSR_CLKSOURCE_BITS 0x4u
+
+typedef struct {
+    io_rw_32 csr;
+    io_rw_32 rvr;
+    io_rw_32 cvr;
+    io_rw_32 calib;
+} systick_hw_t;
+
+extern systick_hw_t *systick_hw;
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef PATTERN_PIO_H
+#define PATTERN_PIO_H
+
+// Host stand-in for the header pioasm generates from src/pattern.pio,
+// the instructions are placeholders of the right length
+
+#include "host_sdk.h"
+
+static const uint16_t pattern_program_instructions[4] = { 0 };
+
+static const struct pio_program pattern_program = {
+    .instructions = pattern_program_instructions,
+    .length = 4,
+    .origin = -1,
+};
+
+static inline pio_sm_config pattern_program_get_default_config(unsigned offset)
+{
+    pio_sm_config c = { 0 };
+    return c;
+}
+
+#endif
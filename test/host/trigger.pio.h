@@ -0,0 +1,37 @@
+#ifndef TRIGGER_PIO_H
+#define TRIGGER_PIO_H
+
+// Host stand-in for the header pioasm generates from src/trigger.pio,
+// the instructions are placeholders of the right length
+
+#include "host_sdk.h"
+
+static const uint16_t gate_program_instructions[5] = { 0 };
+
+static const struct pio_program gate_program = {
+    .instructions = gate_program_instructions,
+    .length = 5,
+    .origin = -1,
+};
+
+static inline pio_sm_config gate_program_get_default_config(unsigned offset)
+{
+    pio_sm_config c = { 0 };
+    return c;
+}
+
+static const uint16_t burst_program_instructions[8] = { 0 };
+
+static const struct pio_program burst_program = {
+    .instructions = burst_program_instructions,
+    .length = 8,
+    .origin = -1,
+};
+
+static inline pio_sm_config burst_program_get_default_config(unsigned offset)
+{
+    pio_sm_config c = { 0 };
+    return c;
+}
+
+#endif
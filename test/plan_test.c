@@ -0,0 +1,175 @@
+#include "plan.h"
+#include "test.h"
+
+// the flash table is static, so its translation unit is built in here
+#include "plan_cache.c"
+
+// default sys clock
+#define TEST_SYS_HZ 125000000
+
+/**
+ * Test the fastest plan runs the divider at 1.0 with two counter steps
+ * 
+ * @return void
+ */
+static void test_solve_div_one()
+{
+    plan_t plan;
+
+    TEST_ASSERT(plan_solve(TEST_SYS_HZ, 62500000, 1, 500000, false, &plan));
+    TEST_EQ(plan.div_int, 1);
+    TEST_EQ(plan.div_frac, 0);
+    TEST_EQ(plan.top, PLAN_PERIOD_MIN - 1);
+    TEST_EQ(plan.level, 1);
+    TEST_EQ(plan.error_ppb, 0);
+}
+
+/**
+ * Test the slowest plan stops at 255.9375, short of the 256 an integer
+ * part of 0 means
+ * 
+ * @return void
+ */
+static void test_solve_div_max()
+{
+    plan_t plan;
+
+    // 125MHz / (255.9375 * 65535) is just under 7.453Hz
+    TEST_ASSERT(plan_solve(TEST_SYS_HZ, 7453, 1000, 500000, false, &plan));
+    TEST_EQ(plan_get_div(&plan), PLAN_DIV_MAX);
+    TEST_ASSERT(plan.div_int != 0);
+
+    TEST_ASSERT(!plan_solve(TEST_SYS_HZ, 7452, 1000, 500000, false, &plan));
+    TEST_ASSERT(!plan_fit(TEST_SYS_HZ, 10000, PLAN_DIV_MAX + 1, 500000, false, &plan));
+    TEST_ASSERT(!plan_fit(TEST_SYS_HZ, 10000, PLAN_DIV_MIN - 1, 500000, false, &plan));
+}
+
+/**
+ * Test the longest period keeps TOP at 65534 so 100% duty fits CC
+ * 
+ * @return void
+ */
+static void test_solve_top_max()
+{
+    plan_t plan;
+
+    // exactly PLAN_PERIOD_MAX steps at a divider of 1.0
+    TEST_ASSERT(plan_solve(TEST_SYS_HZ, TEST_SYS_HZ, PLAN_PERIOD_MAX, 1000000, false, &plan));
+    TEST_EQ(plan_get_div(&plan), 16);
+    TEST_EQ(plan.top, PLAN_PERIOD_MAX - 1);
+    TEST_EQ(plan.level, PLAN_PERIOD_MAX);
+    TEST_EQ(plan.error_ppb, 0);
+
+    // one step more needs a larger divider, never a TOP of 65535
+    TEST_ASSERT(plan_solve(TEST_SYS_HZ, TEST_SYS_HZ, PLAN_PERIOD_MAX + 1, 1000000, false, &plan));
+    TEST_ASSERT(plan_get_div(&plan) > 16);
+    TEST_ASSERT(plan.top <= PLAN_PERIOD_MAX - 1);
+
+    TEST_ASSERT(!plan_fit(TEST_SYS_HZ, (u_int64_t) TEST_SYS_HZ * 1000 / (PLAN_PERIOD_MAX + 1), 16, 500000, false, &plan));
+}
+
+/**
+ * Test a phase-correct plan counts up and down, half the steps of a
+ * trailing-edge plan for the same frequency
+ * 
+ * @return void
+ */
+static void test_solve_phase_correct()
+{
+    plan_t trailing, doubled, plan;
+
+    TEST_ASSERT(plan_solve(TEST_SYS_HZ, 1000000, 1000, 250000, true, &plan));
+    TEST_ASSERT(plan_solve(TEST_SYS_HZ, 2000000, 1000, 250000, false, &doubled));
+    TEST_ASSERT(plan.ph_correct);
+    TEST_EQ(plan_get_div(&plan), plan_get_div(&doubled));
+    TEST_EQ(plan.top, doubled.top);
+    TEST_EQ(plan.level, doubled.level);
+    TEST_EQ(plan_get_freq_mhz(&plan, TEST_SYS_HZ), 1000000);
+
+    TEST_ASSERT(plan_solve(TEST_SYS_HZ, 1000000, 1000, 250000, false, &trailing));
+    TEST_EQ(plan_get_freq_mhz(&trailing, TEST_SYS_HZ), 1000000);
+    TEST_ASSERT((u_int32_t) plan_get_div(&plan) * (plan.top + 1) * 2 == (u_int32_t) plan_get_div(&trailing) * (trailing.top + 1));
+
+    // the top of the trailing-edge range is out of reach counting both ways
+    TEST_ASSERT(plan_solve(TEST_SYS_HZ, 62500000, 1, 500000, false, &plan));
+    TEST_ASSERT(!plan_solve(TEST_SYS_HZ, 62500000, 1, 500000, true, &plan));
+    TEST_ASSERT(plan_fit(TEST_SYS_HZ, 1000000, 16, 500000, true, &plan));
+    TEST_EQ(plan.top, 62499);
+}
+
+/**
+ * Test requests no divider and wrap can produce are refused
+ * 
+ * @return void
+ */
+static void test_solve_infeasible()
+{
+    plan_t plan;
+
+    TEST_ASSERT(!plan_solve(TEST_SYS_HZ, 0, 1000, 500000, false, &plan));
+    TEST_ASSERT(!plan_solve(TEST_SYS_HZ, 1000, 0, 500000, false, &plan));
+    TEST_ASSERT(!plan_solve(TEST_SYS_HZ, 90000000, 1, 500000, false, &plan));
+    TEST_ASSERT(!plan_solve(TEST_SYS_HZ, 1, 1, 500000, false, &plan));
+    TEST_ASSERT(!plan_fit(TEST_SYS_HZ, 0, 16, 500000, false, &plan));
+    TEST_ASSERT(!plan_fit(TEST_SYS_HZ, 90000000000ULL, 16, 500000, false, &plan));
+}
+
+/**
+ * Test every flash table entry is what plan_solve() gives for it
+ * 
+ * The table is written by hand from solver output, so it goes stale
+ * whenever the solver changes and a hit would program another plan than
+ * a miss.
+ * 
+ * @return void
+ */
+static void test_cache_rom_matches_solver()
+{
+    for (size_t i = 0; i < sizeof(plan_cache_rom) / sizeof(plan_cache_rom[0]); i++) {
+        const plan_cache_entry_t *entry = &plan_cache_rom[i];
+        plan_t plan;
+
+        TEST_ASSERT(plan_solve(PLAN_CACHE_ROM_SYS_HZ, entry->mhz, 1000, 500000, false, &plan));
+        TEST_EQ(entry->div_int, plan.div_int);
+        TEST_EQ(entry->div_frac, plan.div_frac);
+        TEST_EQ(entry->top, plan.top);
+        TEST_EQ(entry->error_ppb, plan.error_ppb);
+    }
+}
+
+/**
+ * Test a flash hit loads the same plan as the solver, level included
+ * 
+ * @return void
+ */
+static void test_cache_rom_hit()
+{
+    plan_cache_stats_t stats;
+    plan_t cached, solved;
+
+    plan_cache_reset();
+
+    TEST_ASSERT(plan_cache_solve(PLAN_CACHE_ROM_SYS_HZ, 10000000000ULL, 250000, false, true, &cached));
+    TEST_ASSERT(plan_solve(PLAN_CACHE_ROM_SYS_HZ, 10000000000ULL, 1000, 250000, false, &solved));
+    TEST_EQ(cached.div_int, solved.div_int);
+    TEST_EQ(cached.div_frac, solved.div_frac);
+    TEST_EQ(cached.top, solved.top);
+    TEST_EQ(cached.level, solved.level);
+
+    plan_cache_get_stats(&stats);
+    TEST_EQ(stats.rom_hits, 1);
+    TEST_EQ(stats.misses, 0);
+}
+
+int main()
+{
+    TEST_RUN(test_solve_div_one);
+    TEST_RUN(test_solve_div_max);
+    TEST_RUN(test_solve_top_max);
+    TEST_RUN(test_solve_phase_correct);
+    TEST_RUN(test_solve_infeasible);
+    TEST_RUN(test_cache_rom_matches_solver);
+    TEST_RUN(test_cache_rom_hit);
+
+    return test_status();
+}
@@ -0,0 +1,368 @@
+#include <string.h>
+#include "pwm_model.h"
+#include "test.h"
+
+/**
+ * Test set up an enabled free-running slice
+ * 
+ * TOP and the A level are written before the enable, so they latch at
+ * once rather than at the first wrap.
+ * 
+ * @param pwm_model_t *m
+ * @param u_int8_t div_int
+ * @param u_int8_t div_frac
+ * @param u_int16_t top
+ * @param u_int16_t level
+ * @param bool ph_correct
+ * @return void
+ */
+static void test_slice(pwm_model_t *m, u_int8_t div_int, u_int8_t div_frac, u_int16_t top, u_int16_t level, bool ph_correct)
+{
+    pwm_model_init(m);
+    pwm_model_set_clkdiv_int_frac(m, div_int, div_frac);
+    pwm_model_set_phase_correct(m, ph_correct);
+    pwm_model_set_wrap(m, top);
+    pwm_model_set_chan_level(m, PWM_MODEL_CHAN_A, level);
+    pwm_model_set_enabled(m, true);
+}
+
+/**
+ * Test the reset values from the datasheet (DIV 1.0, TOP 0xffff, disabled)
+ * 
+ * @return void
+ */
+static void test_reset_values()
+{
+    pwm_model_t m;
+    pwm_model_init(&m);
+
+    TEST_EQ(m.div, 1 << 4);
+    TEST_EQ(m.active.top, 0xffff);
+    TEST_ASSERT(!m.enabled);
+
+    // a disabled slice does not count
+    pwm_model_run(&m, 1000, false);
+    TEST_EQ(m.ctr, 0);
+    TEST_EQ(m.cycles, 1000);
+}
+
+/**
+ * Test the 8.4 fractional divider
+ * 
+ * A divider of 2.5 counts every 2.5 sys clock cycles on average, and an
+ * integer part of 0 divides by 256.
+ * 
+ * @return void
+ */
+static void test_divider_8_4()
+{
+    pwm_model_t m;
+
+    test_slice(&m, 2, 8, 9, 0, false);
+    TEST_EQ(pwm_model_get_period_x16(&m), 10 * 40);
+    TEST_EQ(pwm_model_get_freq_mhz(&m, 125000000), 5000000000ULL);
+
+    pwm_model_run(&m, 250, false);
+    TEST_EQ(m.wraps, 10);
+    TEST_EQ(m.ctr, 0);
+
+    // the counts of a 2.5 divider are 2 and 3 cycles apart
+    test_slice(&m, 2, 8, 0xffff, 0, false);
+    u_int16_t last = 0;
+    u_int32_t gap = 0;
+    u_int32_t gaps[2] = { 0, 0 };
+
+    for (u_int32_t i = 0; i < 100; i++) {
+        pwm_model_tick(&m, false);
+        gap++;
+
+        if (m.ctr != last) {
+            TEST_ASSERT(gap == 2 || gap == 3);
+            gaps[gap - 2]++;
+            last = m.ctr;
+            gap = 0;
+        }
+    }
+
+    TEST_EQ(gaps[0], gaps[1]);
+    TEST_EQ(m.ctr, 40);
+
+    // integer part 0 is 256
+    test_slice(&m, 0, 0, 0, 0, false);
+    TEST_EQ(m.div, 256 << 4);
+    pwm_model_run(&m, 256 * 3, false);
+    TEST_EQ(m.wraps, 3);
+
+    // the largest divider, 255 15/16
+    test_slice(&m, 255, 15, 0, 0, false);
+    TEST_EQ(pwm_model_get_period_x16(&m), 4095);
+}
+
+/**
+ * Test trailing-edge counting: period TOP + 1, high while CTR < CC
+ * 
+ * @return void
+ */
+static void test_trailing_edge()
+{
+    pwm_model_t m;
+    test_slice(&m, 1, 0, 9, 3, false);
+
+    TEST_EQ(pwm_model_get_period_counts(&m), 10);
+
+    u_int32_t high = 0;
+    for (u_int32_t i = 0; i < 100; i++) {
+        high += pwm_model_get_output(&m, PWM_MODEL_CHAN_A);
+        pwm_model_tick(&m, false);
+    }
+
+    TEST_EQ(high, 30);
+    TEST_EQ(m.wraps, 10);
+    TEST_EQ(pwm_model_get_duty_ppm(&m, PWM_MODEL_CHAN_A), 300000);
+
+    // CC above TOP stays high, CC 0 stays low
+    pwm_model_set_chan_level(&m, PWM_MODEL_CHAN_A, 10);
+    pwm_model_set_chan_level(&m, PWM_MODEL_CHAN_B, 0);
+    pwm_model_run(&m, 10, false);
+
+    for (u_int32_t i = 0; i < 10; i++) {
+        TEST_ASSERT(pwm_model_get_output(&m, PWM_MODEL_CHAN_A));
+        TEST_ASSERT(!pwm_model_get_output(&m, PWM_MODEL_CHAN_B));
+        pwm_model_tick(&m, false);
+    }
+
+    // inversion flips the output and the duty cycle
+    pwm_model_set_chan_level(&m, PWM_MODEL_CHAN_A, 3);
+    pwm_model_set_output_polarity(&m, true, false);
+    pwm_model_run(&m, 10, false);
+    TEST_EQ(pwm_model_get_duty_ppm(&m, PWM_MODEL_CHAN_A), 700000);
+    TEST_ASSERT(!pwm_model_get_output(&m, PWM_MODEL_CHAN_A));
+}
+
+/**
+ * Test phase-correct counting: period 2 * (TOP + 1), symmetric pulse
+ * 
+ * @return void
+ */
+static void test_phase_correct()
+{
+    pwm_model_t m;
+    test_slice(&m, 1, 0, 99, 50, true);
+
+    TEST_EQ(pwm_model_get_period_counts(&m), 200);
+    TEST_EQ(pwm_model_get_freq_mhz(&m, 125000000), 625000000ULL);
+
+    u_int32_t high = 0;
+    u_int16_t peak = 0;
+
+    for (u_int32_t i = 0; i < 200; i++) {
+        pwm_model_tick(&m, false);
+        high += pwm_model_get_output(&m, PWM_MODEL_CHAN_A);
+        peak = m.ctr > peak ? m.ctr : peak;
+    }
+
+    TEST_EQ(high, 100);
+    TEST_EQ(peak, 99);
+    TEST_EQ(m.wraps, 1);
+    TEST_EQ(m.ctr, 0);
+    TEST_ASSERT(!m.down);
+
+    // the analytical run lands on the same wrap
+    test_slice(&m, 1, 0, 99, 0, true);
+    pwm_model_run(&m, 200 * 7 + 150, false);
+    TEST_EQ(m.wraps, 7);
+    TEST_ASSERT(m.down);
+    TEST_EQ(m.ctr, 49);
+}
+
+/**
+ * Test TOP and CC latch at the wrap while the slice runs
+ * 
+ * @return void
+ */
+static void test_latch_at_wrap()
+{
+    pwm_model_t m;
+    test_slice(&m, 1, 0, 99, 50, false);
+
+    pwm_model_run(&m, 10, false);
+    TEST_EQ(m.ctr, 10);
+
+    pwm_model_set_wrap(&m, 49);
+    pwm_model_set_chan_level(&m, PWM_MODEL_CHAN_A, 20);
+    TEST_EQ(m.active.top, 99);
+    TEST_EQ(m.active.cc[PWM_MODEL_CHAN_A], 50);
+
+    // the running period finishes on the old values
+    pwm_model_run(&m, 89, false);
+    TEST_EQ(m.ctr, 99);
+    TEST_EQ(m.active.top, 99);
+    TEST_ASSERT(!pwm_model_get_output(&m, PWM_MODEL_CHAN_A));
+
+    pwm_model_tick(&m, false);
+    TEST_EQ(m.ctr, 0);
+    TEST_EQ(m.active.top, 49);
+    TEST_EQ(m.active.cc[PWM_MODEL_CHAN_A], 20);
+
+    // a fast-forward across the wrap latches too
+    test_slice(&m, 1, 0, 99, 0, false);
+    pwm_model_run(&m, 10, false);
+    pwm_model_set_wrap(&m, 49);
+    pwm_model_run(&m, 90 + 50 * 2, false);
+    TEST_EQ(m.wraps, 3);
+    TEST_EQ(m.ctr, 0);
+
+    // the divider is not buffered and applies at once
+    test_slice(&m, 1, 0, 99, 0, false);
+    pwm_model_run(&m, 10, false);
+    pwm_model_set_clkdiv_int_frac(&m, 2, 0);
+    pwm_model_run(&m, 20, false);
+    TEST_EQ(m.ctr, 20);
+
+    // a disabled slice latches on the write
+    pwm_model_init(&m);
+    pwm_model_set_wrap(&m, 5);
+    pwm_model_set_chan_level(&m, PWM_MODEL_CHAN_B, 3);
+    TEST_EQ(m.active.top, 5);
+    TEST_EQ(m.active.cc[PWM_MODEL_CHAN_B], 3);
+}
+
+/**
+ * Test the B pin divider modes
+ * 
+ * B high gates the divider, the edge modes count one divider input per
+ * rising or falling edge, and the B output is off in all three.
+ * 
+ * @return void
+ */
+static void test_b_pin_modes()
+{
+    pwm_model_t m;
+
+    test_slice(&m, 1, 0, 1000, 0, false);
+    pwm_model_set_clkdiv_mode(&m, PWM_MODEL_DIV_B_HIGH);
+    pwm_model_run(&m, 100, false);
+    TEST_EQ(m.ctr, 0);
+    pwm_model_run(&m, 100, true);
+    TEST_EQ(m.ctr, 100);
+
+    for (u_int32_t i = 0; i < 10; i++) {
+        pwm_model_tick(&m, i % 2 == 0);
+    }
+    TEST_EQ(m.ctr, 105);
+
+    test_slice(&m, 1, 0, 1000, 0, false);
+    pwm_model_set_clkdiv_mode(&m, PWM_MODEL_DIV_B_RISING);
+    for (u_int32_t i = 0; i < 10; i++) {
+        pwm_model_tick(&m, true);
+        pwm_model_tick(&m, true);
+        pwm_model_tick(&m, false);
+    }
+    TEST_EQ(m.ctr, 10);
+
+    // a level held over a fast-forward is one edge
+    pwm_model_run(&m, 100, true);
+    pwm_model_run(&m, 100, true);
+    TEST_EQ(m.ctr, 11);
+
+    test_slice(&m, 1, 0, 1000, 0, false);
+    pwm_model_set_clkdiv_mode(&m, PWM_MODEL_DIV_B_FALLING);
+    for (u_int32_t i = 0; i < 10; i++) {
+        pwm_model_tick(&m, true);
+        pwm_model_tick(&m, false);
+        pwm_model_tick(&m, false);
+    }
+    TEST_EQ(m.ctr, 10);
+
+    // the divider applies to the counted edges
+    test_slice(&m, 2, 0, 1000, 0, false);
+    pwm_model_set_clkdiv_mode(&m, PWM_MODEL_DIV_B_RISING);
+    for (u_int32_t i = 0; i < 10; i++) {
+        pwm_model_tick(&m, true);
+        pwm_model_tick(&m, false);
+    }
+    TEST_EQ(m.ctr, 5);
+
+    pwm_model_set_enabled(&m, false);
+    pwm_model_set_chan_level(&m, PWM_MODEL_CHAN_A, 1000);
+    pwm_model_set_chan_level(&m, PWM_MODEL_CHAN_B, 1000);
+    TEST_ASSERT(pwm_model_get_output(&m, PWM_MODEL_CHAN_A));
+    TEST_ASSERT(!pwm_model_get_output(&m, PWM_MODEL_CHAN_B));
+
+    pwm_model_set_clkdiv_mode(&m, PWM_MODEL_DIV_FREE_RUNNING);
+    TEST_ASSERT(pwm_model_get_output(&m, PWM_MODEL_CHAN_B));
+}
+
+/**
+ * Test the analytical fast-forward matches cycle-by-cycle ticking
+ * 
+ * @return void
+ */
+static void test_run_matches_tick()
+{
+    static const u_int8_t divs[][2] = { { 1, 0 }, { 2, 8 }, { 3, 15 }, { 0, 0 } };
+    static const u_int16_t tops[] = { 0, 7, 300 };
+    static const u_int32_t cycles[] = { 1, 17, 1000, 12345 };
+
+    for (size_t d = 0; d < sizeof(divs) / sizeof(divs[0]); d++) {
+        for (size_t t = 0; t < sizeof(tops) / sizeof(tops[0]); t++) {
+            for (u_int8_t ph = 0; ph < 2; ph++) {
+                for (size_t c = 0; c < sizeof(cycles) / sizeof(cycles[0]); c++) {
+                    pwm_model_t run, tick;
+                    test_slice(&run, divs[d][0], divs[d][1], tops[t], tops[t] / 2 + 1, ph);
+                    memcpy(&tick, &run, sizeof(pwm_model_t));
+
+                    pwm_model_run(&run, cycles[c], false);
+                    for (u_int32_t i = 0; i < cycles[c]; i++) {
+                        pwm_model_tick(&tick, false);
+                    }
+
+                    TEST_EQ(run.ctr, tick.ctr);
+                    TEST_EQ(run.down, tick.down);
+                    TEST_EQ(run.frac, tick.frac);
+                    TEST_EQ(run.wraps, tick.wraps);
+                    TEST_EQ(run.cycles, tick.cycles);
+                    TEST_EQ(pwm_model_get_output(&run, PWM_MODEL_CHAN_A), pwm_model_get_output(&tick, PWM_MODEL_CHAN_A));
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Test loading raw slice registers
+ * 
+ * @return void
+ */
+static void test_load_registers()
+{
+    pwm_model_t m;
+
+    // EN, PH_CORRECT, B_INV, DIVMODE B_RISING; DIV 3.5; CC A 10, B 20
+    pwm_model_load(&m, 0x1 | 0x2 | 0x8 | (2 << 4), (3 << 4) | 8, 7, (20 << 16) | 10, 99);
+
+    TEST_ASSERT(m.enabled);
+    TEST_ASSERT(m.ph_correct);
+    TEST_ASSERT(!m.inv[PWM_MODEL_CHAN_A]);
+    TEST_ASSERT(m.inv[PWM_MODEL_CHAN_B]);
+    TEST_EQ(m.divmode, PWM_MODEL_DIV_B_RISING);
+    TEST_EQ(m.div, 56);
+    TEST_EQ(m.ctr, 7);
+    TEST_EQ(m.active.top, 99);
+    TEST_EQ(m.active.cc[PWM_MODEL_CHAN_A], 10);
+    TEST_EQ(m.active.cc[PWM_MODEL_CHAN_B], 20);
+}
+
+int main()
+{
+    TEST_RUN(test_reset_values);
+    TEST_RUN(test_divider_8_4);
+    TEST_RUN(test_trailing_edge);
+    TEST_RUN(test_phase_correct);
+    TEST_RUN(test_latch_at_wrap);
+    TEST_RUN(test_b_pin_modes);
+    TEST_RUN(test_run_matches_tick);
+    TEST_RUN(test_load_registers);
+
+    return test_status();
+}
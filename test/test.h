@@ -0,0 +1,61 @@
+#ifndef TEST_H
+#define TEST_H
+
+#include <stdio.h>
+
+/**
+ * Test failed checks
+ * 
+ * @var int
+ */
+static int test_failures = 0;
+
+/**
+ * Test check a condition
+ * 
+ * @param cond
+ */
+#define TEST_ASSERT(cond) do { \
+    if (!(cond)) { \
+        printf("%s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        test_failures++; \
+    } \
+} while (0)
+
+/**
+ * Test check two integers are equal
+ * 
+ * @param actual
+ * @param expected
+ */
+#define TEST_EQ(actual, expected) do { \
+    unsigned long long test_a = (unsigned long long) (actual); \
+    unsigned long long test_e = (unsigned long long) (expected); \
+    if (test_a != test_e) { \
+        printf("%s:%d: %s is %llu, expected %llu\n", __FILE__, __LINE__, #actual, test_a, test_e); \
+        test_failures++; \
+    } \
+} while (0)
+
+/**
+ * Test run a test function
+ * 
+ * @param fn
+ */
+#define TEST_RUN(fn) do { \
+    int test_before = test_failures; \
+    fn(); \
+    printf("%s %s\n", test_failures == test_before ? "ok  " : "FAIL", #fn); \
+} while (0)
+
+/**
+ * Test exit status
+ * 
+ * @return int
+ */
+static inline int test_status()
+{
+    return test_failures == 0 ? 0 : 1;
+}
+
+#endif